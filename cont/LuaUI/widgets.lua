@@ -132,6 +132,7 @@ local flexCallIns = {
   'UnitCommand',
   'UnitCmdDone',
   'UnitDamaged',
+  'UnitDamagedBatch',
   'UnitStunned',
   'UnitEnteredRadar',
   'UnitEnteredLos',
@@ -1914,6 +1915,13 @@ function widgetHandler:UnitDamaged(unitID, unitDefID, unitTeam, damage, paralyze
   return
 end
 
+function widgetHandler:UnitDamagedBatch(count, data)
+  for _,w in ipairs(self.UnitDamagedBatchList) do
+    w:UnitDamagedBatch(count, data)
+  end
+  return
+end
+
 function widgetHandler:UnitStunned(unitID, unitDefID, unitTeam, stunned)
   for _,w in ipairs(self.UnitStunnedList) do
     w:UnitStunned(unitID, unitDefID, unitTeam, stunned)
@@ -57,6 +57,7 @@ CALLIN_LIST = {
 	"UnitCmdDone",
 	"UnitPreDamaged",
 	"UnitDamaged",
+	"UnitDamagedBatch",
 	"UnitStunned",
 	"UnitTaken",
 	"UnitGiven",
@@ -1525,6 +1525,12 @@ function gadgetHandler:UnitDamaged(
   end
 end
 
+function gadgetHandler:UnitDamagedBatch(count, data)
+  for _,g in r_ipairs(self.UnitDamagedBatchList) do
+    g:UnitDamagedBatch(count, data)
+  end
+end
+
 function gadgetHandler:UnitStunned(unitID, unitDefID, unitTeam, stunned)
   for _,g in r_ipairs(self.UnitStunnedList) do
     g:UnitStunned(unitID, unitDefID, unitTeam, stunned)
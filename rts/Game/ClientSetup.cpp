@@ -77,4 +77,6 @@ void ClientSetup::LoadFromStartScript(const std::string& setup)
 
 	file.GetDef(saveFile, "", "GAME\\SaveFile");
 	file.GetDef(demoFile, "", "GAME\\DemoFile");
+	file.GetDef(demoKeyframe, "-1", "GAME\\DemoKeyframe");
+	file.GetDef(demoSkipFrame, "-1", "GAME\\DemoSkipFrame");
 }
@@ -19,6 +19,10 @@ public:
 	std::string saveFile;
 	std::string demoFile;
 
+	//! keyframe of <demoFile> to start playback from, and the frame to skip to after loading it
+	int demoKeyframe = -1;
+	int demoSkipFrame = -1;
+
 	//! if this client is not the server player, the IP address we connect to
 	//! if this client is the server player, the IP address that other players connect to
 	std::string hostIP;
@@ -89,6 +89,7 @@
 #include "Sim/Misc/Wind.h"
 #include "Sim/Misc/ResourceHandler.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
+#include "Sim/MoveTypes/MoveMath/SpeedModCache.h"
 #include "Sim/MoveTypes/MoveTypeFactory.h"
 #include "Sim/Path/IPathManager.h"
 #include "Sim/Projectiles/ExplosionGenerator.h"
@@ -124,6 +125,7 @@
 #include "System/SpringMath.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/LoadSave/LoadSaveHandler.h"
+#include "System/LoadSave/CregLoadSaveHandler.h"
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/Log/ILog.h"
 #include "System/Platform/Misc.h"
@@ -213,8 +215,11 @@ CR_REG_METADATA(CGame, (
 
 	CR_MEMBER(speedControl),
 	CR_MEMBER(luaGCControl),
+	CR_IGNORED(demoKeyframeInterval),
+	CR_IGNORED(demoKeyframePending),
 
 	CR_IGNORED(jobDispatcher),
+	CR_IGNORED(replayBenchmark),
 	CR_IGNORED(curKeyCodeChain),
 	CR_IGNORED(curScanCodeChain),
 	CR_IGNORED(worldDrawer),
@@ -252,6 +257,7 @@ CGame::CGame(const std::string& mapFileName, const std::string& modFileName, ILo
 	showSpeed = configHandler->GetBool("ShowSpeed");
 
 	speedControl = configHandler->GetInt("SpeedControl");
+	demoKeyframeInterval = configHandler->GetInt("DemoKeyframeInterval");
 
 	playerRoster.SetSortTypeByCode((PlayerRoster::SortType)configHandler->GetInt("ShowPlayerInfo"));
 
@@ -293,6 +299,9 @@ CGame::~CGame()
 	ENTER_SYNCED_CODE();
 	LOG("[Game::%s][1]", __func__);
 
+	// replay may have been aborted before the game ended
+	replayBenchmark.Kill();
+
 	RmlGui::Shutdown();
 	helper->Kill();
 	KillLua(true);
@@ -551,7 +560,7 @@ void CGame::LoadMap(const std::string& mapFileName)
 		static_assert(BUILD_GRID_RESOLUTION == 2);
 		buildingMaskMap.Init(mapDims.hmapx * mapDims.hmapy);
 
-		groundBlockingObjectMap.Init(mapDims.mapSquares);
+		groundBlockingObjectMap.Init(mapDims.mapx, mapDims.mapy);
 		yardmapStatusEffectsMap.InitNewYardmapStatusEffectsMap();
 	}
 
@@ -713,6 +722,7 @@ void CGame::PostLoadSimulation(LuaParser* defsParser)
 	mapDamage = IMapDamage::InitMapDamage();
 	pathManager = IPathManager::GetInstance(modInfo.pathFinderSystem);
 	moveDefHandler.PostSimInit();
+	speedModCache.Init();
 
 	// load map-specific features
 	loadscreen->SetLoadMessage("Initializing Map Features");
@@ -938,6 +948,11 @@ void CGame::PostLoad()
 	GameSetupDrawer::Disable();
 
 	Sim::systemUtils.NotifyPostLoad();
+	// not saved; CReadMap::PostLoad refreshes it through RecalcArea, which
+	// does nothing without map damage while Lua may still have changed the
+	// loaded typemap
+	if (mapDamage->Disabled())
+		speedModCache.UpdateAll();
 
 	if (gameServer != nullptr) {
 		gameServer->PostLoad(gs->frameNum);
@@ -1059,6 +1074,7 @@ void CGame::KillSimulation()
 
 	CLosHandler::KillStatic(gu->globalReload);
 	quadField.Kill();
+	speedModCache.Kill();
 	moveDefHandler.Kill();
 	unitDefHandler->Kill();
 	featureDefHandler->Kill();
@@ -1305,6 +1321,11 @@ bool CGame::Update()
 
 	LEAVE_SYNCED_CODE();
 
+	// not done inside SimFrame; by now every packet read this update is in
+	// the demo, so the stream offset still matches the saved state
+	if (demoKeyframePending)
+		SaveDemoKeyframe();
+
 	{
 		SLuaAllocError error = {};
 
@@ -1788,6 +1809,10 @@ void CGame::StartPlaying()
 	GameSetupDrawer::Disable();
 	CLuaUI::UpdateTeams();
 
+	// only meaningful when replaying a demo through the local server
+	if (CReplayBenchmark::IsEnabled() && gameServer != nullptr && gameServer->GetDemoReader() != nullptr)
+		replayBenchmark.Init();
+
 	teamHandler.SetDefaultStartPositions(gameSetup);
 
 	if (saveFileHandler == nullptr)
@@ -1812,6 +1837,7 @@ void CGame::SimFrame() {
 	CSyncChecker::NewGameFrame();
 #endif
 	lastFrameTime = spring_gettime();
+	replayBenchmark.BeginFrame();
 	// This is not very ideal, as the timeoffset of each new draw frame is also calculated from this
 	// with a strange side effect: if the timeOffset was a high number, like 0.9, then this will force the next draw frame to have an offset of 0.0x
 	// What this means, is that in the case where we have frames to spare, and and over rendering, then the following can happen at 60hz:
@@ -1909,6 +1935,7 @@ void CGame::SimFrame() {
 	}
 
 	lastSimFrameTime = spring_gettime();
+	replayBenchmark.EndFrame(gs->frameNum);
 	gu->avgSimFrameTime = mix(gu->avgSimFrameTime, (lastSimFrameTime - lastFrameTime).toMilliSecsf(), 0.05f);
 	gu->avgSimFrameTime = std::max(gu->avgSimFrameTime, 0.01f);
 
@@ -1917,7 +1944,7 @@ void CGame::SimFrame() {
 	FrameMarkEnd(tracingSimFrameName);
 
 	#ifdef HEADLESS
-	{
+	if (!replayBenchmark.IsActive()) {
 		const float msecMaxSimFrameTime = 1000.0f / (GAME_SPEED * gs->wantedSpeedFactor);
 		const float msecDifSimFrameTime = (lastSimFrameTime - lastFrameTime).toMilliSecsf();
 		// multiply by 0.5 to give unsynced code some execution time (50% of our sleep-budget)
@@ -1932,11 +1959,40 @@ void CGame::SimFrame() {
 	// useful for desync-debugging (enter instead of -1 start & end frame of the range you want to debug)
 	DumpState(-1, -1, 1, std::nullopt);
 
+	if (demoKeyframeInterval > 0 && (gs->frameNum % (demoKeyframeInterval * GAME_SPEED)) == 0)
+		demoKeyframePending = true;
+
 	ASSERT_SYNCED(gsRNG.GetGenState());
 	LEAVE_SYNCED_CODE();
 }
 
 
+void CGame::SaveDemoKeyframe()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	CDemoRecorder* record = clientNet->GetDemoRecorder();
+
+	demoKeyframePending = false;
+
+	if (!record->IsValid())
+		return;
+
+	// packets received after this point belong to later frames, so playback
+	// resumes from the current end of the demo stream once the state is loaded
+	CCregLoadSaveHandler saveHandler;
+	std::string state;
+
+	saveHandler.SaveInfo(gameSetup->mapName, gameSetup->modName);
+
+	if (!saveHandler.SaveGameToBuffer(state, 1)) {
+		LOG_L(L_WARNING, "[Game::%s] could not save demo keyframe for frame %d", __func__, gs->frameNum);
+		return;
+	}
+
+	record->AddKeyframe(gs->frameNum, clientNet->GetPacketTime(gs->frameNum), std::move(state));
+}
+
+
 void CGame::GameEnd(const std::vector<unsigned char>& winningAllyTeams, bool timeout)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -1973,6 +2029,11 @@ void CGame::GameEnd(const std::vector<unsigned char>& winningAllyTeams, bool tim
 	CTimeProfiler::GetInstance().PrintProfilingInfo();
 #endif // HEADLESS
 
+	if (replayBenchmark.IsActive()) {
+		replayBenchmark.Kill();
+		gu->globalQuit = true;
+	}
+
 	CDemoRecorder* record = clientNet->GetDemoRecorder();
 
 	if (!record->IsValid())
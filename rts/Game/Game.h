@@ -9,6 +9,7 @@
 
 #include "GameController.h"
 #include "GameJobDispatcher.h"
+#include "ReplayBenchmark.h"
 #include "Game/UI/KeySet.h"
 #include "Game/Action.h"
 #include "Rendering/WorldDrawer.h"
@@ -146,6 +147,7 @@ private:
 	void UpdateNumQueuedSimFrames();
 	void UpdateNetMessageProcessingTimeLeft();
 	void SimFrame();
+	void SaveDemoKeyframe();
 	void StartPlaying();
 
 public:
@@ -214,8 +216,14 @@ public:
 	// 0 := 1/f rate, 1 := 30/s rate
 	int luaGCControl = 0;
 
+	/// game-seconds between state snapshots in recorded demos, 0 := off
+	int demoKeyframeInterval = 0;
+	/// set by SimFrame, the snapshot itself is taken at the end of Update
+	bool demoKeyframePending = false;
+
 private:
 	JobDispatcher jobDispatcher;
+	CReplayBenchmark replayBenchmark;
 
 	CTimedKeyChain curKeyCodeChain;
 	CTimedKeyChain curScanCodeChain;
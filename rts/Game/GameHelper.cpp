@@ -30,6 +30,7 @@
 #include "Sim/Projectiles/ExplosionListener.h"
 #include "Sim/Projectiles/Projectile.h"
 #include "Sim/Units/CommandAI/MobileCAI.h"
+#include "Sim/Units/Scripts/UnitScript.h"
 #include "Sim/Units/UnitTypes/Factory.h"
 #include "Sim/Units/BuildInfo.h"
 #include "Sim/Units/UnitDef.h"
@@ -37,13 +38,17 @@
 #include "Sim/Units/UnitHandler.h"
 #include "Sim/Weapons/WeaponDefHandler.h"
 #include "Sim/Weapons/Weapon.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/EventHandler.h"
 #include "System/SpringMath.h"
 #include "System/Sound/ISoundChannels.h"
+#include "System/Threading/ThreadPool.h"
 
 #include "System/Misc/TracyDefs.h"
 
 
+CONFIG(bool, GenerateWeaponTargetsMT).defaultValue(true).description("Gather the weapon auto-target candidates for each SlowUpdate batch on the thread pool instead of in each weapon's AutoTarget. A gathered list is only used while its unit has not moved and no unit has entered, left or changed QuadField cells since, so the targets chosen do not depend on this setting.");
+
 static CGameHelper gGameHelper;
 CGameHelper* helper = &gGameHelper;
 
@@ -54,10 +59,13 @@ void CGameHelper::Init()
 		wdVec.clear();
 		wdVec.reserve(32);
 	}
+
+	generateWeaponTargetsMT = configHandler->GetBool("GenerateWeaponTargetsMT");
 }
 
 void CGameHelper::Kill()
 {
+	EndWeaponTargetsBatch();
 }
 
 void CGameHelper::Update()
@@ -655,7 +663,45 @@ namespace {
 
 
 
-size_t CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets)
+// [0] := default, [1,2,3,4,5,6] := target is {avoidee, in bad category, crashing, last attacker, paralyzed, outside unboosted range}
+static constexpr float tgtPriorityMults[] = {1.0f, 10.0f, 100.0f, 1000.0f, 0.5f, 4.0f, 100000.0f};
+
+float CGameHelper::GetWeaponTargetScanRadius(const CWeapon* weapon, float aimPosHeight)
+{
+	const float minMapHeight = std::max(0.0f, readMap->GetCurrMinHeight());
+
+	// find theoretical maximum range based on height above lowest point on map
+	// return (weapon->GetRange2D(weapon->autoTargetRangeBoost, (minMapHeight - aimPosHeight) * weapon->weaponDef->heightmod));
+	return (weapon->range + weapon->autoTargetRangeBoost + (aimPosHeight - minMapHeight) * weapon->weaponDef->heightmod);
+}
+
+void CGameHelper::GetWeaponTargetUnits(const CUnit* weaponOwner, float scanRadius, std::vector<CUnit*>& targetUnits, int threadNum)
+{
+	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = threadNum;
+	quadField.GetQuads(qfQuery, weaponOwner->pos, scanRadius);
+
+	targetUnits.clear();
+
+	const int tempNum = gs->GetMtTempNum(threadNum);
+
+	for (int t = 0; t < teamHandler.ActiveAllyTeams(); ++t) {
+		if (teamHandler.Ally(weaponOwner->allyteam, t))
+			continue;
+
+		for (const int qi: *qfQuery.quads) {
+			for (CUnit* targetUnit: quadField.GetQuad(qi).teamUnits[t]) {
+				if (targetUnit->mtTempNum[threadNum] == tempNum)
+					continue;
+
+				targetUnit->mtTempNum[threadNum] = tempNum;
+				targetUnits.push_back(targetUnit);
+			}
+		}
+	}
+}
+
+size_t CGameHelper::ScoreWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, const std::vector<CUnit*>& targetUnits, std::vector<std::pair<float, CUnit*>>& targets)
 {
 	const CUnit*  weaponOwner = weapon->owner;
 	const CUnit* lastAttacker = ((weaponOwner->lastAttackFrame + 200) <= gs->frameNum) ? weaponOwner->lastAttacker : nullptr;
@@ -667,7 +713,6 @@ size_t CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* av
 	const float3 testPos;
 
 	const float aimPosHeight = weapon->aimFromPos.y;
-	const float minMapHeight = std::max(0.0f, readMap->GetCurrMinHeight());
 
 	// how much damage the weapon deals over 1 second
 	const float secDamage = weaponDmg->GetDefault() * weapon->salvoSize / weapon->reloadTime * GAME_SPEED;
@@ -678,112 +723,189 @@ size_t CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* av
 
 	const float  baseRange = weapon->range;
 	const float rangeBoost = weapon->autoTargetRangeBoost;
-	// find theoretical maximum range based on height above lowest point on map
-	// const float scanRadius = weapon->GetRange2D(rangeBoost, (minMapHeight - aimPosHeight) * heightMod);
-	const float scanRadius = baseRange + rangeBoost + (aimPosHeight - minMapHeight) * heightMod;
-
-	// [0] := default, [1,2,3,4,5,6] := target is {avoidee, in bad category, crashing, last attacker, paralyzed, outside unboosted range}
-	constexpr float tgtPriorityMults[] = {1.0f, 10.0f, 100.0f, 1000.0f, 0.5f, 4.0f, 100000.0f};
 
 	const bool paralyzer = (weaponDmg->paralyzeDamageTime != 0);
 
-	// copy on purpose since the below calls lua
-	QuadFieldQuery qfQuery;
-	quadField.GetQuads(qfQuery, ownerPos, scanRadius);
-
 	targets.clear();
 	targets.reserve(32);
 
-	const int tempNum = gs->GetTempNum();
+	for (CUnit* targetUnit: targetUnits) {
+		if (!weapon->TestTarget(testPos, SWeaponTarget(targetUnit)))
+			continue;
 
-	for (int t = 0; t < teamHandler.ActiveAllyTeams(); ++t) {
-		if (teamHandler.Ally(weaponOwner->allyteam, t))
+		const unsigned short targetLOSState = targetUnit->losStatus[weaponOwner->allyteam];
+
+		float targetPriority = tgtPriorityMults[(targetUnit == avoidUnit) * 1];
+		float3 targetPos;
+
+		if (targetLOSState & LOS_INLOS) {
+			targetPos = targetUnit->aimPos;
+		} else if (targetLOSState & LOS_INRADAR) {
+			targetPos = weapon->GetUnitPositionWithError(targetUnit);
+			targetPriority *= tgtPriorityMults[1];
+		} else {
 			continue;
+		}
 
-		for (const int qi: *qfQuery.quads) {
-			const std::vector<CUnit*>& allyTeamUnits = quadField.GetQuad(qi).teamUnits[t];
+		const float modRange = weapon->GetRange2D(rangeBoost, (targetPos.y - aimPosHeight) * heightMod);
+		const float sqDist2D = ownerPos.SqDistance2D(targetPos);
 
-			for (CUnit* targetUnit: allyTeamUnits) {
-				if (targetUnit->tempNum == tempNum)
-					continue;
+		if (sqDist2D > Square(modRange))
+			continue;
 
-				targetUnit->tempNum = tempNum;
+		const float3 worldTargetDir = (targetPos - ownerPos).SafeNormalize();
+		const float angleOffset =  (1.f - worldMainDir.dot(worldTargetDir));
+		const float angleMod = angleOffset * weaponAimAdjustPriority + 1.f;
 
-				if (!weapon->TestTarget(testPos, SWeaponTarget(targetUnit)))
-					continue;
+		// Strengthen focus towards the front, desire should weaken quadratically rather
+		// than linearly otherwise target distance can too easily cause units to choose a
+		// target that requires turning around to fire at.
+		const float angleMul = angleMod*angleMod;
 
-				const unsigned short targetLOSState = targetUnit->losStatus[weaponOwner->allyteam];
+		const float dist2D = math::sqrt(sqDist2D);
+		const float rangeMul = (dist2D * weaponDef->proximityPriority + modRange * 0.4f + 100.0f);
+		const float damageMul = std::max(0.0001f, weaponDmg->Get(targetUnit->armorType) * targetUnit->curArmorMultiple);
 
-				float targetPriority = tgtPriorityMults[(targetUnit == avoidUnit) * 1];
-				float3 targetPos;
+		targetPriority *= angleMul;
+		targetPriority *= rangeMul;
+		targetPriority *= tgtPriorityMults[(dist2D > baseRange) * 6];
 
-				if (targetLOSState & LOS_INLOS) {
-					targetPos = targetUnit->aimPos;
-				} else if (targetLOSState & LOS_INRADAR) {
-					targetPos = weapon->GetUnitPositionWithError(targetUnit);
-					targetPriority *= tgtPriorityMults[1];
-				} else {
-					continue;
-				}
+		if (targetLOSState & LOS_INLOS) {
+			targetPriority *= (secDamage + targetUnit->health);
 
-				const float modRange = weapon->GetRange2D(rangeBoost, (targetPos.y - aimPosHeight) * heightMod);
-				const float sqDist2D = ownerPos.SqDistance2D(targetPos);
+			if (paralyzer && targetUnit->paralyzeDamage > (modInfo.paralyzeOnMaxHealth? targetUnit->maxHealth: targetUnit->health))
+				targetPriority *= tgtPriorityMults[5];
 
-				if (sqDist2D > Square(modRange))
-					continue;
+			if (weapon->hasTargetWeight)
+				targetPriority *= weapon->TargetWeight(targetUnit);
 
-				const float3 worldTargetDir = (targetPos - ownerPos).SafeNormalize();
-				const float angleOffset =  (1.f - worldMainDir.dot(worldTargetDir));
-				const float angleMod = angleOffset * weaponAimAdjustPriority + 1.f;
+		} else {
+			targetPriority *= (secDamage + 10000.0f);
+		}
 
-				// Strengthen focus towards the front, desire should weaken quadratically rather
-				// than linearly otherwise target distance can too easily cause units to choose a
-				// target that requires turning around to fire at.
-				const float angleMul = angleMod*angleMod;
+		if (targetLOSState & LOS_PREVLOS) {
+			targetPriority /= (damageMul * targetUnit->power);
+			targetPriority *= tgtPriorityMults[((targetUnit->category & weapon->badTargetCategory) != 0) * 2];
+			targetPriority *= tgtPriorityMults[(targetUnit->IsCrashing()) * 3];
+			targetPriority *= tgtPriorityMults[(targetUnit == lastAttacker) * 4];
+		}
 
-				const float dist2D = math::sqrt(sqDist2D);
-				const float rangeMul = (dist2D * weaponDef->proximityPriority + modRange * 0.4f + 100.0f);
-				const float damageMul = std::max(0.0001f, weaponDmg->Get(targetUnit->armorType) * targetUnit->curArmorMultiple);
+		if (!eventHandler.AllowWeaponTarget(weaponOwner->id, targetUnit->id, weapon->weaponNum, weaponDef->id, &targetPriority))
+			continue;
 
-				targetPriority *= angleMul;
-				targetPriority *= rangeMul;
-				targetPriority *= tgtPriorityMults[(dist2D > baseRange) * 6];
+		targets.emplace_back(targetPriority, targetUnit);
+	}
 
-				if (targetLOSState & LOS_INLOS) {
-					targetPriority *= (secDamage + targetUnit->health);
+	std::stable_sort(targets.begin(), targets.end(), [](const std::pair<float, CUnit*>& a, const std::pair<float, CUnit*>& b) { return (a.first < b.first); });
+	return (targets.size());
+}
 
-					if (paralyzer && targetUnit->paralyzeDamage > (modInfo.paralyzeOnMaxHealth? targetUnit->maxHealth: targetUnit->health))
-						targetPriority *= tgtPriorityMults[5];
+size_t CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets)
+{
+	const float scanRadius = GetWeaponTargetScanRadius(weapon, weapon->aimFromPos.y);
+	const std::vector<CUnit*>* targetUnits = helper->GetBatchWeaponTargetUnits(weapon, scanRadius);
 
-					if (weapon->hasTargetWeight)
-						targetPriority *= weapon->TargetWeight(targetUnit);
+	if (targetUnits == nullptr) {
+		GetWeaponTargetUnits(weapon->owner, scanRadius, helper->targetUnits, ThreadPool::GetThreadNum());
+		targetUnits = &helper->targetUnits;
+	}
 
-				} else {
-					targetPriority *= (secDamage + 10000.0f);
-				}
+	// scored here rather than in the batch, the target and weapon state (and
+	// the script and Lua call-ins) have to be those of the moment AutoTarget
+	// runs, after the units before this one have had their SlowUpdate
+	return (ScoreWeaponTargets(weapon, avoidUnit, *targetUnits, targets));
+}
 
-				if (targetLOSState & LOS_PREVLOS) {
-					targetPriority /= (damageMul * targetUnit->power);
-					targetPriority *= tgtPriorityMults[((targetUnit->category & weapon->badTargetCategory) != 0) * 2];
-					targetPriority *= tgtPriorityMults[(targetUnit->IsCrashing()) * 3];
-					targetPriority *= tgtPriorityMults[(targetUnit == lastAttacker) * 4];
-				}
+void CGameHelper::BeginWeaponTargetsBatch(const std::vector<CUnit*>& units, size_t idxBeg, size_t idxEnd)
+{
+	ZoneScoped;
 
-				const bool allowTarget = eventHandler.AllowWeaponTarget(weaponOwner->id, targetUnit->id, weapon->weaponNum, weaponDef->id, &targetPriority);
+	batchWeapons.clear();
+	batchWeaponIndices.clear();
 
-				// Lua call may have changed tempNum, so needs to be set again
-				targetUnit->tempNum = tempNum;
+	if (!generateWeaponTargetsMT)
+		return;
 
-				if (!allowTarget)
-					continue;
+	for (size_t i = idxBeg; i < idxEnd; ++i) {
+		const CUnit* unit = units[i];
 
-				targets.emplace_back(targetPriority, targetUnit);
-			}
+		if (!unit->CanUpdateWeapons())
+			continue;
+
+		for (const CWeapon* weapon: unit->weapons) {
+			if (!weapon->MayAutoTarget())
+				continue;
+
+			batchWeaponIndices[weapon] = batchWeapons.size();
+			batchWeapons.push_back(weapon);
 		}
 	}
 
-	std::stable_sort(targets.begin(), targets.end(), [](const std::pair<float, CUnit*>& a, const std::pair<float, CUnit*>& b) { return (a.first < b.first); });
-	return (targets.size());
+	if (batchScans.size() < batchWeapons.size())
+		batchScans.resize(batchWeapons.size());
+
+	// the scan radius depends on the aim-from position CWeapon::SlowUpdate is
+	// about to refresh, use the one it will (most likely) arrive at; doing so
+	// does not touch the weapon, the unit's own SlowUpdate still sees the old
+	for (size_t i = 0; i < batchWeapons.size(); ++i) {
+		const CWeapon* weapon = batchWeapons[i];
+		const CUnit* owner = weapon->owner;
+
+		const float3 aimFromPos = weapon->CalcAimFromPos(owner->script->GetPiecePos(weapon->aimFromPiece));
+
+		batchScans[i].ownerPos = owner->pos;
+		batchScans[i].scanRadius = GetWeaponTargetScanRadius(weapon, aimFromPos.y);
+		batchScans[i].ownerAllyTeam = owner->allyteam;
+	}
+
+	batchUnitsVersion = quadField.GetUnitsVersion();
+	batchAllies.resize(teamHandler.ActiveAllyTeams() * teamHandler.ActiveAllyTeams());
+
+	for (int a = 0; a < teamHandler.ActiveAllyTeams(); ++a) {
+		for (int b = 0; b < teamHandler.ActiveAllyTeams(); ++b) {
+			batchAllies[a * teamHandler.ActiveAllyTeams() + b] = teamHandler.Ally(a, b);
+		}
+	}
+
+	// only reads the QuadField, thread-local tempNum's keep the scans apart
+	for_mt_chunk(0, batchWeapons.size(), [this](const int i) {
+		WeaponTargetsScan& scan = batchScans[i];
+		GetWeaponTargetUnits(batchWeapons[i]->owner, scan.scanRadius, scan.targetUnits, ThreadPool::GetThreadNum());
+	});
+}
+
+void CGameHelper::EndWeaponTargetsBatch()
+{
+	batchWeapons.clear();
+	batchWeaponIndices.clear();
+}
+
+const std::vector<CUnit*>* CGameHelper::GetBatchWeaponTargetUnits(const CWeapon* weapon, float scanRadius) const
+{
+	const auto it = batchWeaponIndices.find(weapon);
+
+	if (it == batchWeaponIndices.end())
+		return nullptr;
+
+	const WeaponTargetsScan& scan = batchScans[it->second];
+	const CUnit* owner = weapon->owner;
+
+	// the units updated before this one (or their scripts and Lua) may have
+	// moved, created or killed units, changed alliances or our aim-from piece;
+	// the scan is only used if it still gives what a new one would
+	if (quadField.GetUnitsVersion() != batchUnitsVersion)
+		return nullptr;
+	if (scan.scanRadius != scanRadius || scan.ownerAllyTeam != owner->allyteam)
+		return nullptr;
+	if (scan.ownerPos.x != owner->pos.x || scan.ownerPos.y != owner->pos.y || scan.ownerPos.z != owner->pos.z)
+		return nullptr;
+
+	for (int t = 0; t < teamHandler.ActiveAllyTeams(); ++t) {
+		if (batchAllies[owner->allyteam * teamHandler.ActiveAllyTeams() + t] != teamHandler.Ally(owner->allyteam, t))
+			return nullptr;
+	}
+
+	return &scan.targetUnits;
 }
 
 
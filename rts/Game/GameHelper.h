@@ -7,6 +7,7 @@
 #include "Sim/Units/CommandAI/Command.h"
 #include "Sim/Misc/GlobalConstants.h"
 #include "System/EventClient.h"
+#include "System/UnorderedMap.hpp"
 #include "System/float3.h"
 #include "System/float4.h"
 #include "System/type2.h"
@@ -150,6 +151,16 @@ public:
 
 	static size_t GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets);
 
+	/**
+	 * Gathers the potential targets of every weapon of the given units that
+	 * may auto-target (see CWeapon::MayAutoTarget) on the thread pool. Until
+	 * EndWeaponTargetsBatch, GenerateWeaponTargets uses these instead of its
+	 * own QuadField scan as long as nothing that would change the scan's
+	 * result happened in between; scoring is always done by the caller.
+	 */
+	void BeginWeaponTargetsBatch(const std::vector<CUnit*>& units, size_t idxBeg, size_t idxEnd);
+	void EndWeaponTargetsBatch();
+
 	void Init();
 	void Kill();
 	void Update();
@@ -183,6 +194,21 @@ public:
 	void Explosion(const CExplosionParams& params);
 
 private:
+	struct WeaponTargetsScan {
+		/// inputs of the scan, see GetBatchWeaponTargetUnits
+		float3 ownerPos;
+		float scanRadius = 0.0f;
+		int ownerAllyTeam = -1;
+
+		std::vector<CUnit*> targetUnits;
+	};
+
+	static float GetWeaponTargetScanRadius(const CWeapon* weapon, float aimPosHeight);
+	static void GetWeaponTargetUnits(const CUnit* weaponOwner, float scanRadius, std::vector<CUnit*>& targetUnits, int threadNum);
+	static size_t ScoreWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, const std::vector<CUnit*>& targetUnits, std::vector<std::pair<float, CUnit*>>& targets);
+
+	const std::vector<CUnit*>* GetBatchWeaponTargetUnits(const CWeapon* weapon, float scanRadius) const;
+
 	struct WaitingDamage {
 		WaitingDamage(const DamageArray& _damage, const float3& _impulse, int _attackerID, int _targetID, int _weaponID, int _projectileID)
 		: attackerID(_attackerID)
@@ -208,6 +234,19 @@ private:
 public:
 	std::vector<int> targetUnitIDs; // GetEnemyUnits{NoLosTest}
 	std::vector<std::pair<float, CUnit*>> targetPairs; // GenerateWeaponTargets
+
+private:
+	// GenerateWeaponTargets outside of a batch
+	std::vector<CUnit*> targetUnits;
+
+	// {Begin,End}WeaponTargetsBatch
+	std::vector<const CWeapon*> batchWeapons;
+	std::vector<WeaponTargetsScan> batchScans; // per batchWeapons index
+	std::vector<bool> batchAllies; // teamHandler.Ally(a, b) at a * ActiveAllyTeams() + b
+	spring::unordered_map<const CWeapon*, size_t> batchWeaponIndices;
+	unsigned int batchUnitsVersion = 0;
+
+	bool generateWeaponTargetsMT = true;
 };
 
 extern CGameHelper* helper;
\ No newline at end of file
@@ -45,6 +45,8 @@ CR_REG_METADATA(CGameSetup, (
 	CR_IGNORED(gameStartDelay),
 
 	CR_IGNORED(numDemoPlayers),
+	CR_IGNORED(demoKeyframe),
+	CR_IGNORED(demoSkipFrame),
 	CR_IGNORED(maxUnitsPerTeam),
 
 	CR_IGNORED(minSpeed),
@@ -197,6 +199,8 @@ void CGameSetup::ResetState()
 
 	gameStartDelay = 0;
 	numDemoPlayers = 0;
+	demoKeyframe = -1;
+	demoSkipFrame = -1;
 	maxUnitsPerTeam = 0;
 
 	maxSpeed = 0.0f;
@@ -622,6 +626,9 @@ bool CGameSetup::Init(const std::string& buf)
 	demoName    = file.SGetValueDef("",  "GAME\\Demofile");
 	hostDemo    = !demoName.empty();
 
+	file.GetTDef(demoKeyframe, -1, "GAME\\DemoKeyframe");
+	file.GetTDef(demoSkipFrame, -1, "GAME\\DemoSkipFrame");
+
 	file.GetTDef(gameStartDelay, 4u, "GAME\\GameStartDelay");
 
 	file.GetDef(recordDemo,          "1", "GAME\\RecordDemo");
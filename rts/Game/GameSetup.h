@@ -50,6 +50,8 @@ public:
 		gameStartDelay = gs.gameStartDelay;
 
 		numDemoPlayers = gs.numDemoPlayers;
+		demoKeyframe = gs.demoKeyframe;
+		demoSkipFrame = gs.demoSkipFrame;
 		maxUnitsPerTeam = gs.maxUnitsPerTeam;
 
 		maxSpeed = gs.maxSpeed;
@@ -204,6 +206,9 @@ public:
 	unsigned int gameStartDelay;
 
 	int numDemoPlayers;
+	/** demo keyframe the server resumes playback from, and the frame to skip to from there (-1 if none) */
+	int demoKeyframe;
+	int demoSkipFrame;
 	int maxUnitsPerTeam;
 
 	float maxSpeed;
@@ -45,6 +45,7 @@
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/LoadSave/DemoReader.h"
 #include "System/LoadSave/LoadSaveHandler.h"
+#include "System/LoadSave/CregLoadSaveHandler.h"
 #include "System/Log/ILog.h"
 #include "System/Net/RawPacket.h"
 #include "System/Net/UnpackPacket.h"
@@ -498,6 +499,13 @@ void CPreGame::StartServerForDemo(const std::string& demoName)
 		tgame->AddPair("MapName", gameSetup->mapName);
 		tgame->AddPair("Gametype", gameSetup->modName);
 		tgame->AddPair("Demofile", demoName);
+
+		// the server fast-forwards to the keyframe, the client loads its state
+		if (saveFileHandler != nullptr) {
+			tgame->AddPair("DemoKeyframe", clientSetup->demoKeyframe);
+			tgame->AddPair("DemoSkipFrame", clientSetup->demoSkipFrame);
+		}
+
 		tgame->remove("OnlyLocal", false);
 		tgame->remove("HostIP", false);
 		tgame->remove("HostPort", false);
@@ -550,6 +558,9 @@ void CPreGame::ReadDataFromDemo(const std::string& demoName)
 		assert(gameData->GetSetupText() == scanner.GetSetupScript());
 
 		if (CGameSetup::LoadReceivedScript(gameData->GetSetupText(), true)) {
+			if (clientSetup->demoKeyframe >= 0)
+				LoadDemoKeyframe(scanner, clientSetup->demoKeyframe);
+
 			StartServerForDemo(demoName);
 		} else {
 			throw content_error("Demo contains incorrect script");
@@ -559,6 +570,23 @@ void CPreGame::ReadDataFromDemo(const std::string& demoName)
 	assert(gameServer != nullptr);
 }
 
+void CPreGame::LoadDemoKeyframe(CDemoReader& scanner, int keyframeNum)
+{
+	SCOPED_ONCE_TIMER("PreGame::LoadDemoKeyframe");
+
+	std::string state;
+	CCregLoadSaveHandler* keyframeHandler = new CCregLoadSaveHandler();
+
+	if (scanner.ReadKeyframeState(keyframeNum, state) && keyframeHandler->LoadDemoKeyframe(state)) {
+		LOG("[PreGame::%s] starting demo playback from keyframe %d (frame %d)", __func__, keyframeNum, scanner.GetKeyframes()[keyframeNum].frameNum);
+		saveFileHandler = keyframeHandler;
+		return;
+	}
+
+	LOG_L(L_WARNING, "[PreGame::%s] could not load keyframe %d, playing the demo from the start", __func__, keyframeNum);
+	delete keyframeHandler;
+}
+
 void CPreGame::GameDataReceived(std::shared_ptr<const netcode::RawPacket> packet)
 {
 	SCOPED_ONCE_TIMER("PreGame::GameDataReceived");
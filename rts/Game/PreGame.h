@@ -15,6 +15,7 @@ class ILoadSaveHandler;
 class GameData;
 class CGameSetup;
 class ClientSetup;
+class CDemoReader;
 
 
 namespace netcode {
@@ -62,6 +63,7 @@ private:
 
 	/// reads out map, mod and script from demos (with or without a gameSetupScript)
 	void ReadDataFromDemo(const std::string& demoName);
+	void LoadDemoKeyframe(CDemoReader& scanner, int keyframeNum);
 
 	/// receive network traffic
 	void UpdateClientNet();
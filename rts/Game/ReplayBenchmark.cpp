@@ -0,0 +1,181 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "ReplayBenchmark.h"
+
+#include <algorithm>
+
+#include "System/TimeProfiler.h"
+#include "System/FileSystem/FileSystem.h"
+#include "System/Log/ILog.h"
+#include "System/StringUtil.h"
+
+
+void CReplayBenchmark::Init()
+{
+	frames.clear();
+	frames.reserve(30 * 60 * 60);
+	timerTimes.clear();
+	timerTimes.reserve(frames.capacity() * 16);
+
+	curTotals.clear();
+	lastTotals.clear();
+
+	// sub-timers only collect data while the profiler is enabled
+	CTimeProfiler::GetInstance().SetEnabled(true);
+
+	active = true;
+	written = false;
+
+	LOG("[ReplayBenchmark::%s] recording sim-frame timings to \"%s\"", __func__, outputFile.c_str());
+}
+
+void CReplayBenchmark::Kill()
+{
+	Write();
+
+	frames.clear();
+	timerTimes.clear();
+	lastTotals.clear();
+
+	active = false;
+}
+
+
+void CReplayBenchmark::SampleTimers(bool record)
+{
+	curTotals.clear();
+	CTimeProfiler::GetInstance().GetTotalTimes(curTotals);
+
+	for (const auto& p: curTotals) {
+		spring_time& lastTotal = lastTotals[p.first];
+
+		if (record && p.second > lastTotal)
+			timerTimes.emplace_back(p.first, (p.second - lastTotal).toMilliSecsf());
+
+		lastTotal = p.second;
+	}
+}
+
+void CReplayBenchmark::BeginFrame()
+{
+	if (!active)
+		return;
+
+	// timers also run between frames (Update, Draw), leave those out
+	SampleTimers(false);
+
+	frameStartTime = spring_gettime();
+}
+
+void CReplayBenchmark::EndFrame(int frameNum)
+{
+	if (!active)
+		return;
+
+	const float simTime = (spring_gettime() - frameStartTime).toMilliSecsf();
+	const size_t timersBegin = timerTimes.size();
+
+	SampleTimers(true);
+
+	frames.push_back({frameNum, simTime, timersBegin, timerTimes.size()});
+}
+
+
+bool CReplayBenchmark::Write()
+{
+	if (!active || written)
+		return false;
+
+	written = true;
+
+	FILE* file = fopen(outputFile.c_str(), "w");
+
+	if (file == nullptr) {
+		LOG_L(L_ERROR, "[ReplayBenchmark::%s] could not open \"%s\"", __func__, outputFile.c_str());
+		return false;
+	}
+
+	const bool json = (StringToLower(FileSystem::GetExtension(outputFile)) == "json");
+	const bool ret = json? WriteJSON(file): WriteCSV(file);
+
+	if ((fclose(file) != 0) || !ret) {
+		LOG_L(L_ERROR, "[ReplayBenchmark::%s] could not write \"%s\"", __func__, outputFile.c_str());
+		return false;
+	}
+
+	LOG("[ReplayBenchmark::%s] wrote timings of %u sim-frames to \"%s\"", __func__, static_cast<unsigned>(frames.size()), outputFile.c_str());
+	return true;
+}
+
+bool CReplayBenchmark::WriteCSV(FILE* file) const
+{
+	// one column per timer that ran during any frame, sorted by name
+	std::vector< std::pair<std::string, unsigned> > columns;
+	spring::unordered_map<unsigned, size_t> columnIndices;
+
+	for (const auto& p: timerTimes) {
+		if (columnIndices.find(p.first) != columnIndices.end())
+			continue;
+
+		columnIndices[p.first] = 0;
+		columns.emplace_back(CTimeProfiler::GetTimerName(p.first), p.first);
+	}
+
+	std::sort(columns.begin(), columns.end());
+
+	fprintf(file, "frame,sim");
+
+	for (size_t i = 0; i < columns.size(); i++) {
+		columnIndices[columns[i].second] = i;
+		fprintf(file, ",\"%s\"", columns[i].first.c_str());
+	}
+
+	fprintf(file, "\n");
+
+	std::vector<float> row(columns.size());
+
+	for (const FrameRecord& f: frames) {
+		std::fill(row.begin(), row.end(), 0.0f);
+
+		for (size_t i = f.timersBegin; i < f.timersEnd; i++) {
+			row[columnIndices[timerTimes[i].first]] += timerTimes[i].second;
+		}
+
+		fprintf(file, "%d,%.4f", f.frameNum, f.simTime);
+
+		for (const float t: row) {
+			fprintf(file, ",%.4f", t);
+		}
+
+		fprintf(file, "\n");
+	}
+
+	return (ferror(file) == 0);
+}
+
+bool CReplayBenchmark::WriteJSON(FILE* file) const
+{
+	spring::unordered_map<unsigned, std::string> names;
+
+	for (const auto& p: timerTimes) {
+		if (names.find(p.first) == names.end())
+			names[p.first] = CTimeProfiler::GetTimerName(p.first);
+	}
+
+	fprintf(file, "{\"frames\": [");
+
+	for (size_t n = 0; n < frames.size(); n++) {
+		const FrameRecord& f = frames[n];
+
+		fprintf(file, "%s\n\t{\"frame\": %d, \"sim\": %.4f, \"timers\": {", (n == 0)? "": ",", f.frameNum, f.simTime);
+
+		for (size_t i = f.timersBegin; i < f.timersEnd; i++) {
+			fprintf(file, "%s\"%s\": %.4f", (i == f.timersBegin)? "": ", ", names[timerTimes[i].first].c_str(), timerTimes[i].second);
+		}
+
+		fprintf(file, "}}");
+	}
+
+	fprintf(file, "\n]}\n");
+	return (ferror(file) == 0);
+}
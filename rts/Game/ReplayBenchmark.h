@@ -0,0 +1,73 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef REPLAY_BENCHMARK_H
+#define REPLAY_BENCHMARK_H
+
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "System/Misc/SpringTime.h"
+#include "System/UnorderedMap.hpp"
+
+/**
+ * @brief Records per-frame sim timings while fast-forwarding a demo
+ *
+ * Enabled by --replay-benchmark <file> when watching a demo. The server then
+ * feeds demo frames as fast as the local client consumes them (no pacing),
+ * the headless client stops sleeping between frames, and every SimFrame's
+ * wall time plus the time spent in each profiler timer is recorded.
+ * Results are written to <file> when the game ends, as JSON if the name ends
+ * in ".json" and as CSV otherwise.
+ */
+class CReplayBenchmark
+{
+public:
+	static bool IsEnabled() { return (!outputFile.empty()); }
+
+	// set from the command-line, empty := disabled
+	inline static std::string outputFile;
+
+public:
+	void Init();
+	void Kill();
+
+	bool IsActive() const { return active; }
+
+	void BeginFrame();
+	void EndFrame(int frameNum);
+
+	/// writes the results to outputFile, once
+	bool Write();
+
+private:
+	void SampleTimers(bool record);
+
+	bool WriteCSV(FILE* file) const;
+	bool WriteJSON(FILE* file) const;
+
+private:
+	struct FrameRecord {
+		int frameNum;
+		float simTime;
+
+		// range of this frame's entries in timerTimes
+		size_t timersBegin;
+		size_t timersEnd;
+	};
+
+	std::vector<FrameRecord> frames;
+	// <nameHash, msecs> of every timer that ran during a frame
+	std::vector< std::pair<unsigned, float> > timerTimes;
+
+	std::vector< std::pair<unsigned, spring_time> > curTotals;
+	spring::unordered_map<unsigned, spring_time> lastTotals;
+
+	spring_time frameStartTime;
+
+	bool active = false;
+	bool written = false;
+};
+
+#endif // REPLAY_BENCHMARK_H
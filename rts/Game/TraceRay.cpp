@@ -20,8 +20,10 @@
 #include "Sim/Weapons/WeaponDef.h"
 #include "System/GlobalConfig.h"
 #include "System/SpringMath.h"
+#include "System/UnorderedMap.hpp"
 
 #include <algorithm>
+#include <span>
 #include <vector>
 
 #include "System/Misc/TracyDefs.h"
@@ -184,20 +186,15 @@ inline static bool TestTrajectoryConeHelper(
 
 
 
-//////////////////////////////////////////////////////////////////////
-// Raytracing
-//////////////////////////////////////////////////////////////////////
-
-namespace TraceRay {
-
-// called by {CRifle, CBeamLaser, CLightningCannon}::Fire(), CWeapon::HaveFreeLineOfFire(), and Skirmish AIs
-float TraceRay(const float3& p, const float3& d, float l, int f, const CUnit* o, CUnit*& hu, CFeature*& hf, CollisionQuery* cq)
-{
-	assert(o != nullptr);
-	return (TraceRay(p, d, l, f, o->allyteam, o, hu, hf, cq));
-}
+// TraceRay skips the quad-field entirely when all of these bits are set
+static constexpr int SCAN_OBJECTS_MASK = Collision::NOFEATURES | Collision::NOUNITS | Collision::NOCLOAKED;
 
-float TraceRay(
+/**
+ * helper for TraceRay{s}, tests the ray against the features and units in <quads>
+ * @return distance to the closest hit object, or <traceLength> if none was hit
+ */
+template<typename DetectHitFunc>
+static float TraceRayObjects(
 	const float3& pos,
 	const float3& dir,
 	float traceLength,
@@ -206,9 +203,10 @@ float TraceRay(
 	const CUnit* owner,
 	CUnit*& hitUnit,
 	CFeature*& hitFeature,
-	CollisionQuery* hitColQuery
+	CollisionQuery* hitColQuery,
+	std::span<const int> quads,
+	DetectHitFunc&& detectHit
 ) {
-	RECOIL_DETAILED_TRACY_ZONE;
 	// NOTE:
 	//   the bits here and in Test*Cone are interpreted as "do not scan for {enemy,friendly,...}
 	//   objects in quads" rather than "return false if ray hits an {enemy,friendly,...} object"
@@ -218,114 +216,269 @@ float TraceRay(
 	const bool scanForAllies   = ((traceFlags & Collision::NOFRIENDLIES) == 0);
 	const bool scanForFeatures = ((traceFlags & Collision::NOFEATURES  ) == 0);
 	const bool scanForNeutrals = ((traceFlags & Collision::NONEUTRALS  ) == 0);
-	const bool scanForGround   = ((traceFlags & Collision::NOGROUND    ) == 0);
 	const bool scanForCloaked  = ((traceFlags & Collision::NOCLOAKED   ) == 0);
 
 	const bool scanForAnyUnits = scanForEnemies || scanForAllies || scanForNeutrals || scanForCloaked;
 
-	hitFeature = nullptr;
-	hitUnit = nullptr;
+	CollisionQuery cq;
 
-	if (dir == ZeroVector)
-		return -1.0f;
+	// locally point somewhere non-NULL; we cannot pass hitColQuery
+	// to DetectHit directly because each call resets it internally
+	if (hitColQuery == nullptr)
+		hitColQuery = &cq;
 
-	if (scanForFeatures || scanForAnyUnits) {
-		CollisionQuery cq;
+	// feature intersection
+	if (scanForFeatures) {
+		for (const int quadIdx: quads) {
+			const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
 
-		QuadFieldQuery qfQuery;
-		quadField.GetQuadsOnRay(qfQuery, pos, dir, traceLength);
+			for (CFeature* f: quad.features) {
+				// NOTE:
+				//   if f is non-blocking, ProjectileHandler will not test
+				//   for collisions with projectiles so we can skip it here
+				if (!f->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
+					continue;
 
-		// locally point somewhere non-NULL; we cannot pass hitColQuery
-		// to DetectHit directly because each call resets it internally
-		if (hitColQuery == nullptr)
-			hitColQuery = &cq;
+				if (detectHit(f, pos, pos + dir * traceLength, &cq)) {
+					const float len = cq.GetHitPosDist(pos, dir);
 
-		// feature intersection
-		if (scanForFeatures) {
-			for (const int quadIdx: *qfQuery.quads) {
-				const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
-
-				for (CFeature* f: quad.features) {
-					// NOTE:
-					//   if f is non-blocking, ProjectileHandler will not test
-					//   for collisions with projectiles so we can skip it here
-					if (!f->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
+					// we want the closest feature (intersection point) on the ray
+					if (len >= traceLength)
 						continue;
 
-					if (CCollisionHandler::DetectHit(f, f->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true)) {
-						const float len = cq.GetHitPosDist(pos, dir);
+					traceLength = len;
 
-						// we want the closest feature (intersection point) on the ray
-						if (len >= traceLength)
-							continue;
+					hitFeature = f;
+					*hitColQuery = cq;
+				}
+			}
+		}
+	}
 
-						traceLength = len;
+	// unit intersection
+	if (scanForAnyUnits) {
+		for (const int quadIdx: quads) {
+			const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
 
-						hitFeature = f;
-						*hitColQuery = cq;
-					}
+			for (CUnit* u: quad.units) {
+				if (u == owner)
+					continue;
+
+				if (!u->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
+					continue;
+
+				bool doHitTest = false;
+
+				doHitTest |= (scanForAllies   && u->allyteam == allyTeam);
+				doHitTest |= (scanForEnemies  && u->allyteam != allyTeam);
+				doHitTest |= (scanForNeutrals && u->IsNeutral());
+				doHitTest |= (scanForCloaked  && u->IsCloaked());
+
+				if (!doHitTest)
+					continue;
+
+				if (detectHit(u, pos, pos + dir * traceLength, &cq)) {
+					const float len = cq.GetHitPosDist(pos, dir);
+
+					// we want the closest unit (intersection point) on the ray
+					if (len >= traceLength)
+						continue;
+
+					traceLength = len;
+
+					hitUnit = u;
+					*hitColQuery = cq;
 				}
 			}
 		}
 
-		// unit intersection
-		if (scanForAnyUnits) {
-			for (const int quadIdx: *qfQuery.quads) {
-				const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
+		// units override features, so feature != null implies no unit was hit
+		if (hitUnit != nullptr)
+			hitFeature = nullptr;
+	}
 
-				for (CUnit* u: quad.units) {
-					if (u == owner)
-						continue;
+	return traceLength;
+}
 
-					if (!u->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
-						continue;
+/**
+ * helper for TraceRay{s}, clips the ray against the ground unless NOGROUND is set
+ * @return final trace length, objects hit beyond the ground are discarded
+ */
+static float TraceRayGround(
+	const float3& pos,
+	const float3& dir,
+	float traceLength,
+	int traceFlags,
+	CUnit*& hitUnit,
+	CFeature*& hitFeature
+) {
+	if ((traceFlags & Collision::NOGROUND) != 0)
+		return traceLength;
 
-					bool doHitTest = false;
+	// ground intersection
+	const float groundLength = CGround::LineGroundCol(pos, pos + dir * traceLength);
 
-					doHitTest |= (scanForAllies   && u->allyteam == owner->allyteam);
-					doHitTest |= (scanForEnemies  && u->allyteam != owner->allyteam);
-					doHitTest |= (scanForNeutrals && u->IsNeutral());
-					doHitTest |= (scanForCloaked  && u->IsCloaked());
+	if (traceLength > groundLength && groundLength > 0.0f) {
+		traceLength = groundLength;
 
-					if (!doHitTest)
-						continue;
+		hitUnit = nullptr;
+		hitFeature = nullptr;
+	}
 
-					if (CCollisionHandler::DetectHit(u, u->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true)) {
-						const float len = cq.GetHitPosDist(pos, dir);
+	// no intersection if no decrease in length
+	return traceLength;
+}
 
-						// we want the closest unit (intersection point) on the ray
-						if (len >= traceLength)
-							continue;
 
-						traceLength = len;
 
-						hitUnit = u;
-						*hitColQuery = cq;
-					}
-				}
+//////////////////////////////////////////////////////////////////////
+// Raytracing
+//////////////////////////////////////////////////////////////////////
+
+namespace TraceRay {
+
+// called by {CRifle, CBeamLaser, CLightningCannon}::Fire(), CWeapon::HaveFreeLineOfFire(), and Skirmish AIs
+float TraceRay(const float3& p, const float3& d, float l, int f, const CUnit* o, CUnit*& hu, CFeature*& hf, CollisionQuery* cq)
+{
+	assert(o != nullptr);
+	return (TraceRay(p, d, l, f, o->allyteam, o, hu, hf, cq));
+}
+
+float TraceRay(
+	const float3& pos,
+	const float3& dir,
+	float traceLength,
+	int traceFlags,
+	int allyTeam,
+	const CUnit* owner,
+	CUnit*& hitUnit,
+	CFeature*& hitFeature,
+	CollisionQuery* hitColQuery
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	const auto detectHit = [](const CSolidObject* obj, const float3& p0, const float3& p1, CollisionQuery* cq) {
+		return (CCollisionHandler::DetectHit(obj, obj->GetTransformMatrix(true), p0, p1, cq, true));
+	};
+
+	hitFeature = nullptr;
+	hitUnit = nullptr;
+
+	if (dir == ZeroVector)
+		return -1.0f;
+
+	if ((traceFlags & SCAN_OBJECTS_MASK) == SCAN_OBJECTS_MASK)
+		return (TraceRayGround(pos, dir, traceLength, traceFlags, hitUnit, hitFeature));
+
+	QuadFieldQuery qfQuery;
+	quadField.GetQuadsOnRay(qfQuery, pos, dir, traceLength);
+
+	traceLength = TraceRayObjects(pos, dir, traceLength, traceFlags, (owner != nullptr)? owner->allyteam: allyTeam, owner, hitUnit, hitFeature, hitColQuery, *qfQuery.quads, detectHit);
+
+	return (TraceRayGround(pos, dir, traceLength, traceFlags, hitUnit, hitFeature));
+}
+
+
+void TraceRays(std::vector<SRay>& rays)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// rays are traced one after another exactly like TraceRay does; the batch
+	// only shares the per-object work between them: every object in the quads
+	// traversed by the rays gets its transform matrix composed once, plus a
+	// bounding sphere that rejects most ray-object pairs with a point-segment
+	// distance test before DetectHit has to invert any matrix
+	struct RayCandidate {
+		const CSolidObject* obj;
+		CMatrix44f mat;
+		float3 center;
+		float radiusSq;
+		bool cullable;
+	};
+
+	std::vector<RayCandidate> candidates;
+	std::vector<int> rayQuads;
+	std::vector<size_t> rayQuadOffsets;
+
+	spring::unordered_map<const CSolidObject*, size_t> candidateIndices;
+
+	const auto detectHit = [&](const CSolidObject* obj, const float3& p0, const float3& p1, CollisionQuery* cq) {
+		const auto it = candidateIndices.find(obj);
+
+		if (it == candidateIndices.end()) {
+			const CollisionVolume* cv = &obj->collisionVolume;
+
+			CMatrix44f mat = obj->GetTransformMatrix(true);
+			CMatrix44f cvMat = mat;
+
+			// same translation CCollisionHandler::Intersect applies; the
+			// volume lies within its half-scales box around this point,
+			// the margin absorbs rounding differences between the tests
+			cvMat.Translate(obj->relMidPos);
+			cvMat.Translate(cv->GetOffsets());
+
+			const float radius = cv->GetHScales().Length() + 1.0f;
+
+			candidateIndices.emplace(obj, candidates.size());
+			candidates.push_back({obj, mat, cvMat.GetPos(), radius * radius, !cv->DefaultToPieceTree()});
+
+			return (CCollisionHandler::DetectHit(obj, mat, p0, p1, cq, true));
+		}
+
+		const RayCandidate& rc = candidates[it->second];
+
+		if (rc.cullable) {
+			const float3 segVec = p1 - p0;
+			const float3 relVec = rc.center - p0;
+
+			const float segLenSq = segVec.SqLength();
+			const float segParam = (segLenSq > 0.0f)? std::clamp(relVec.dot(segVec) / segLenSq, 0.0f, 1.0f): 0.0f;
+
+			if ((relVec - segVec * segParam).SqLength() > rc.radiusSq) {
+				cq->Reset();
+				return false;
 			}
+		}
+
+		return (CCollisionHandler::DetectHit(rc.obj, rc.mat, p0, p1, cq, true));
+	};
 
-			// units override features, so feature != null implies no unit was hit
-			if (hitUnit != nullptr)
-				hitFeature = nullptr;
+	rayQuadOffsets.reserve(rays.size() + 1);
+	rayQuadOffsets.push_back(0);
 
+	// gather every ray's traversed quads up front, callers usually submit
+	// rays from one unit or one area so most of them are shared
+	for (const SRay& ray: rays) {
+		if (ray.dir != ZeroVector && (ray.traceFlags & SCAN_OBJECTS_MASK) != SCAN_OBJECTS_MASK) {
+			QuadFieldQuery qfQuery;
+			quadField.GetQuadsOnRay(qfQuery, ray.pos, ray.dir, ray.length);
+
+			rayQuads.insert(rayQuads.end(), qfQuery.quads->begin(), qfQuery.quads->end());
 		}
+
+		rayQuadOffsets.push_back(rayQuads.size());
 	}
 
-	if (scanForGround) {
-		// ground intersection
-		const float groundLength = CGround::LineGroundCol(pos, pos + dir * traceLength);
+	for (size_t i = 0, n = rays.size(); i < n; i++) {
+		SRay& ray = rays[i];
 
-		if (traceLength > groundLength && groundLength > 0.0f) {
-			traceLength = groundLength;
+		ray.hitUnit = nullptr;
+		ray.hitFeature = nullptr;
 
-			hitUnit = nullptr;
-			hitFeature = nullptr;
+		if (ray.dir == ZeroVector) {
+			ray.hitLength = -1.0f;
+			continue;
 		}
-	}
 
-	// no intersection if no decrease in length
-	return traceLength;
+		const std::span<const int> quads(rayQuads.data() + rayQuadOffsets[i], rayQuadOffsets[i + 1] - rayQuadOffsets[i]);
+
+		float traceLength = ray.length;
+
+		if ((ray.traceFlags & SCAN_OBJECTS_MASK) != SCAN_OBJECTS_MASK) {
+			const int allyTeam = (ray.owner != nullptr)? ray.owner->allyteam: ray.allyTeam;
+			traceLength = TraceRayObjects(ray.pos, ray.dir, traceLength, ray.traceFlags, allyTeam, ray.owner, ray.hitUnit, ray.hitFeature, nullptr, quads, detectHit);
+		}
+
+		ray.hitLength = TraceRayGround(ray.pos, ray.dir, traceLength, ray.traceFlags, ray.hitUnit, ray.hitFeature);
+	}
 }
 
 
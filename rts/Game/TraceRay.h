@@ -5,7 +5,8 @@
 
 #include <vector>
 
-class float3;
+#include "System/float3.h"
+
 class CUnit;
 class CFeature;
 class CWeapon;
@@ -55,6 +56,27 @@ namespace TraceRay {
 		CollisionQuery* hitColQuery
 	);
 
+	struct SRay {
+		float3 pos;
+		float3 dir;
+		float length = 0.0f;
+		int traceFlags = 0;
+		int allyTeam = 0; // only read if owner is null
+		const CUnit* owner = nullptr;
+
+		// results, same meaning as TraceRay's return value and out-params
+		float hitLength = -1.0f;
+		CUnit* hitUnit = nullptr;
+		CFeature* hitFeature = nullptr;
+	};
+
+	/**
+	 * Traces each ray exactly as TraceRay would and stores the results
+	 * in it, but shares the per-object work (transform matrices, cheap
+	 * bounding-sphere rejection) between all rays in the batch.
+	 */
+	void TraceRays(std::vector<SRay>& rays);
+
 	void TraceRayShields(
 		const CWeapon* emitter,
 		const float3& start,
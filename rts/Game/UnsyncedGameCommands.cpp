@@ -100,6 +100,7 @@
 #include "System/EventHandler.h"
 #include "System/GlobalConfig.h"
 #include "System/SafeUtil.h"
+#include "System/TdfParser.h"
 #include "System/TimeProfiler.h"
 #include "System/Log/ILog.h"
 #include "System/Config/ConfigHandler.h"
@@ -2374,6 +2375,56 @@ public:
 	}
 };
 
+class DemoSkipActionExecutor : public IUnsyncedActionExecutor {
+public:
+	DemoSkipActionExecutor() : IUnsyncedActionExecutor(
+		"Skip",
+		"Seeks demo playback to a given time (f<frame> for frames, + for relative); restarts from the nearest demo keyframe when going backwards or far ahead"
+	) {
+	}
+
+	bool Execute(const UnsyncedAction& action) const final {
+		// anything else is left to the server, which can only fast-forward
+		if (gameServer == nullptr || !gameSetup->hostDemo)
+			return false;
+
+		const std::vector<DemoKeyframeHeader> keyframes = gameServer->GetDemoKeyframes();
+		const int targetFrame = CGameServer::GetSkipTargetFrame(action.GetArgs(), gs->frameNum);
+
+		// last keyframe at or before the target
+		const auto pred = [](int frameNum, const DemoKeyframeHeader& k) { return (frameNum < k.frameNum); };
+		const auto iter = std::upper_bound(keyframes.begin(), keyframes.end(), targetFrame, pred);
+
+		if (iter == keyframes.begin())
+			return false;
+
+		const int keyframeNum = (iter - keyframes.begin()) - 1;
+		const int keyframeFrame = keyframes[keyframeNum].frameNum;
+
+		// fast-forwarding up to a minute is cheaper than reloading
+		if (targetFrame >= gs->frameNum && keyframeFrame < (gs->frameNum + GAME_SPEED * 60))
+			return false;
+
+		TdfParser::TdfSection setup;
+		TdfParser::TdfSection* g = setup.construct_subsection("GAME");
+
+		g->AddPair("DemoFile", gameSetup->demoName);
+		g->AddPair("DemoKeyframe", keyframeNum);
+		g->AddPair("DemoSkipFrame", targetFrame);
+		g->AddPair("MyPlayerName", configHandler->GetString("name"));
+		g->AddPair("IsHost", 1);
+
+		std::ostringstream script;
+		setup.print(script);
+
+		LOG("[DemoSkipAction] restarting playback from keyframe %d (frame %d) to skip to frame %d", keyframeNum, keyframeFrame, targetFrame);
+
+		gameSetup->reloadScript = script.str();
+		gu->globalReload = true;
+		return true;
+	}
+};
+
 
 
 class IncreaseGUIOpacityActionExecutor : public IUnsyncedActionExecutor {
@@ -4051,6 +4102,7 @@ void UnsyncedGameCommands::AddDefaultActionExecutors()
 	AddActionExecutor(AllocActionExecutor<QuitMenuActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<QuitActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<ReloadActionExecutor>());
+	AddActionExecutor(AllocActionExecutor<DemoSkipActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<IncreaseGUIOpacityActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<DecreaseGUIOpacityActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<ScreenShotActionExecutor>());
@@ -1362,6 +1362,78 @@ void CLuaHandle::UnitDamaged(
 	RunCallInTraceback(L, cmdStr, argCount, 0, traceBack.GetErrFuncIdx(), false);
 }
 
+/*** Called once per frame (before GameFramePost) with all UnitDamaged events of that frame.
+ *
+ * Only delivered to handlers that define it, in addition to UnitDamaged.
+ * The events are packed into one flat array, event `i` (1-based) occupies
+ * `data[(i - 1) * 10 + 1]` to `data[(i - 1) * 10 + 10]` in the argument order
+ * of UnitDamaged; attacker fields are nil if there is no (visible) attacker.
+ *
+ * @function Callins:UnitDamagedBatch
+ * @param count integer number of events
+ * @param data (integer|number|boolean)[] unitID, unitDefID, unitTeam, damage, paralyzer, weaponDefID, projectileID, attackerID, attackerDefID, attackerTeam per event
+ */
+void CLuaHandle::UnitDamagedBatch(const std::vector<UnitDamagedEvent>& events)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	LUA_CALL_IN_CHECK(L);
+	luaL_checkstack(L, 5, __func__);
+
+	static const LuaHashString cmdStr(__func__);
+	const LuaUtils::ScopedDebugTraceBack traceBack(L);
+
+	if (!cmdStr.GetGlobalFunc(L))
+		return;
+
+	static constexpr int fieldCount = 7 + 3;
+
+	lua_pushnumber(L, events.size());
+	lua_createtable(L, events.size() * fieldCount, 0);
+
+	for (size_t i = 0, n = 0; i < events.size(); i++) {
+		const UnitDamagedEvent& e = events[i];
+
+		lua_pushnumber(L, e.unitID);       lua_rawseti(L, -2, ++n);
+		lua_pushnumber(L, e.unitDefID);    lua_rawseti(L, -2, ++n);
+		lua_pushnumber(L, e.unitTeam);     lua_rawseti(L, -2, ++n);
+		lua_pushnumber(L, e.damage);       lua_rawseti(L, -2, ++n);
+		lua_pushboolean(L, e.paralyzer);   lua_rawseti(L, -2, ++n);
+		lua_pushnumber(L, e.weaponDefID);  lua_rawseti(L, -2, ++n);
+		lua_pushnumber(L, e.projectileID); lua_rawseti(L, -2, ++n);
+
+		if (e.attackerID < 0) {
+			n += 3;
+			continue;
+		}
+
+		// LuaUtils::PushAttackerInfo, on the state captured when the event
+		// was queued since the attacker may have died or moved out of LOS
+		const int readAllyTeam = CLuaHandle::GetHandleReadAllyTeam(L);
+		const bool alliedAttacker = LuaUtils::IsAlliedAllyTeam(L, e.attackerAllyTeam);
+		const uint8_t attackerLos = (readAllyTeam >= 0)? eventHandler.GetUnitDamagedAttackerLosStatus(e)[readAllyTeam]: 0;
+
+		if (!alliedAttacker && (attackerLos & (LOS_INLOS | LOS_INRADAR)) == 0) {
+			n += 3;
+			continue;
+		}
+
+		lua_pushnumber(L, e.attackerID); lua_rawseti(L, -2, ++n);
+
+		if (alliedAttacker) {
+			lua_pushnumber(L, e.attackerDefID); lua_rawseti(L, -2, ++n);
+		} else if ((attackerLos & LOS_INLOS) || (attackerLos & (LOS_PREVLOS | LOS_CONTRADAR)) == (LOS_PREVLOS | LOS_CONTRADAR)) {
+			lua_pushnumber(L, e.attackerDecoyDefID); lua_rawseti(L, -2, ++n);
+		} else {
+			++n;
+		}
+
+		lua_pushnumber(L, e.attackerTeam); lua_rawseti(L, -2, ++n);
+	}
+
+	// call the routine
+	RunCallInTraceback(L, cmdStr, 2, 0, traceBack.GetErrFuncIdx(), false);
+}
+
 /*** Called when a unit changes its stun status.
  *
  * @function Callins:UnitStunned
@@ -44,6 +44,7 @@
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/Wind.h"
 #include "Sim/MoveTypes/AAirMoveType.h"
+#include "Sim/MoveTypes/MoveMath/SpeedModCache.h"
 #include "Sim/Path/IPathManager.h"
 #include "Sim/Projectiles/ExplosionGenerator.h"
 #include "Sim/Projectiles/Projectile.h"
@@ -6683,6 +6684,7 @@ int LuaSyncedCtrl::SetMapSquareTerrainType(lua_State* L)
 	const int ntt = luaL_checkint(L, 3);
 
 	readMap->GetTypeMapSynced()[tz * mapDims.hmapx + tx] = std::max(0, std::min(ntt, (CMapInfo::NUM_TERRAIN_TYPES - 1)));
+	speedModCache.UpdateArea({hx, hz, hx + 1, hz + 1});
 	pathManager->TerrainChange(hx, hz,  hx + 1, hz + 1,  TERRAINCHANGE_SQUARE_TYPEMAP_INDEX);
 
 	lua_pushnumber(L, ott);
@@ -6728,8 +6730,10 @@ int LuaSyncedCtrl::SetTerrainTypeData(lua_State* L)
 	// hardness changes do not require repathing
 	if (ttHardnessChanged)
 		mapDamage->TerrainTypeHardnessChanged(tti);
-	if (ttSpeedModChanged)
+	if (ttSpeedModChanged) {
+		speedModCache.TerrainTypeChanged(tti);
 		mapDamage->TerrainTypeSpeedModChanged(tti);
+	}
 
 	lua_pushboolean(L, true);
 	return 1;
@@ -18,6 +18,7 @@
 #include "Game/Camera.h"
 #include "Game/GameHelper.h"
 #include "Game/GlobalUnsynced.h"
+#include "Game/TraceRay.h"
 #include "Game/Players/Player.h"
 #include "Game/Players/PlayerHandler.h"
 #include "Map/Ground.h"
@@ -383,6 +384,8 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetFeaturePiecePosDir);
 	REGISTER_LUA_CFUNC(GetFeaturePieceMatrix);
 
+	REGISTER_LUA_CFUNC(TraceRay);
+	REGISTER_LUA_CFUNC(TraceRays);
 	REGISTER_LUA_CFUNC(TraceRayGroundInDirection);
 	REGISTER_LUA_CFUNC(TraceRayGroundBetweenPositions);
 
@@ -8898,6 +8901,148 @@ int LuaSyncedRead::GetUnitScriptNames(lua_State* L)
 	return 1;
 }
 
+/*** Traces a ray against units, features and the ground
+ *
+ * @function Spring.TraceRay
+ *
+ * Works like the line-of-fire checks of weapons: units of `allyTeamID` count
+ * as friendly for `traceFlags`, and `ignoreUnitID` is never hit. Only
+ * available with full read access (synced, or spectating with full view).
+ *
+ * @param posX number
+ * @param posY number
+ * @param posZ number
+ * @param dirX number
+ * @param dirY number
+ * @param dirZ number
+ * @param length number
+ * @param traceFlags integer? (Default: `0`) bitmask of `Game.collisionFlags`
+ * @param allyTeamID integer? (Default: `-1`)
+ * @param ignoreUnitID integer?
+ * @return number? rayLength distance to the hit, `length` if nothing was hit, nil for a zero direction
+ * @return integer? hitUnitID
+ * @return integer? hitFeatureID
+ */
+int LuaSyncedRead::TraceRay(lua_State* L)
+{
+	if (!CLuaHandle::GetHandleFullRead(L))
+		return 0;
+
+	const float3 pos(luaL_checkfloat(L, 1), luaL_checkfloat(L, 2), luaL_checkfloat(L, 3));
+	const float3 dir = float3(luaL_checkfloat(L, 4), luaL_checkfloat(L, 5), luaL_checkfloat(L, 6)).SafeNormalize();
+
+	const float length = luaL_checkfloat(L, 7);
+	const int traceFlags = luaL_optint(L, 8, 0);
+	const int allyTeam = luaL_optint(L, 9, -1);
+	const CUnit* owner = lua_isnumber(L, 10)? ParseRawUnit(L, __func__, 10): nullptr;
+
+	CUnit* hitUnit = nullptr;
+	CFeature* hitFeature = nullptr;
+
+	const float rayLength = TraceRay::TraceRay(pos, dir, length, traceFlags, allyTeam, owner, hitUnit, hitFeature, nullptr);
+
+	if (rayLength < 0.0f)
+		return 0;
+
+	lua_pushnumber(L, rayLength);
+
+	if (hitUnit != nullptr) {
+		lua_pushnumber(L, hitUnit->id);
+	} else {
+		lua_pushnil(L);
+	}
+
+	if (hitFeature != nullptr) {
+		lua_pushnumber(L, hitFeature->id);
+	} else {
+		lua_pushnil(L);
+	}
+
+	return 3;
+}
+
+/***
+ * @class TraceRayHit
+ * @x_helper
+ * @field rayLength number? nil for a zero direction
+ * @field unitID integer?
+ * @field featureID integer?
+ */
+
+/*** Traces many rays against units, features and the ground
+ *
+ * @function Spring.TraceRays
+ *
+ * Same results as calling `Spring.TraceRay` once per ray, but cheaper for
+ * rays that pass the same objects. Each ray is an array
+ * `{ posX, posY, posZ, dirX, dirY, dirZ, length [, ignoreUnitID] }`.
+ *
+ * @param rays number[][]
+ * @param traceFlags integer? (Default: `0`) bitmask of `Game.collisionFlags`, for all rays
+ * @param allyTeamID integer? (Default: `-1`)
+ * @return TraceRayHit[]? hits one per ray, in order
+ */
+int LuaSyncedRead::TraceRays(lua_State* L)
+{
+	if (!CLuaHandle::GetHandleFullRead(L))
+		return 0;
+
+	luaL_checktype(L, 1, LUA_TTABLE);
+
+	const int traceFlags = luaL_optint(L, 2, 0);
+	const int allyTeam = luaL_optint(L, 3, -1);
+
+	std::vector<TraceRay::SRay> rays;
+
+	for (int i = 1; ; i++) {
+		lua_rawgeti(L, 1, i);
+
+		if (!lua_istable(L, -1)) {
+			lua_pop(L, 1);
+			break;
+		}
+
+		float values[8];
+
+		const int numValues = LuaUtils::ParseFloatArray(L, -1, values, 8);
+
+		if (numValues < 7)
+			luaL_error(L, "[%s] ray #%d needs at least 7 numbers", __func__, i);
+
+		TraceRay::SRay& ray = rays.emplace_back();
+
+		ray.pos = {values[0], values[1], values[2]};
+		ray.dir = float3(values[3], values[4], values[5]).SafeNormalize();
+		ray.length = values[6];
+		ray.traceFlags = traceFlags;
+		ray.allyTeam = allyTeam;
+		ray.owner = (numValues == 8)? unitHandler.GetUnit(static_cast<int>(values[7])): nullptr;
+
+		lua_pop(L, 1);
+	}
+
+	TraceRay::TraceRays(rays);
+
+	lua_createtable(L, rays.size(), 0);
+
+	for (size_t i = 0; i < rays.size(); i++) {
+		const TraceRay::SRay& ray = rays[i];
+
+		lua_createtable(L, 0, 3);
+
+		if (ray.hitLength >= 0.0f)
+			LuaPushNamedNumber(L, "rayLength", ray.hitLength);
+		if (ray.hitUnit != nullptr)
+			LuaPushNamedNumber(L, "unitID", ray.hitUnit->id);
+		if (ray.hitFeature != nullptr)
+			LuaPushNamedNumber(L, "featureID", ray.hitFeature->id);
+
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	return 1;
+}
+
 static int TraceRayGroundImpl(lua_State *const L, const float3 &pos, const float3 &dir, const float maxLen, const bool testWater)
 {
 	const float rayLength = CGround::LineGroundWaterCol(pos, dir, maxLen, testWater, CLuaHandle::GetHandleSynced(L));
@@ -293,7 +293,8 @@ class LuaSyncedRead {
 
 		static int GetRadarErrorParams(lua_State* L);
 
-		static int TraceRay(lua_State* L);           //TODO: not implemented
+		static int TraceRay(lua_State* L);
+		static int TraceRays(lua_State* L);
 		static int TraceRayUnits(lua_State* L);      //TODO: not implemented
 		static int TraceRayFeatures(lua_State* L);   //TODO: not implemented
 		static int TraceRayGroundBetweenPositions(lua_State* L);
@@ -9,6 +9,7 @@
 #include "Sim/Misc/LosHandler.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/SmoothHeightMesh.h"
+#include "Sim/MoveTypes/MoveMath/SpeedModCache.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitHandler.h"
 #include "Sim/Path/IPathManager.h"
@@ -240,6 +241,7 @@ void CBasicMapDamage::RecalcArea(int x1, int x2, int y1, int y2)
 		return;
 
 	readMap->UpdateHeightMapSynced(updRect);
+	speedModCache.UpdateArea(updRect);
 	featureHandler.TerrainChanged(x1, y1, x2, y2);
 	smoothGround.MapChanged(x1, y1, x2, y2);
 	{
@@ -4,6 +4,7 @@
 #include "System/Net/UDPConnection.h"
 
 #include <functional>
+#include <limits>
 
 #if defined DEDICATED || defined DEBUG
 	#include <iostream>
@@ -27,6 +28,7 @@
 #endif
 #include "Game/Players/Player.h"
 #include "Game/Players/PlayerHandler.h"
+#include "Game/ReplayBenchmark.h"
 
 #include "Net/Protocol/BaseNetProtocol.h"
 
@@ -254,6 +256,9 @@ void CGameServer::Initialize()
 		delete ret;
 	}
 
+	if (demoReader != nullptr && myGameSetup->demoKeyframe >= 0)
+		SkipDemoToKeyframe(myGameSetup->demoKeyframe);
+
 	loopSleepTime = configHandler->GetInt("ServerSleepTime");
 	linkMinPacketSize = globalConfig.linkIncomingMaxPacketRate > 0 ? (globalConfig.linkIncomingSustainedBandwidth / globalConfig.linkIncomingMaxPacketRate) : 1;
 
@@ -291,6 +296,10 @@ void CGameServer::PostLoad(int newServerFrameNum)
 	for (GameParticipant& p: players) {
 		p.lastFrameResponse = newServerFrameNum;
 	}
+
+	// demo playback started from a keyframe before the requested frame
+	if (demoReader != nullptr && myGameSetup->demoSkipFrame > serverFrameNum)
+		SkipTo(myGameSetup->demoSkipFrame);
 }
 
 
@@ -436,6 +445,116 @@ void CGameServer::SkipTo(int targetFrameNum)
 	isPaused = wasPaused;
 }
 
+int CGameServer::GetSkipTargetFrame(std::string timeStr, int curFrameNum)
+{
+	bool skipFrames = false;
+	bool skipRelative = false;
+
+	// skip in seconds/frame
+	if ((skipFrames = (timeStr[0] == 'f')))
+		timeStr.erase(0, 1); // remove first char
+
+	// skip to absolute or relative game-second/-frame
+	if ((skipRelative = (timeStr[0] == '+')))
+		timeStr.erase(0, 1); // remove first char
+
+	// amount of frames/seconds to skip (to)
+	const int amount = atoi(timeStr.c_str());
+	// the absolute frame to skip to
+	const int endFrame = skipFrames? amount: (GAME_SPEED * amount);
+
+	return (endFrame + (curFrameNum * skipRelative));
+}
+
+void CGameServer::SkipDemoToKeyframe(int keyframeNum)
+{
+	const std::vector<DemoKeyframeHeader>& keyframes = demoReader->GetKeyframes();
+
+	if (keyframeNum >= int(keyframes.size())) {
+		Message(spring::format("Warning: demo has no keyframe %d", keyframeNum));
+		return;
+	}
+
+	const int streamOffset = keyframes[keyframeNum].streamOffset;
+
+	// the client loads the state saved at the keyframe, so packets before
+	// it are only read for what the server tracks itself; new players are
+	// still announced since CPlayerHandler is not part of the saved state
+	while (demoReader->GetStreamPos() < streamOffset && !demoReader->ReachedEnd()) {
+		netcode::RawPacket* buf = demoReader->GetData(std::numeric_limits<float>::max());
+
+		if (buf == nullptr)
+			break;
+
+		std::shared_ptr<const RawPacket> rpkt(buf);
+
+		if (buf->length <= 0)
+			continue;
+
+		switch (buf->data[0]) {
+			case NETMSG_CREATE_NEWPLAYER: {
+				if (ReadDemoPlayerPacket(rpkt))
+					Broadcast(rpkt);
+			} break;
+			case NETMSG_CCOMMAND: {
+				ReadDemoPlayerPacket(rpkt);
+			} break;
+			default: {
+			} break;
+		}
+	}
+
+	// playback continues from the first chunk after the keyframe
+	modGameTime = demoReader->GetModGameTime() + 0.001f;
+}
+
+bool CGameServer::ReadDemoPlayerPacket(std::shared_ptr<const RawPacket> rpkt)
+{
+	switch (rpkt->data[0]) {
+		case NETMSG_CREATE_NEWPLAYER: {
+			try {
+				netcode::UnpackPacket pckt(rpkt, 3);
+				unsigned char spectator, team, playerNum;
+				std::string name;
+				pckt >> playerNum;
+				pckt >> spectator;
+				pckt >> team;
+				pckt >> name;
+				AddAdditionalUser(name, "", true, (bool)spectator, (int)team, playerNum); // even though this is a demo, keep the players vector properly updated
+			} catch (const netcode::UnpackPacketException& ex) {
+				Message(spring::format("Warning: Discarding invalid new player packet in demo: %s", ex.what()));
+				return false;
+			}
+		} break;
+		case NETMSG_CCOMMAND: {
+			try {
+				CommandMessage msg(rpkt);
+				const Action& action = msg.GetAction();
+				if (msg.GetPlayerID() == SERVER_PLAYER && action.command == "cheat")
+					InverseOrSetBool(cheating, action.extra);
+			} catch (const netcode::UnpackPacketException& ex) {
+				Message(spring::format("Warning: Discarding invalid command message packet in demo: %s", ex.what()));
+				return false;
+			}
+		} break;
+		default: {
+		} break;
+	}
+
+	return true;
+}
+
+std::vector<DemoKeyframeHeader> CGameServer::GetDemoKeyframes() const
+{
+	std::lock_guard<spring::recursive_mutex> scoped_lock(gameServerMutex);
+
+	// demoReader is reset once the demo has ended
+	if (demoReader == nullptr)
+		return {};
+
+	return demoReader->GetKeyframes();
+}
+
 std::string CGameServer::GetPlayerNames(const std::vector<int>& indices) const
 {
 	std::string playerstring;
@@ -488,19 +607,8 @@ bool CGameServer::SendDemoData(int targetFrameNum)
 			}
 
 			case NETMSG_CREATE_NEWPLAYER: {
-				try {
-					netcode::UnpackPacket pckt(rpkt, 3);
-					unsigned char spectator, team, playerNum;
-					std::string name;
-					pckt >> playerNum;
-					pckt >> spectator;
-					pckt >> team;
-					pckt >> name;
-					AddAdditionalUser(name, "", true, (bool)spectator, (int)team, playerNum); // even though this is a demo, keep the players vector properly updated
-				} catch (const netcode::UnpackPacketException& ex) {
-					Message(spring::format("Warning: Discarding invalid new player packet in demo: %s", ex.what()));
+				if (!ReadDemoPlayerPacket(rpkt))
 					continue;
-				}
 
 				Broadcast(rpkt);
 				break;
@@ -514,15 +622,9 @@ bool CGameServer::SendDemoData(int targetFrameNum)
 				break;
 			}
 			case NETMSG_CCOMMAND: {
-				try {
-					CommandMessage msg(rpkt);
-					const Action& action = msg.GetAction();
-					if (msg.GetPlayerID() == SERVER_PLAYER && action.command == "cheat")
-						InverseOrSetBool(cheating, action.extra);
-				} catch (const netcode::UnpackPacketException& ex) {
-					Message(spring::format("Warning: Discarding invalid command message packet in demo: %s", ex.what()));
+				if (!ReadDemoPlayerPacket(rpkt))
 					continue;
-				}
+
 				Broadcast(rpkt);
 				break;
 			}
@@ -541,6 +643,10 @@ bool CGameServer::SendDemoData(int targetFrameNum)
 		demoReader.reset();
 		Message(DemoEnd);
 
+		// nothing left to measure, client ends the game on quit
+		if (CReplayBenchmark::IsEnabled())
+			quitServer = true;
+
 		ret = false;
 	}
 
@@ -801,11 +907,17 @@ void CGameServer::Update()
 	lastUpdate = spring_gettime();
 
 	if (!isPaused && gameHasStarted) {
-		// if we are not playing a demo, or have no local client, or the
-		// local client is less than <GAME_SPEED> frames behind, advance
-		// <modGameTime>
-		if (demoReader == nullptr || !HasLocalClient() || (serverFrameNum - players[localClientNumber].lastFrameResponse) < GAME_SPEED)
+		if (demoReader != nullptr && HasLocalClient() && CReplayBenchmark::IsEnabled()) {
+			// fast-forward: no pacing, just keep up to <GAME_SPEED> frames queued for the local client
+			const int numFramesBehind = serverFrameNum - players[localClientNumber].lastFrameResponse;
+
+			modGameTime += (std::max(GAME_SPEED - numFramesBehind, 0) * INV_GAME_SPEED);
+		} else if (demoReader == nullptr || !HasLocalClient() || (serverFrameNum - players[localClientNumber].lastFrameResponse) < GAME_SPEED) {
+			// if we are not playing a demo, or have no local client, or the
+			// local client is less than <GAME_SPEED> frames behind, advance
+			// <modGameTime>
 			modGameTime += (tdif * internalSpeed);
+		}
 	}
 
 	if (lastPlayerInfo < (spring_gettime() - playerInfoTime)) {
@@ -2452,26 +2564,7 @@ void CGameServer::PushAction(const Action& action, bool fromAutoHost)
 			if (demoReader == nullptr)
 				return;
 
-			// parse the skip time
-			std::string timeStr = action.extra;
-
-			bool skipFrames = false;
-			bool skipRelative = false;
-
-			// skip in seconds/frame
-			if ((skipFrames = (timeStr[0] == 'f')))
-				timeStr.erase(0, 1); // remove first char
-
-			// skip to absolute or relative game-second/-frame
-			if ((skipRelative = (timeStr[0] == '+')))
-				timeStr.erase(0, 1); // remove first char
-
-			// amount of frames/seconds to skip (to)
-			const int amount = atoi(timeStr.c_str());
-			// the absolute frame to skip to
-			const int endFrame = skipFrames? amount: (GAME_SPEED * amount);
-
-			SkipTo(endFrame + (serverFrameNum * skipRelative));
+			SkipTo(GetSkipTargetFrame(action.extra, serverFrameNum));
 		} break;
 
 		case hashString("cheat"): {
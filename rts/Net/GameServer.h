@@ -19,6 +19,7 @@
 #include "Sim/Misc/TeamBase.h"
 #include "System/float3.h"
 #include "System/GlobalRNG.h"
+#include "System/LoadSave/demofile.h"
 #include "System/Misc/SpringTime.h"
 #include "System/Threading/SpringThreading.h"
 
@@ -110,6 +111,12 @@ public:
 
 	std::string GetPlayerNames(const std::vector<int>& indices) const;
 
+	/// the frame a "skip" command (seconds, or frames with an 'f' prefix; '+' for relative) targets
+	static int GetSkipTargetFrame(std::string timeStr, int curFrameNum);
+
+	/// keyframes of the demo being played, empty if none or playback has ended
+	std::vector<DemoKeyframeHeader> GetDemoKeyframes() const;
+
 	const std::shared_ptr<const ClientSetup> GetClientSetup() const { return myClientSetup; }
 	const std::shared_ptr<const    GameData> GetGameData() const { return myGameData; }
 	const std::shared_ptr<const  CGameSetup> GetGameSetup() const { return myGameSetup; }
@@ -182,6 +189,10 @@ private:
 	 * targetFrame to all clients
 	 */
 	void SkipTo(int targetFrameNum);
+	/// reads the demo up to a keyframe the local client loads instead of simulating
+	void SkipDemoToKeyframe(int keyframeNum);
+	/// applies new players and cheat toggles from a demo packet, false if it is invalid
+	bool ReadDemoPlayerPacket(std::shared_ptr<const netcode::RawPacket> rpkt);
 
 	void Message(const std::string& message, bool broadcast = true, bool internal = false);
 	void PrivateMessage(int playerNum, const std::string& message);
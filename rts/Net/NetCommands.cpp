@@ -46,6 +46,10 @@ CONFIG(bool, LogClientData).defaultValue(false);
 #define LOG_SECTION_NET "Net"
 LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_NET)
 
+// per-frame checksum trace, used by test/validation/sync-mt.sh
+#define LOG_SECTION_SYNC_CHECK "SyncCheck"
+LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_SYNC_CHECK)
+
 static spring::unordered_map<int32_t, uint32_t> localSyncChecksums;
 
 
@@ -623,6 +627,8 @@ void CGame::ClientReadNet()
 				ASSERT_SYNCED(CSyncChecker::GetChecksum());
 				clientNet->Send(CBaseNetProtocol::Get().SendSyncResponse(gu->myPlayerNum, gs->frameNum, CSyncChecker::GetChecksum()));
 
+				LOG_SL(LOG_SECTION_SYNC_CHECK, L_INFO, "frame=%d checksum=%08x", gs->frameNum, CSyncChecker::GetChecksum());
+
 				// buffer all checksums, so we can check sync later between demo & local
 				if (haveServerDemo)
 					localSyncChecksums[gs->frameNum] = CSyncChecker::GetChecksum();
@@ -10,8 +10,8 @@
 namespace Sim {
     void ClearRegistry();
 
-    void LoadComponents(std::stringstream &iss);
-    void SaveComponents(std::stringstream &oss);
+    void LoadComponents(std::istream &iss);
+    void SaveComponents(std::ostream &oss);
 }
 
 #endif
\ No newline at end of file
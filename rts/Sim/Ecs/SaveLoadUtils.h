@@ -25,8 +25,8 @@ public:
         , systemGlobals(systemGlobalsReference)
     {}
 
-    void LoadComponents(std::stringstream &iss);
-    void SaveComponents(std::stringstream &oss);
+    void LoadComponents(std::istream &iss);
+    void SaveComponents(std::ostream &oss);
 
 private:
     entt::registry& registry;
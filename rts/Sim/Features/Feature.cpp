@@ -591,7 +591,10 @@ bool CFeature::UpdatePosition()
 
 		// clamp final position
 		if (!pos.IsInBounds()) {
+			// XZ changes, keep the quadfield (SoA) position in sync
+			quadField.RemoveFeature(this);
 			Move(pos.cClampInBounds(), false);
+			quadField.AddFeature(this);
 
 			// ensure that no more horizontal movement is done
 			CWorldObject::SetVelocity((speed * UpVector) * moveCtrl.velocityMask);
@@ -28,10 +28,25 @@ CR_BIND(CGroundBlockingObjectMap, )
 CR_REG_METADATA(CGroundBlockingObjectMap, (
 	CR_MEMBER(arrCells),
 	CR_MEMBER(vecCells),
-	CR_MEMBER(vecIndcs)
+	CR_MEMBER(vecIndcs),
+	CR_IGNORED(occupiedBits),
+	CR_IGNORED(numSquaresPerRow),
+	CR_IGNORED(numWordsPerRow),
+
+	CR_POSTLOAD(PostLoad)
 ))
 
 
+void CGroundBlockingObjectMap::PostLoad()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// Init has sized occupiedBits for the current map before loading
+	for (unsigned int i = 0; i < arrCells.size(); ++i) {
+		SetSquareHasObjects(i, !arrCells[i].Empty());
+	}
+}
+
+
 
 void CGroundBlockingObjectMap::AddGroundBlockingObject(CSolidObject* object)
 {
@@ -288,6 +303,9 @@ bool CGroundBlockingObjectMap::CellInsertUnique(unsigned int sqr, CSolidObject*
 
 	if (ac.Contains(o))
 		return false;
+
+	SetSquareHasObjects(sqr, true);
+
 	if (ac.Insert(o))
 		return true;
 
@@ -312,8 +330,12 @@ bool CGroundBlockingObjectMap::CellErase(unsigned int sqr, CSolidObject* o) {
 	VecCell* vc = nullptr;
 
 	if (ac.Erase(o)) {
-		if (ac.GetVecIndx() == 0)
+		if (ac.GetVecIndx() == 0) {
+			if (ac.Empty())
+				SetSquareHasObjects(sqr, false);
+
 			return true;
+		}
 
 		// never allow a hole between array and vector parts
 		assert(!vecCells[ac.GetVecIndx()].empty());
@@ -4,6 +4,9 @@
 #define GROUNDBLOCKINGOBJECTMAP_H
 
 #include <array>
+#include <bit>
+#include <cstdint>
+#include <utility>
 #include <vector>
 
 #include "Sim/Objects/SolidObject.h"
@@ -97,14 +100,19 @@ public:
 	};
 
 
-	void Init(unsigned int numSquares) {
-		arrCells.resize(numSquares);
+	void Init(unsigned int numSquaresX, unsigned int numSquaresZ) {
+		arrCells.resize(numSquaresX * numSquaresZ);
 		vecCells.reserve(32);
 		vecIndcs.reserve(32);
 
 		// add dummy
 		if (vecCells.empty())
 			vecCells.emplace_back();
+
+		numSquaresPerRow = numSquaresX;
+		numWordsPerRow = (numSquaresX + 63) / 64;
+		occupiedBits.clear();
+		occupiedBits.resize(numWordsPerRow * numSquaresZ, 0);
 	}
 	void Kill() {
 		// reuse inner vectors when reloading
@@ -117,8 +125,11 @@ public:
 		}
 
 		vecIndcs.clear();
+		std::fill(occupiedBits.begin(), occupiedBits.end(), 0);
 	}
 
+	void PostLoad();
+
 	unsigned int CalcChecksum() const;
 
 	void AddGroundBlockingObject(CSolidObject* object);
@@ -164,6 +175,57 @@ public:
 	}
 
 
+	bool SquareHasObjects(unsigned int mapSquare) const {
+		const unsigned int x = mapSquare % numSquaresPerRow;
+		const unsigned int z = mapSquare / numSquaresPerRow;
+
+		return ((occupiedBits[z * numWordsPerRow + (x >> 6)] >> (x & 63)) & 1);
+	}
+
+	/**
+	 * Calls func(mapSquare) for every square holding at least one object in
+	 * the inclusive range, visiting every xstep'th column (1 or 2) of every
+	 * zstep'th row in row-major order, until func returns true. Empty squares
+	 * are skipped 64 at a time via the occupancy bits, without touching their
+	 * cells. The range must lie inside the map.
+	 * Returns true if func did.
+	 */
+	template<typename F>
+	bool ForEachOccupiedSquare(int xmin, int xmax, int zmin, int zmax, int xstep, int zstep, F&& func) const {
+		return (ForEachSetSquare(occupiedBits.data(), numWordsPerRow, numSquaresPerRow, xmin, xmax, zmin, zmax, xstep, zstep, std::forward<F>(func)));
+	}
+
+	/// ForEachOccupiedSquare on any bitmap with the same layout as occupiedBits
+	template<typename F>
+	static bool ForEachSetSquare(const uint64_t* bits, unsigned int numWordsPerRow, unsigned int numSquaresPerRow, int xmin, int xmax, int zmin, int zmax, int xstep, int zstep, F&& func) {
+		assert(xstep == 1 || xstep == 2);
+		assert(xmin >= 0 && zmin >= 0);
+
+		const uint64_t stepMask = (xstep == 1)? ~uint64_t(0): (uint64_t(0x5555555555555555ull) << (xmin & 1));
+		const int wmin = xmin >> 6;
+		const int wmax = xmax >> 6;
+
+		for (int z = zmin; z <= zmax; z += zstep) {
+			const uint64_t* rowBits = &bits[z * numWordsPerRow];
+
+			for (int w = wmin; w <= wmax; w++) {
+				uint64_t wordBits = rowBits[w] & stepMask;
+
+				if (w == wmin)
+					wordBits &= (~uint64_t(0) << (xmin & 63));
+				if (w == wmax)
+					wordBits &= (~uint64_t(0) >> (63 - (xmax & 63)));
+
+				for (; wordBits != 0; wordBits &= (wordBits - 1)) {
+					if (func(z * numSquaresPerRow + (w << 6) + std::countr_zero(wordBits)))
+						return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
 	BlockingMapCell GetCellUnsafeConst(const float3& pos) const;
 	BlockingMapCell GetCellUnsafeConst(unsigned int mapSquare) const {
 		assert(mapSquare < arrCells.size());
@@ -182,10 +244,26 @@ private:
 	bool CellInsertUnique(unsigned int sqr, CSolidObject* o);
 	bool CellErase(unsigned int sqr, CSolidObject* o);
 
+	void SetSquareHasObjects(unsigned int sqr, bool b) {
+		const unsigned int x = sqr % numSquaresPerRow;
+		const unsigned int z = sqr / numSquaresPerRow;
+		const uint64_t bit = uint64_t(1) << (x & 63);
+
+		uint64_t& word = occupiedBits[z * numWordsPerRow + (x >> 6)];
+		word = b? (word | bit): (word & ~bit);
+	}
+
 private:
 	std::vector<ArrCell> arrCells;
 	std::vector<VecCell> vecCells;
 	std::vector<uint32_t> vecIndcs;
+
+	// one bit per square (rows padded to whole words), set while the square's
+	// cell is non-empty; derived from arrCells, rebuilt after loading
+	std::vector<uint64_t> occupiedBits;
+
+	unsigned int numSquaresPerRow = 1;
+	unsigned int numWordsPerRow = 1;
 };
 
 extern CGroundBlockingObjectMap groundBlockingObjectMap;
@@ -1,6 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include "LosHandler.h"
+#include "LosRaycast.h"
 
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitDef.h"
@@ -576,12 +577,26 @@ void ILosType::Update()
 
 	// raycast terrain
 	if (algoType == LOS_ALGO_RAYCAST)  {
-		for_mt(0, losRecalc.size(), [&](const int idx) {
+		// big instances (e.g. long-range radars) can dominate the parallel
+		// pass below, so those spread their own rays over the pool instead
+		const auto splitBeg = std::stable_partition(losRecalc.begin(), losRecalc.end(), [](const SLosInstance* li) {
+			return !LosRaycast::CanSplitRays(li->radius);
+		});
+		const size_t numUnsplit = splitBeg - losRecalc.begin();
+
+		for_mt(0, numUnsplit, [&](const int idx) {
 			auto li = losRecalc[idx];
 			assert(li->refCount > 0);
 			li->squares.clear();
 			losMaps[li->allyteam].PrepareRaycast(li);
 		});
+
+		for (size_t idx = numUnsplit; idx < losRecalc.size(); ++idx) {
+			auto li = losRecalc[idx];
+			assert(li->refCount > 0);
+			li->squares.clear();
+			losMaps[li->allyteam].PrepareRaycast(li, true);
+		}
 	}
 
 	// add sight
@@ -41,7 +41,8 @@ public:
 	void AddRaycast(SLosInstance* instance, int amount);
 
 	/// arbitrary area, for losMap, non-circular radar maps, ...
-	void PrepareRaycast(SLosInstance* instance) const;
+	/// splitRays spreads the rays of big instances over the thread-pool
+	void PrepareRaycast(SLosInstance* instance, bool splitRays = false) const;
 
 public:
 	int At(int2 p) const {
@@ -54,8 +55,8 @@ public:
 	const unsigned short& front() const { return losmap.front(); }
 	const auto& GetLosMap() const { return losmap; }
 private:
-	void LosAdd(SLosInstance* instance) const;
-	void UnsafeLosAdd(SLosInstance* instance) const;
+	void LosAdd(SLosInstance* instance, bool splitRays) const;
+	void UnsafeLosAdd(SLosInstance* instance, bool splitRays) const;
 	void SafeLosAdd(SLosInstance* instance) const;
 
 	void AddSquaresToInstance(SLosInstance* li, const std::vector<char>& losRaySquares) const;
@@ -0,0 +1,910 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+/* raycasting part of LosMap.cpp */
+
+#include <algorithm>
+#include <array>
+
+#include "LosRaycast.h"
+#include "Sim/Misc/GlobalConstants.h"
+#include "System/SpringMath.h"
+#include "System/Log/ILog.h"
+#include "System/Rectangle.h"
+#include "System/StringUtil.h"
+#include "System/Threading/ThreadPool.h"
+
+#include "xsimd/xsimd.hpp"
+
+constexpr float LOS_BONUS_HEIGHT = 5.0f;
+
+static std::array<std::vector<float>, ThreadPool::MAX_THREADS> RADIUS_ISQRT_TABLES;
+
+static std::array<std::vector<float>, ThreadPool::MAX_THREADS> RAYCAST_ANGLE_TABLES;
+static std::array<std::vector< char>, ThreadPool::MAX_THREADS> LOSRAY_SQUARE_TABLES; // visible squares per instance
+
+
+static float isqrtTableLookup(unsigned r, int threadNum)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(r < RADIUS_ISQRT_TABLES[threadNum].size());
+	return RADIUS_ISQRT_TABLES[threadNum][r];
+}
+
+static void isqrtTableExpand(unsigned r, int threadNum)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	auto& isqrtTable = RADIUS_ISQRT_TABLES[threadNum];
+
+	if (r < isqrtTable.size())
+		return;
+	if (isqrtTable.empty())
+		isqrtTable.reserve((r + 1) * 4);
+
+	for (unsigned i = isqrtTable.size(); i <= r; ++i) {
+		isqrtTable.push_back(math::isqrt(std::max(i, 1u)));
+	}
+}
+
+
+
+// Midpoint circle algorithm
+// func() only get called for the lower top right octant.
+// The others need to get by mirroring.
+template<typename F>
+void MidpointCircleAlgo(int radius, const F& func)
+{
+	int x = radius;
+	int y = 0;
+	int decisionOver2 = 1 - x;
+
+	while (x >= y) {
+		func(x, y);
+
+		y++;
+		if (decisionOver2 <= 0) {
+			decisionOver2 += 2 * y + 1;
+		} else {
+			x--;
+			decisionOver2 += 2 * (y - x) + 1;
+		}
+	}
+}
+
+
+
+
+
+
+
+//////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////
+/// raycast precalculation helper
+
+class CLosTableHelper
+{
+public:
+	typedef std::vector<int2> LosLine;
+	typedef std::vector<LosLine> LosTable;
+
+	// only generates table if not in cache
+	void GenerateForLosSize(size_t losSize);
+
+	const int2 GetLosTableRaySquare(size_t losSize, size_t rayIndex, size_t squareIdx) {
+		return losTables[losSize][rayIndex][squareIdx];
+	}
+
+	size_t GetLosTableRaySize(size_t losSize, size_t rayIndex) {
+		return losTables[losSize][rayIndex].size();
+	}
+
+	size_t GetLosTableSize(size_t losSize) {
+		return losTables[losSize].size();
+	}
+
+private:
+	// [0] is the zero-radius table
+	// NOTE:
+	//   do we even need a table for *every* possible radius?
+	//   why not precalculate only the largest and subsample?
+	std::array<LosTable, MAX_UNIT_SENSOR_RADIUS + 1> losTables;
+
+private:
+	static LosLine GetRay(int x, int y);
+	static LosTable GetLosRays(int radius);
+	static std::vector<int2> GetCircleSurface(const int radius);
+	static void AddMissing(LosTable& losRays, const std::vector<int2>& circlePoints, const int radius);
+	static void Debug(const LosTable& losRays, const std::vector<int2>& points, int radius);
+};
+
+static std::array<CLosTableHelper, ThreadPool::MAX_THREADS> losTableHelpers;
+
+
+
+void CLosTableHelper::GenerateForLosSize(size_t losSize)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// guard against insane sight distances
+	assert(losSize < losTables.size());
+
+	if (losSize == 0)
+		return;
+
+	LosTable& table = losTables[losSize];
+
+	if (!table.empty())
+		return;
+
+	table = GetLosRays(losSize);
+}
+
+
+
+/**
+ * @brief Precalcs the rays for LineOfSight raytracing.
+ * In LoS we raytrace all squares in a radius if they are in view
+ * or obstructed by the heightmap. To do so we cast rays with the
+ * given radius to the LoS circle's surface. But cause those rays
+ * have no width, it happens that squares are missed inside of the
+ * circle. So these squares get their own rays with length < radius.
+ *
+ * Note: We only return the rays for the upper right sector, the
+ * others can be constructed by mirroring.
+ */
+CLosTableHelper::LosTable CLosTableHelper::GetLosRays(const int radius)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	std::vector<int2> circlePoints = GetCircleSurface(radius);
+
+	LosTable losRays;
+	losRays.reserve(2 * circlePoints.size()); // twice cause of AddMissing()
+
+	for (const int2& p: circlePoints) {
+		losRays.emplace_back(GetRay(p.x, p.y));
+	}
+
+	AddMissing(losRays, circlePoints, radius);
+
+	//if (radius == 30)
+	//	Debug(losRays, circlePoints, radius);
+	losRays.shrink_to_fit();
+	return losRays;
+}
+
+
+/**
+ * @brief returns the surface coords of a 2d circle.
+ * Note, we only return the upper right part, the other 3 are generated via mirroring.
+ */
+std::vector<int2> CLosTableHelper::GetCircleSurface(const int radius)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// Midpoint circle algorithm
+	// returns the surface points of a circle (without duplicates)
+	std::vector<int2> circlePoints;
+	circlePoints.reserve(2 * radius);
+
+	MidpointCircleAlgo(radius, [&](int x, int y) {
+		// the upper 1/8th
+		circlePoints.emplace_back(x, y);
+
+		// the lower 1/8th, not added when:
+		// first check prevents 45deg duplicates
+		// second makes sure that only (0,radius) or (radius, 0) is generated (the other one is generated by mirroring later)
+		if (y != x && y != 0)
+			circlePoints.emplace_back(y, x);
+	});
+
+	assert(circlePoints.size() <= 2 * radius);
+	return circlePoints;
+}
+
+
+/**
+ * @brief Makes sure all squares in the radius are checked & adds rays to missing ones.
+ */
+void CLosTableHelper::AddMissing(LosTable& losRays, const std::vector<int2>& circlePoints, const int radius)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	std::vector<char> image((radius + 1) * (radius + 1), 0);
+
+	const auto setpixel = [&](const int2 p) { image[p.y * (radius + 1) + p.x] = true; };
+	const auto getpixel = [&](const int2 p) { return image[p.y * (radius + 1) + p.x]; };
+
+	for (auto& line: losRays) {
+		for (int2& p: line) {
+			setpixel(p);
+		}
+	}
+
+	// start the check from 45deg bisector and go from there to 0deg & 90deg
+	// advantage is we only need to iterate once this time
+	// note: we iterate the list in reverse!
+	for (auto it = circlePoints.rbegin(); it != circlePoints.rend(); ++it) {
+		const int2& p = *it;
+
+		for (int a = p.x; a >= 1 && a >= p.y; --a) {
+			const int2 t1(a, p.y);
+			const int2 t2(p.y, a);
+
+			if (!getpixel(t1)) {
+				losRays.emplace_back(GetRay(t1.x, t1.y));
+
+				for (int2& p_: losRays.back()) {
+					setpixel(p_);
+				}
+			}
+			// (0, radius) is a mirror of (radius, 0) so don't add it
+			if (!getpixel(t2) && t2 != int2(0, radius)) {
+				losRays.emplace_back(GetRay(t2.x, t2.y));
+
+				for (int2& p_: losRays.back()) {
+					setpixel(p_);
+				}
+			}
+		}
+	}
+}
+
+
+/**
+ * @brief returns line coords of a ray with zero width to the coords (xf,yf)
+ */
+CLosTableHelper::LosLine CLosTableHelper::GetRay(int xf, int yf)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(xf >= 0);
+	assert(yf >= 0);
+
+	LosLine losline;
+	if (xf > yf) {
+		// horizontal line
+		const float m = (float) yf / (float) xf;
+		losline.reserve(xf);
+		for (int x = 1; x <= xf; x++) {
+			losline.emplace_back(x, Round(m*x));
+		}
+	} else {
+		// vertical line
+		const float m = (float) xf / (float) yf;
+		losline.reserve(yf);
+		for (int y = 1; y <= yf; y++) {
+			losline.emplace_back(Round(m*y), y);
+		}
+	}
+
+	assert(losline.back() == int2(xf,yf));
+	assert(!losline.empty());
+	return losline;
+}
+
+
+void CLosTableHelper::Debug(const LosTable& losRays, const std::vector<int2>& points, int radius)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// only one should be included (the other one is generated via mirroring)
+	assert(losRays.front().back() == int2(radius, 0));
+	assert(losRays.back().back() != int2(0, radius));
+
+	// check for duplicated/included rays
+	auto losRaysCopy = losRays;
+	for (const auto& ray1: losRaysCopy) {
+		if (ray1.empty())
+			continue;
+
+		for (auto& ray2: losRaysCopy) {
+			if (ray2.empty())
+				continue;
+
+			if (&ray1 == &ray2)
+				continue;
+
+			// check if ray2 is part of ray1
+			if (std::includes(ray1.begin(), ray1.end(), ray2.begin(), ray2.end())) {
+				// prepare for deletion
+				ray2.clear();
+			}
+		}
+	}
+	auto jt = std::remove_if(losRaysCopy.begin(), losRaysCopy.end(), [](LosLine& ray) { return ray.empty(); });
+	assert(jt == losRaysCopy.end());
+
+	// print the rays stats
+	LOG("------------------------------------");
+
+	// draw the sphere image
+	LOG("- sketch -");
+	std::vector<char> image((2*radius+1) * (2*radius+1), 0);
+	auto setpixel = [&](int2 p, char value = 1) {
+		image[p.y * (2*radius+1) + p.x] = value;
+	};
+	int2 midp = int2(radius, radius);
+	for (auto& line: losRays) {
+		for (int2 p: line) {
+			setpixel(midp + p, 127);
+			setpixel(midp - p, 127);
+			setpixel(midp + int2(p.y, -p.x), 127);
+			setpixel(midp + int2(-p.y, p.x), 127);
+		}
+	}
+	for (int2 p: points) {
+		setpixel(midp + p, 1);
+		setpixel(midp - p, 2);
+		setpixel(midp + int2(p.y, -p.x), 4);
+		setpixel(midp + int2(-p.y, p.x), 8);
+	}
+	for (int y = 0; y <= 2*radius; y++) {
+		std::string l;
+		for (int x = 0; x <= 2*radius; x++) {
+			if (image[y*(2*radius+1) + x] == 127) {
+				l += ".";
+			} else {
+				l += IntToString(image[y*(2*radius+1) + x]);
+			}
+		}
+		LOG("%s", l.c_str());
+	}
+
+	// points on the sphere surface
+	LOG("- surface points -");
+	std::string s;
+	for (int2 p: points) {
+		s += "(" + IntToString(p.x) + "," + IntToString(p.y) + ") ";
+	}
+	LOG("%s", s.c_str());
+
+	// rays to those points
+	LOG("- los rays -");
+	for (auto& line: losRays) {
+		std::string s;
+		for (int2 p: line) {
+			s += "(" + IntToString(p.x) + "," + IntToString(p.y) + ") ";
+		}
+		LOG("%s", s.c_str());
+	}
+	LOG_L(L_DEBUG, "------------------------------------");
+}
+
+
+
+
+
+
+
+
+
+
+//////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////
+/// raycasting
+
+#define MAP_SQUARE(pos) ((pos).y * size.x + (pos).x)
+
+// sources at least this big (in LOS-map squares) are split over the pool
+static constexpr int SPLIT_RAYS_MIN_RADIUS = 48;
+// and each chunk gets at least this many rays
+static constexpr int SPLIT_RAYS_MIN_CHUNK = 64;
+
+
+
+inline static constexpr size_t ToAngleMapIdx(const int2 p, const int radius)
+{
+	// [-radius, +radius]^2 -> [0, +2*radius]^2 -> idx
+	return (p.y + radius) * (2 * radius + 1) + (p.x + radius);
+}
+
+
+inline void CastLos(
+	float* prvAngle,
+	float* maxAngle,
+	const int2& off,
+	std::vector<char>& losRaySquares,
+	const std::vector<float>& raycastAngles,
+	int losRadius,
+	int threadNum
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	const size_t oidx = ToAngleMapIdx(off, losRadius);
+
+	// angle to square is smaller than current max-angle, so not visible
+	if (raycastAngles[oidx] < *maxAngle) {
+		losRaySquares[oidx] = false;
+		return;
+	}
+
+	if (raycastAngles[oidx] < *prvAngle) {
+		const float invR = isqrtTableLookup(off.x * off.x + off.y * off.y, threadNum);
+		const float angle = *prvAngle - LOS_BONUS_HEIGHT * invR;
+
+		if (raycastAngles[oidx] < (*maxAngle = angle)) {
+			losRaySquares[oidx] = false;
+			return;
+		}
+	}
+
+	*prvAngle = raycastAngles[oidx];
+}
+
+
+/**
+ * Casts rays [rayBeg, rayEnd) of the table for <radius> along with their
+ * three mirrors, calling hideSquare(oidx) for each square they can not see.
+ * Only reads the shared tables, so disjoint ray ranges can run concurrently.
+ */
+template<typename HideFunc>
+static void CastRayRangeScalar(
+	CLosTableHelper& helper,
+	const std::vector<float>& raycastAngles,
+	size_t rayBeg,
+	size_t rayEnd,
+	int radius,
+	int threadNum,
+	HideFunc&& hideSquare
+) {
+	const auto CastLosLane = [&](float* prvAngle, float* maxAngle, const int2 off) {
+		const size_t oidx = ToAngleMapIdx(off, radius);
+		const float rayAngle = raycastAngles[oidx];
+
+		if (rayAngle < *maxAngle) {
+			hideSquare(oidx);
+			return;
+		}
+
+		if (rayAngle < *prvAngle) {
+			const float invR = isqrtTableLookup(off.x * off.x + off.y * off.y, threadNum);
+			const float angle = *prvAngle - LOS_BONUS_HEIGHT * invR;
+
+			if (rayAngle < (*maxAngle = angle)) {
+				hideSquare(oidx);
+				return;
+			}
+		}
+
+		*prvAngle = rayAngle;
+	};
+
+	for (size_t i = rayBeg; i < rayEnd; ++i) {
+		float maxAngles[4] = {-1e7, -1e7, -1e7, -1e7};
+		float prvAngles[4] = {-1e7, -1e7, -1e7, -1e7};
+
+		const size_t numSquares = helper.GetLosTableRaySize(radius, i);
+
+		for (size_t n = 0; n < numSquares; n++) {
+			const int2 square = helper.GetLosTableRaySquare(radius, i, n);
+
+			CastLosLane(&prvAngles[0], &maxAngles[0],       square              );
+			CastLosLane(&prvAngles[1], &maxAngles[1],      -square              );
+			CastLosLane(&prvAngles[2], &maxAngles[2], int2( square.y, -square.x));
+			CastLosLane(&prvAngles[3], &maxAngles[3], int2(-square.y,  square.x));
+		}
+	}
+}
+
+
+#if (XSIMD_X86_INSTR_SET >= XSIMD_X86_SSE2_VERSION)
+/**
+ * Vectorized version of the angle precalculation for one line of the
+ * circle, <count> squares starting at offset (offX, offY) from the emit
+ * position. Computes the same (max(0, h) - losHeight + bonus) * invR per
+ * square, but does not skip the emit square itself.
+ */
+static void PrecalcAngleRowSIMD(
+	const float* heights,
+	float* angles,
+	char* squares,
+	int offX,
+	int offY,
+	int count,
+	float losHeight,
+	int threadNum
+) {
+	using FloatBatch = xsimd::simd_type<float>;
+	constexpr int BATCH_SIZE = xsimd::simd_traits<float>::size;
+
+	const FloatBatch zeros(0.0f);
+	const FloatBatch baseHeight(losHeight);
+	const FloatBatch bonusHeight(LOS_BONUS_HEIGHT);
+
+	alignas(64) float invRs[BATCH_SIZE];
+
+	int i = 0;
+
+	for (; (i + BATCH_SIZE) <= count; i += BATCH_SIZE) {
+		for (int j = 0; j < BATCH_SIZE; ++j) {
+			invRs[j] = isqrtTableLookup(Square(offX + i + j) + Square(offY), threadNum);
+		}
+
+		const FloatBatch dh = xsimd::max(zeros, xsimd::load_unaligned(&heights[i])) - baseHeight;
+		const FloatBatch ra = (dh + bonusHeight) * xsimd::load_aligned(&invRs[0]);
+
+		xsimd::store_unaligned(&angles[i], ra);
+	}
+
+	for (; i < count; ++i) {
+		const float invR = isqrtTableLookup(Square(offX + i) + Square(offY), threadNum);
+		const float dh = std::max(0.0f, heights[i]) - losHeight;
+
+		angles[i] = (dh + LOS_BONUS_HEIGHT) * invR;
+	}
+
+	std::fill(squares, squares + count, true);
+}
+
+
+/**
+ * Same as CastRayRangeScalar, but steps the four mirrored rays of a table
+ * entry in lockstep: they visit squares at identical distances, so share
+ * invR, and the branchy prvAngle / maxAngle updates become selects. Uses
+ * the exact same float operations per lane, so the results are identical.
+ */
+template<typename HideFunc>
+static void CastRayRangeSIMD(
+	CLosTableHelper& helper,
+	const std::vector<float>& raycastAngles,
+	size_t rayBeg,
+	size_t rayEnd,
+	int radius,
+	int threadNum,
+	HideFunc&& hideSquare
+) {
+	using LaneBatch = xsimd::batch<float, 4>;
+
+	const LaneBatch bonusHeight(LOS_BONUS_HEIGHT);
+	const LaneBatch ones(1.0f);
+	const LaneBatch zeros(0.0f);
+
+	for (size_t i = rayBeg; i < rayEnd; ++i) {
+		LaneBatch maxAngles(-1e7f);
+		LaneBatch prvAngles(-1e7f);
+
+		const size_t numSquares = helper.GetLosTableRaySize(radius, i);
+
+		for (size_t n = 0; n < numSquares; n++) {
+			const int2 square = helper.GetLosTableRaySquare(radius, i, n);
+
+			const size_t oidx[4] = {
+				ToAngleMapIdx(      square              , radius),
+				ToAngleMapIdx(     -square              , radius),
+				ToAngleMapIdx(int2( square.y, -square.x), radius),
+				ToAngleMapIdx(int2(-square.y,  square.x), radius),
+			};
+
+			alignas(16) const float angles[4] = {
+				raycastAngles[oidx[0]],
+				raycastAngles[oidx[1]],
+				raycastAngles[oidx[2]],
+				raycastAngles[oidx[3]],
+			};
+
+			const LaneBatch rayAngles = xsimd::load_aligned(&angles[0]);
+			const LaneBatch invR(isqrtTableLookup(square.x * square.x + square.y * square.y, threadNum));
+
+			const auto belowMax = (rayAngles < maxAngles);
+			const auto belowPrv = (~belowMax) & (rayAngles < prvAngles);
+
+			maxAngles = xsimd::select(belowPrv, prvAngles - bonusHeight * invR, maxAngles);
+
+			const auto hidden = belowMax | (belowPrv & (rayAngles < maxAngles));
+
+			prvAngles = xsimd::select(hidden, prvAngles, rayAngles);
+
+			if (!xsimd::any(hidden))
+				continue;
+
+			alignas(16) float hiddenMask[4];
+			xsimd::store_aligned(&hiddenMask[0], xsimd::select(hidden, ones, zeros));
+
+			for (size_t j = 0; j < 4; ++j) {
+				if (hiddenMask[j] != 0.0f)
+					hideSquare(oidx[j]);
+			}
+		}
+	}
+}
+#endif
+
+
+template<typename HideFunc>
+static void CastRayRange(
+	LosRaycast::CastMode castMode,
+	CLosTableHelper& helper,
+	const std::vector<float>& raycastAngles,
+	size_t rayBeg,
+	size_t rayEnd,
+	int radius,
+	int threadNum,
+	HideFunc&& hideSquare
+) {
+	#if (XSIMD_X86_INSTR_SET >= XSIMD_X86_SSE2_VERSION)
+	if (castMode == LosRaycast::CAST_MODE_SIMD) {
+		CastRayRangeSIMD(helper, raycastAngles, rayBeg, rayEnd, radius, threadNum, hideSquare);
+		return;
+	}
+	#endif
+
+	CastRayRangeScalar(helper, raycastAngles, rayBeg, rayEnd, radius, threadNum, hideSquare);
+}
+
+
+bool LosRaycast::CanSplitRays(int radius)
+{
+	return (radius >= SPLIT_RAYS_MIN_RADIUS && ThreadPool::GetNumThreads() > 1);
+}
+
+
+const std::vector<char>& LosRaycast::CastUnsafe(
+	const Source& src,
+	const int2 size,
+	const float* mipHeightMap,
+	bool splitRays,
+	CastMode castMode
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	// How does it work?
+	// We spawn rays (those created by CLosTableHelper::GenerateForLosSize), and cast them
+	// on the heightmap. Meaning we compute the angle to the given squares and compare them
+	// with the highest cached one on that ray. When the new angle is higher the square is
+	// visible and gets added to the squares array.
+	//
+	// How does prevAng optimisation work?
+	// We don't really need to save every angle as the maximum, if we're going up a mountain
+	// we can just mark them true and continue until we reach the top.
+	// So now, only hilltops are cached in maxAng, and they're only cached when checking
+	// the square after the hilltop, since otherwise we can't know that the ascent ended.
+	const int threadNum = ThreadPool::GetThreadNum();
+
+	const int2 pos   = src.pos;
+	const int radius = src.radius;
+	const float losHeight = src.height;
+
+	// while waiting on the pool this thread may pick up other raycasts (for_mt
+	// runs nested in ILosType::Update) which would clobber its tables, so a
+	// split cast works on its own buffers and only copies the result back
+	const bool splitCast = splitRays && CanSplitRays(radius);
+
+	CLosTableHelper& helper = losTableHelpers[threadNum];
+
+	std::vector< char> splitRaySquares;
+	std::vector<float> splitRayAngles;
+
+	std::vector< char>& losRaySquares = splitCast? splitRaySquares: LOSRAY_SQUARE_TABLES[threadNum];
+	std::vector<float>& raycastAngles = splitCast? splitRayAngles : RAYCAST_ANGLE_TABLES[threadNum];
+
+	helper.GenerateForLosSize(radius);
+
+	losRaySquares.clear();
+	losRaySquares.resize(Square((2 * radius) + 1), false);
+	raycastAngles.clear();
+	raycastAngles.resize(Square((2 * radius) + 1), -1e8);
+
+
+	isqrtTableExpand((radius + 1) * (radius + 1), threadNum);
+
+	// Optimization: precalculate all angles
+	// 1. Center squares are accessed much more often by more rays than those on the border.
+	// 2. The heightmap is much bigger than the circle, and won't fit into the L2/L3. So
+	//    when we buffer the precalc in a vector just large enough for the processed data,
+	//    we reduce the amount of cache misses.
+	MidpointCircleAlgoPerLine(radius, [&](int width, int y) {
+		const unsigned y_ = pos.y + y;
+		const unsigned sx = pos.x - width;
+		const unsigned ex = pos.x + width + 1;
+
+		const size_t oidx = ToAngleMapIdx(int2(sx - pos.x, y), radius);
+
+		#if (XSIMD_X86_INSTR_SET >= XSIMD_X86_SSE2_VERSION)
+		if (castMode == CAST_MODE_SIMD) {
+			PrecalcAngleRowSIMD(&mipHeightMap[MAP_SQUARE(int2(sx, y_))], &raycastAngles[oidx], &losRaySquares[oidx], sx - pos.x, y, ex - sx, losHeight, threadNum);
+			return;
+		}
+		#endif
+
+		float* raycastAnglesPtr = &raycastAngles[oidx];
+		char* losRaySquaresPtr = &losRaySquares[oidx];
+
+		int idx = MAP_SQUARE(int2(sx, y_));
+
+		for (unsigned x_ = sx; x_ < ex; ++x_) {
+			const int2 off(x_ - pos.x, y);
+
+			if (off == int2(0, 0)) {
+				++idx;
+				++raycastAnglesPtr;
+				++losRaySquaresPtr;
+				continue;
+			}
+
+			const float invR = isqrtTableLookup(off.x*off.x + off.y*off.y, threadNum);
+			const float dh = std::max(0.0f, mipHeightMap[idx++]) - losHeight;
+
+			*(raycastAnglesPtr++) = (dh + LOS_BONUS_HEIGHT) * invR;
+			*(losRaySquaresPtr++) = true;
+		}
+	});
+
+	// the SIMD precalc does not skip the emit square
+	raycastAngles[ToAngleMapIdx(int2(0, 0), radius)] = -1e8;
+
+	// cast the rays
+	losRaySquares[ToAngleMapIdx(int2(0, 0), radius)] = true;
+
+	const size_t numRays = helper.GetLosTableSize(radius);
+	const size_t numChunks = std::min(size_t(ThreadPool::GetNumThreads()), numRays / SPLIT_RAYS_MIN_CHUNK);
+
+	if (!splitCast || numChunks <= 1) {
+		CastRayRange(castMode, helper, raycastAngles, 0, numRays, radius, threadNum, [&](size_t oidx) {
+			losRaySquares[oidx] = false;
+		});
+	} else {
+		std::vector<std::vector<int>> hiddenSquares(numChunks);
+
+		// rays only read the tables prepared above, and a square is visible iff
+		// no ray hides it, so each chunk collects the squares it hides and they
+		// are cleared afterwards; same result as casting serially
+		for_mt(0, numChunks, [&](const int chunkIdx) {
+			const int chunkThreadNum = ThreadPool::GetThreadNum();
+
+			const size_t rayBeg = (numRays * (chunkIdx    )) / numChunks;
+			const size_t rayEnd = (numRays * (chunkIdx + 1)) / numChunks;
+
+			// the caller's isqrt table may be grown by nested casts, use our own
+			isqrtTableExpand((radius + 1) * (radius + 1), chunkThreadNum);
+
+			CastRayRange(castMode, helper, raycastAngles, rayBeg, rayEnd, radius, chunkThreadNum, [&](size_t oidx) {
+				hiddenSquares[chunkIdx].push_back(oidx);
+			});
+		});
+
+		for (const std::vector<int>& chunkSquares: hiddenSquares) {
+			for (const int oidx: chunkSquares) {
+				losRaySquares[oidx] = false;
+			}
+		}
+	}
+
+	if (splitCast) {
+		LOSRAY_SQUARE_TABLES[threadNum] = std::move(losRaySquares);
+		return LOSRAY_SQUARE_TABLES[threadNum];
+	}
+
+	return losRaySquares;
+}
+
+
+const std::vector<char>& LosRaycast::CastSafe(const Source& src, const int2 size, const float* mipHeightMap)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// see above
+	const int threadNum = ThreadPool::GetThreadNum();
+
+	const int2 pos   = src.pos;
+	const int radius = src.radius;
+	const float losHeight = src.height;
+
+
+	CLosTableHelper& helper = losTableHelpers[threadNum];
+
+	std::vector< char>& losRaySquares = LOSRAY_SQUARE_TABLES[threadNum];
+	std::vector<float>& raycastAngles = RAYCAST_ANGLE_TABLES[threadNum];
+
+	helper.GenerateForLosSize(radius);
+
+	losRaySquares.clear();
+	losRaySquares.resize(Square((2 * radius) + 1), false);
+	raycastAngles.clear();
+	raycastAngles.resize(Square((2 * radius) + 1), -1e8);
+
+
+	const SRectangle safeRect(0, 0, size.x, size.y);
+
+	isqrtTableExpand((radius + 1) * (radius + 1), threadNum);
+
+	// Optimization: precalc all angles
+	MidpointCircleAlgoPerLine(radius, [&](int width, int y) {
+		const unsigned y_ = pos.y + y;
+
+		if (y_ < size.y) {
+			const unsigned sx = std::clamp(pos.x - width,     0, size.x);
+			const unsigned ex = std::clamp(pos.x + width + 1, 0, size.x);
+			if (sx == ex)
+				return;
+
+			const size_t oidx = ToAngleMapIdx(int2(sx - pos.x, y), radius);
+
+			float* raycastAnglesPtr = &raycastAngles[oidx];
+			char* losRaySquaresPtr = &losRaySquares[oidx];
+
+			int idx = MAP_SQUARE(int2(sx, y_));
+
+			for (unsigned x_ = sx; x_ < ex; ++x_) {
+				const int2 off(x_ - pos.x, y);
+
+				if (off == int2(0, 0)) {
+					++idx;
+					++raycastAnglesPtr;
+					++losRaySquaresPtr;
+					continue;
+				}
+
+				const float invR = isqrtTableLookup(off.x*off.x + off.y*off.y, threadNum);
+				const float dh = std::max(0.0f, mipHeightMap[idx++]) - losHeight;
+
+				*(raycastAnglesPtr++) = (dh + LOS_BONUS_HEIGHT) * invR;
+				*(losRaySquaresPtr++) = true;
+			}
+		}
+	});
+
+
+	// Cast the Rays
+	const size_t numRays = helper.GetLosTableSize(radius);
+
+	if (safeRect.Inside(pos)) {
+		losRaySquares[ToAngleMapIdx(int2(0, 0), radius)] = true;
+
+		for (size_t i = 0; i < numRays; ++i) {
+			float maxAngles[4] = {-1e7, -1e7, -1e7, -1e7};
+			float prvAngles[4] = {-1e7, -1e7, -1e7, -1e7};
+
+			const size_t numSquares = helper.GetLosTableRaySize(radius, i);
+
+			for (size_t n = 0; n < numSquares; n++) {
+				const int2 square = helper.GetLosTableRaySquare(radius, i, n);
+
+				if (!safeRect.Inside(pos + square))
+					break;
+
+				CastLos(&prvAngles[0], &maxAngles[0],  square,                   losRaySquares, raycastAngles, radius, threadNum);
+			}
+			for (size_t n = 0; n < numSquares; n++) {
+				const int2 square = helper.GetLosTableRaySquare(radius, i, n);
+
+				if (!safeRect.Inside(pos - square))
+					break;
+
+				CastLos(&prvAngles[1], &maxAngles[1], -square,                   losRaySquares, raycastAngles, radius, threadNum);
+			}
+			for (size_t n = 0; n < numSquares; n++) {
+				const int2 square = helper.GetLosTableRaySquare(radius, i, n);
+
+				if (!safeRect.Inside(pos + int2(square.y, -square.x)))
+					break;
+
+				CastLos(&prvAngles[2], &maxAngles[2], int2(square.y, -square.x), losRaySquares, raycastAngles, radius, threadNum);
+			}
+			for (size_t n = 0; n < numSquares; n++) {
+				const int2 square = helper.GetLosTableRaySquare(radius, i, n);
+
+				if (!safeRect.Inside(pos + int2(-square.y, square.x)))
+					break;
+
+				CastLos(&prvAngles[3], &maxAngles[3], int2(-square.y, square.x), losRaySquares, raycastAngles, radius, threadNum);
+			}
+		}
+	} else {
+		// emit position outside the map
+		for (size_t i = 0; i < numRays; ++i) {
+			float maxAngles[4] = {-1e7, -1e7, -1e7, -1e7};
+			float prvAngles[4] = {-1e7, -1e7, -1e7, -1e7};
+
+			const size_t numSquares = helper.GetLosTableRaySize(radius, i);
+
+			for (size_t n = 0; n < numSquares; n++) {
+				const int2 square = helper.GetLosTableRaySquare(radius, i, n);
+
+				if (safeRect.Inside(pos + square))
+					CastLos(&prvAngles[0], &maxAngles[0],  square,                   losRaySquares, raycastAngles, radius, threadNum);
+
+				if (safeRect.Inside(pos - square))
+					CastLos(&prvAngles[1], &maxAngles[1], -square,                   losRaySquares, raycastAngles, radius, threadNum);
+
+				if (safeRect.Inside(pos + int2(square.y, -square.x)))
+					CastLos(&prvAngles[2], &maxAngles[2], int2(square.y, -square.x), losRaySquares, raycastAngles, radius, threadNum);
+
+				if (safeRect.Inside(pos + int2(-square.y, square.x)))
+					CastLos(&prvAngles[3], &maxAngles[3], int2(-square.y, square.x), losRaySquares, raycastAngles, radius, threadNum);
+			}
+		}
+	}
+
+	return losRaySquares;
+}
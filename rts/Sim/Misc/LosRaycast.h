@@ -0,0 +1,82 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LOS_RAYCAST_H
+#define LOS_RAYCAST_H
+
+#include <vector>
+
+#include "System/type2.h"
+#include "System/Misc/TracyDefs.h"
+
+
+// Calls func(half_line_width, y) for each line of the filled circle.
+template<typename F>
+void MidpointCircleAlgoPerLine(int radius, const F& func)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	int x = radius;
+	int y = 0;
+	int decisionOver2 = 1 - x;
+
+	while (x >= y) {
+		func(x, y);
+
+		if (y != 0)
+			func(x, -y);
+
+		if (decisionOver2 <= 0) {
+			y++;
+			decisionOver2 += 2 * y + 1;
+		} else {
+			if (x != y) {
+				func(y, x);
+
+				if (x != 0)
+					func(y, -x);
+			}
+
+			y++;
+			x--;
+			decisionOver2 += 2 * (y - x) + 1;
+		}
+	}
+}
+
+
+/**
+ * Terrain raycasting for the LOS_ALGO_RAYCAST LOS types, independent of
+ * CLosMap so it can be benchmarked without a running game.
+ *
+ * Both Cast* functions return the calling thread's buffer of
+ * (2 * radius + 1)^2 flags, row-major around the source position, which
+ * are set for every visible square; the buffer is overwritten by the next
+ * call on the same thread.
+ */
+namespace LosRaycast {
+	struct Source {
+		int2 pos;
+		int radius;
+		float height;
+	};
+
+	enum CastMode {
+		CAST_MODE_SCALAR, ///< one ray at a time
+		CAST_MODE_SIMD,   ///< the four mirrored rays of each table entry in one batch
+	};
+
+	/// whether CastUnsafe should spread the rays of a source this big over the thread-pool
+	bool CanSplitRays(int radius);
+
+	/// requires the circle around src to lie entirely within the map
+	const std::vector<char>& CastUnsafe(
+		const Source& src,
+		const int2 mapSize,
+		const float* mipHeightMap,
+		bool splitRays,
+		CastMode castMode = CAST_MODE_SIMD
+	);
+
+	const std::vector<char>& CastSafe(const Source& src, const int2 mapSize, const float* mipHeightMap);
+}
+
+#endif // LOS_RAYCAST_H
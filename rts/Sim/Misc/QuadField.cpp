@@ -33,7 +33,9 @@ CR_REG_METADATA(CQuadField, (
 	CR_IGNORED(tempFeatures),
 	CR_IGNORED(tempProjectiles),
 	CR_IGNORED(tempSolids),
-	CR_IGNORED(tempQuads)
+	CR_IGNORED(tempQuads),
+	CR_IGNORED(tempIndices),
+	CR_IGNORED(unitsVersion)
 ))
 
 CR_BIND(CQuadField::Quad, )
@@ -43,6 +45,7 @@ CR_REG_METADATA_SUB(CQuadField, Quad, (
 	CR_MEMBER(features),
 	CR_MEMBER(projectiles),
 	CR_MEMBER(repulsers),
+	CR_IGNORED(featuresSoA),
 
 	CR_POSTLOAD(PostLoad)
 ))
@@ -60,6 +63,12 @@ void CQuadField::Quad::PostLoad()
 	for (CUnit* unit: units) {
 		spring::VectorInsertUnique(teamUnits[unit->allyteam], unit, false);
 	}
+
+	featuresSoA.Clear();
+
+	for (const CFeature* feature: features) {
+		featuresSoA.PushBack(feature->pos.x, feature->pos.z, feature->radius);
+	}
 #endif
 }
 
@@ -82,8 +91,9 @@ void CQuadField::Init(int2 mapDims, int quadSize)
 
 	size_t threadCount = ThreadPool::GetNumThreads();
 
+	// covers the usual nesting depth; the caches grow on demand beyond that
 	for (size_t i = 0; i < threadCount; ++i) {
-		tempQuads[i].ReserveAll(numQuadsX * numQuadsZ);
+		tempQuads[i].ReserveAll(3, numQuadsX * numQuadsZ);
 		tempQuads[i].ReleaseAll();
 	}
 
@@ -104,18 +114,19 @@ void CQuadField::Kill()
 		quad.Clear();
 	}
 
-	for (auto cache : tempUnits)
+	for (auto& cache: tempUnits)
 		cache.ReleaseAll();
 
-	for (auto cache : tempFeatures)
+	for (auto& cache: tempFeatures)
 		cache.ReleaseAll();
 
-	tempProjectiles.ReleaseAll();
+	for (auto& cache: tempProjectiles)
+		cache.ReleaseAll();
 
-	for (auto cache : tempSolids)
+	for (auto& cache: tempSolids)
 		cache.ReleaseAll();
 
-	for (auto cache : tempQuads)
+	for (auto& cache: tempQuads)
 		cache.ReleaseAll();
 }
 
@@ -393,6 +404,7 @@ bool CQuadField::InsertUnitIf(CUnit* unit, const float3& wpos)
 
 	spring::VectorInsertUnique(baseQuads[wposQuadIdx].units, unit, false);
 	spring::VectorInsertUnique(baseQuads[wposQuadIdx].teamUnits[unit->allyteam], unit, false);
+	unitsVersion++;
 	return true;
 }
 
@@ -424,6 +436,7 @@ bool CQuadField::RemoveUnitIf(CUnit* unit, const float3& wpos)
 
 	spring::VectorErase(baseQuads[wposQuadIdx].units, unit);
 	spring::VectorErase(baseQuads[wposQuadIdx].teamUnits[unit->allyteam], unit);
+	unitsVersion++;
 	return true;
 }
 #endif
@@ -454,6 +467,7 @@ void CQuadField::MovedUnit(CUnit* unit)
 	}
 
 	unit->quads = std::move(*qfQuery.quads);
+	unitsVersion++;
 }
 
 void CQuadField::RemoveUnit(CUnit* unit)
@@ -465,6 +479,7 @@ void CQuadField::RemoveUnit(CUnit* unit)
 	}
 
 	unit->quads.clear();
+	unitsVersion++;
 
 	#ifdef DEBUG_QUADFIELD
 	for (const Quad& q: baseQuads) {
@@ -529,7 +544,10 @@ void CQuadField::AddFeature(CFeature* feature)
 	GetQuads(qfQuery, feature->pos, feature->radius);
 
 	for (const int qi: *qfQuery.quads) {
-		spring::VectorInsertUnique(baseQuads[qi].features, feature, false);
+		Quad& quad = baseQuads[qi];
+
+		spring::VectorInsertUnique(quad.features, feature, false);
+		quad.featuresSoA.PushBack(feature->pos.x, feature->pos.z, feature->radius);
 	}
 }
 
@@ -540,7 +558,18 @@ void CQuadField::RemoveFeature(CFeature* feature)
 	GetQuads(qfQuery, feature->pos, feature->radius);
 
 	for (const int qi: *qfQuery.quads) {
-		spring::VectorErase(baseQuads[qi].features, feature);
+		Quad& quad = baseQuads[qi];
+
+		// same swap-and-pop as spring::VectorErase, mirrored into the SoA
+		const auto iter = std::find(quad.features.begin(), quad.features.end(), feature);
+
+		if (iter == quad.features.end())
+			continue;
+
+		quad.featuresSoA.EraseAt(iter - quad.features.begin());
+
+		*iter = quad.features.back();
+		quad.features.pop_back();
 	}
 
 	#ifdef DEBUG_QUADFIELD
@@ -706,20 +735,23 @@ void CQuadField::GetFeaturesExact(QuadFieldQuery& qfq, const float3& pos, float
 	const int tempNum = gs->GetMtTempNum(curThread);
 	qfq.features = tempFeatures[curThread].ReserveVector();
 
+	auto& candidates = tempIndices[curThread];
+
 	for (const int qi: *qfQuery.quads) {
-		for (CFeature* f: baseQuads[qi].features) {
+		const Quad& quad = baseQuads[qi];
+
+		// exact for cylinders, a conservative pre-filter for spheres
+		quad.featuresSoA.Overlapping2D(pos.x, pos.z, radius, candidates);
+
+		for (const uint32_t ci: candidates) {
+			CFeature* f = quad.features[ci];
+
 			if (f->mtTempNum[curThread] == tempNum)
 				continue;
 
 			f->mtTempNum[curThread] = tempNum;
 
-			const float totRad       = radius + f->radius;
-			const float totRadSq     = totRad * totRad;
-			const float posDstSq = spherical?
-				pos.SqDistance(f->pos):
-				pos.SqDistance2D(f->pos);
-
-			if (posDstSq >= totRadSq)
+			if (spherical && pos.SqDistance(f->pos) >= Square(radius + f->radius))
 				continue;
 
 			qfq.features->push_back(f);
@@ -764,17 +796,19 @@ void CQuadField::GetFeaturesExact(QuadFieldQuery& qfq, const float3& mins, const
 void CQuadField::GetProjectilesExact(QuadFieldQuery& qfq, const float3& pos, float radius)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	auto curThread = qfq.threadOwner;
 	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = curThread;
 	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetTempNum();
-	qfq.projectiles = tempProjectiles.ReserveVector();
+	const int tempNum = gs->GetMtTempNum(curThread);
+	qfq.projectiles = tempProjectiles[curThread].ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CProjectile* p: baseQuads[qi].projectiles) {
-			if (p->tempNum == tempNum)
+			if (p->mtTempNum[curThread] == tempNum)
 				continue;
 
-			p->tempNum = tempNum;
+			p->mtTempNum[curThread] = tempNum;
 
 			if (pos.SqDistance(p->pos) >= Square(radius + p->radius))
 				continue;
@@ -789,17 +823,19 @@ void CQuadField::GetProjectilesExact(QuadFieldQuery& qfq, const float3& pos, flo
 void CQuadField::GetProjectilesExact(QuadFieldQuery& qfq, const float3& mins, const float3& maxs)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	auto curThread = qfq.threadOwner;
 	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = curThread;
 	GetQuadsRectangle(qfQuery, mins, maxs);
-	const int tempNum = gs->GetTempNum();
-	qfq.projectiles = tempProjectiles.ReserveVector();
+	const int tempNum = gs->GetMtTempNum(curThread);
+	qfq.projectiles = tempProjectiles[curThread].ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CProjectile* p: baseQuads[qi].projectiles) {
-			if (p->tempNum == tempNum)
+			if (p->mtTempNum[curThread] == tempNum)
 				continue;
 
-			p->tempNum = tempNum;
+			p->mtTempNum[curThread] = tempNum;
 
 			const float3& pos = p->pos;
 			if (pos.x < mins.x || pos.x > maxs.x)
@@ -830,7 +866,8 @@ void CQuadField::GetSolidsExact(
 	GetQuads(qfQuery, pos, radius);
 	const int tempNum = gs->GetMtTempNum(curThread);
 	qfq.solids = tempSolids[curThread].ReserveVector();
-	
+
+	auto& candidates = tempIndices[curThread];
 
 	for (const int qi: *qfQuery.quads) {
 		for (CUnit* u: baseQuads[qi].units) {
@@ -849,7 +886,13 @@ void CQuadField::GetSolidsExact(
 			qfq.solids->push_back(u);
 		}
 
-		for (CFeature* f: baseQuads[qi].features) {
+		const Quad& quad = baseQuads[qi];
+
+		quad.featuresSoA.Overlapping2D(pos.x, pos.z, radius, candidates);
+
+		for (const uint32_t ci: candidates) {
+			CFeature* f = quad.features[ci];
+
 			if (f->mtTempNum[curThread] == tempNum)
 				continue;
 
@@ -879,14 +922,17 @@ bool CQuadField::NoSolidsExact(
 	RECOIL_DETAILED_TRACY_ZONE;
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetTempNum();
+	const int curThread = qfQuery.threadOwner;
+	const int tempNum = gs->GetMtTempNum(curThread);
+
+	auto& candidates = tempIndices[curThread];
 
 	for (const int qi: *qfQuery.quads) {
 		for (CUnit* u: baseQuads[qi].units) {
-			if (u->tempNum == tempNum)
+			if (u->mtTempNum[curThread] == tempNum)
 				continue;
 
-			u->tempNum = tempNum;
+			u->mtTempNum[curThread] = tempNum;
 
 			if (!u->HasPhysicalStateBit(physicalStateBits))
 				continue;
@@ -898,11 +944,17 @@ bool CQuadField::NoSolidsExact(
 			return false;
 		}
 
-		for (CFeature* f: baseQuads[qi].features) {
-			if (f->tempNum == tempNum)
+		const Quad& quad = baseQuads[qi];
+
+		quad.featuresSoA.Overlapping2D(pos.x, pos.z, radius, candidates);
+
+		for (const uint32_t ci: candidates) {
+			CFeature* f = quad.features[ci];
+
+			if (f->mtTempNum[curThread] == tempNum)
 				continue;
 
-			f->tempNum = tempNum;
+			f->mtTempNum[curThread] = tempNum;
 
 			if (!f->HasPhysicalStateBit(physicalStateBits))
 				continue;
@@ -928,21 +980,21 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 	std::vector<CPlasmaRepulser*>* repulsers
 ) {
 	RECOIL_DETAILED_TRACY_ZONE;
-	const int tempNum = gs->GetTempNum();
-
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
-	// start counting from the previous object-cache sizes
+
+	const int curThread = qfQuery.threadOwner;
+	const int tempNum = gs->GetMtTempNum(curThread);
 
 	for (const int qi: *qfQuery.quads) {
 		const Quad& quad = baseQuads[qi];
 
 		for (CUnit* u: quad.units) {
 			// prevent double adding
-			if (u->tempNum == tempNum)
+			if (u->mtTempNum[curThread] == tempNum)
 				continue;
 
-			u->tempNum = tempNum;
+			u->mtTempNum[curThread] = tempNum;
 
 			const auto* colvol = &u->collisionVolume;
 			const float totRad = radius + colvol->GetBoundingRadius();
@@ -955,10 +1007,10 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 
 		for (CFeature* f: quad.features) {
 			// prevent double adding
-			if (f->tempNum == tempNum)
+			if (f->mtTempNum[curThread] == tempNum)
 				continue;
 
-			f->tempNum = tempNum;
+			f->mtTempNum[curThread] = tempNum;
 
 			const auto* colvol = &f->collisionVolume;
 			const float totRad = radius + colvol->GetBoundingRadius();
@@ -971,10 +1023,10 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 		if (repulsers != nullptr) {
 			for (CPlasmaRepulser* r: quad.repulsers) {
 				// prevent double adding
-				if (r->tempNum == tempNum)
+				if (r->mtTempNum[curThread] == tempNum)
 					continue;
 
-				r->tempNum = tempNum;
+				r->mtTempNum[curThread] = tempNum;
 
 				const auto* colvol = &r->collisionVolume;
 				const float totRad = radius + colvol->GetBoundingRadius();
@@ -5,8 +5,10 @@
 
 #include <algorithm>
 #include <array>
+#include <deque>
 #include <vector>
 
+#include "Sim/Misc/QuadFieldSoA.h"
 #include "System/Misc/NonCopyable.h"
 #include "System/Threading/ThreadPool.h"
 #include "System/creg/creg_cond.h"
@@ -20,56 +22,62 @@ class CSolidObject;
 class CPlasmaRepulser;
 struct QuadFieldQuery;
 
+/**
+ * Pool of scratch vectors handed out by the CQuadField queries, one pool per
+ * thread. The pool grows on demand, so queries can be nested to any depth,
+ * and vectors are never freed while the pool lives, so handed-out pointers
+ * stay valid. A pool must only be touched by the thread that owns it, which
+ * makes the queries safe to run from any ThreadPool worker without locks.
+ */
 template<typename T>
 class QueryVectorCache {
 public:
-	typedef std::pair<bool, std::vector<T>> PairType;
-
-	std::vector<T>* ReserveVector(size_t base = 0, size_t capa = 1024) {
-		const auto pred = [](const PairType& p) { return (!p.first); };
-		const auto iter = std::find_if(vectors.begin() + base, vectors.end(), pred);
-
-		if (iter != vectors.end()) {
-			iter->first = true;
-			iter->second.clear();
-			iter->second.reserve(capa);
-			return &iter->second;
+	std::vector<T>* ReserveVector(size_t capa = 1024) {
+		std::vector<T>* vec = nullptr;
+
+		if (freeVectors.empty()) {
+			vec = &vectors.emplace_back();
+		} else {
+			vec = freeVectors.back();
+			freeVectors.pop_back();
 		}
 
-		assert(false);
-		return nullptr;
+		vec->clear();
+		vec->reserve(capa);
+		return vec;
 	}
 
-	void ReserveAll(size_t capa) {
-		for (size_t i = 0; i < vectors.size(); ++i) {
-			ReserveVector(i, capa);
+	void ReserveAll(size_t count, size_t capa) {
+		while (vectors.size() < count) {
+			vectors.emplace_back();
+		}
+		for (auto& vec: vectors) {
+			vec.reserve(capa);
 		}
 	}
 
-	void ReleaseVector(const std::vector<T>* released) {
+	void ReleaseVector(std::vector<T>* released) {
 		if (released == nullptr)
 			return;
 
-		const auto pred = [&](const PairType& p) { return (&p.second == released); };
-		const auto iter = std::find_if(vectors.begin(), vectors.end(), pred);
-
-		if (iter == vectors.end()) {
-			assert(false);
-			return;
-		}
-
-		iter->first = false;
+		assert(std::find(freeVectors.begin(), freeVectors.end(), released) == freeVectors.end());
+		freeVectors.push_back(released);
 	}
+
 	void ReleaseAll() {
-		for (auto& pair: vectors) {
-			ReleaseVector(&pair.second);
+		freeVectors.clear();
+
+		for (auto& vec: vectors) {
+			freeVectors.push_back(&vec);
 		}
 	}
+
+	size_t NumReserved() const { return (vectors.size() - freeVectors.size()); }
+
 private:
-	// There should at most be 2 concurrent users of each vector type
-	// using 3 to be safe, increase this number if the assertions below
-	// fail
-	std::array<PairType, 3> vectors = {{{false, {}}, {false, {}}, {false, {}}}};
+	// deque; growing it must not move the vectors already handed out
+	std::deque< std::vector<T> > vectors;
+	std::vector< std::vector<T>* > freeVectors;
 };
 
 
@@ -165,7 +173,7 @@ public:
 
 	void ReleaseVector(std::vector<CUnit*>* v       , int onThread = 0) { tempUnits[onThread].ReleaseVector(v); }
 	void ReleaseVector(std::vector<CFeature*>* v    , int onThread = 0) { tempFeatures[onThread].ReleaseVector(v); }
-	void ReleaseVector(std::vector<CProjectile*>* v ) { tempProjectiles.ReleaseVector(v); }
+	void ReleaseVector(std::vector<CProjectile*>* v , int onThread = 0) { tempProjectiles[onThread].ReleaseVector(v); }
 	void ReleaseVector(std::vector<CSolidObject*>* v, int onThread = 0) { tempSolids[onThread].ReleaseVector(v); }
 	void ReleaseVector(std::vector<int>* v          , int onThread = 0) { tempQuads[onThread].ReleaseVector(v); }
 
@@ -182,6 +190,7 @@ public:
 			units = std::move(q.units);
 			teamUnits = std::move(q.teamUnits);
 			features = std::move(q.features);
+			featuresSoA = std::move(q.featuresSoA);
 			projectiles = std::move(q.projectiles);
 			repulsers = std::move(q.repulsers);
 			return *this;
@@ -197,6 +206,7 @@ public:
 				v.clear();
 			}
 			features.clear();
+			featuresSoA.Clear();
 			projectiles.clear();
 			repulsers.clear();
 		}
@@ -207,6 +217,10 @@ public:
 		std::vector<CFeature*> features;
 		std::vector<CProjectile*> projectiles;
 		std::vector<CPlasmaRepulser*> repulsers;
+
+		// index-parallel to <features>; features only change their XZ-position
+		// or radius through RemoveFeature + AddFeature, so this stays exact
+		QuadFieldSoA featuresSoA;
 	};
 
 	const Quad& GetQuad(unsigned i) const {
@@ -219,6 +233,9 @@ public:
 	}
 
 
+	/// changes whenever a unit is added to or removed from any quad
+	unsigned int GetUnitsVersion() const { return unitsVersion; }
+
 	int GetNumQuadsX() const { return numQuadsX; }
 	int GetNumQuadsZ() const { return numQuadsZ; }
 
@@ -237,10 +254,13 @@ private:
 	// preallocated vectors for Get*Exact functions
 	std::array< QueryVectorCache<CUnit*>, ThreadPool::MAX_THREADS >  tempUnits;
 	std::array< QueryVectorCache<CFeature*>, ThreadPool::MAX_THREADS >  tempFeatures;
-	QueryVectorCache<CProjectile*> tempProjectiles;
+	std::array< QueryVectorCache<CProjectile*>, ThreadPool::MAX_THREADS > tempProjectiles;
 	std::array< QueryVectorCache<CSolidObject*>, ThreadPool::MAX_THREADS > tempSolids;
 	std::array< QueryVectorCache<int>, ThreadPool::MAX_THREADS > tempQuads;
 
+	// per-quad candidate indices produced by QuadFieldSoA::Overlapping2D
+	std::array< std::vector<uint32_t>, ThreadPool::MAX_THREADS > tempIndices;
+
 	float2 invQuadSize;
 
 	int numQuadsX;
@@ -248,16 +268,27 @@ private:
 
 	int quadSizeX;
 	int quadSizeZ;
+
+	unsigned int unitsVersion = 0;
 };
 
 extern CQuadField quadField;
 
 
+/**
+ * Owns the result vectors of one CQuadField query and hands them back to the
+ * pools of <threadOwner> on destruction. Defaults to the calling thread, so
+ * queries can be issued from ThreadPool workers (for_mt etc.) as-is.
+ */
 struct QuadFieldQuery {
+	QuadFieldQuery(): threadOwner(ThreadPool::GetThreadNum()) {}
+	QuadFieldQuery(const QuadFieldQuery&) = delete;
+	QuadFieldQuery& operator = (const QuadFieldQuery&) = delete;
+
 	~QuadFieldQuery() {
 		quadField.ReleaseVector(units, threadOwner);
 		quadField.ReleaseVector(features, threadOwner);
-		quadField.ReleaseVector(projectiles);
+		quadField.ReleaseVector(projectiles, threadOwner);
 		quadField.ReleaseVector(solids, threadOwner);
 		quadField.ReleaseVector(quads, threadOwner);
 	}
@@ -267,7 +298,7 @@ struct QuadFieldQuery {
 	std::vector<CProjectile*>* projectiles = nullptr;
 	std::vector<CSolidObject*>* solids = nullptr;
 	std::vector<int>* quads = nullptr;
-	int threadOwner = 0;
+	int threadOwner;
 };
 
 
@@ -0,0 +1,101 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef QUAD_FIELD_SOA_H
+#define QUAD_FIELD_SOA_H
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "xsimd/xsimd.hpp"
+
+/**
+ * Packed mirror of the XZ-positions and radii of the objects stored in one
+ * quad. Entries are kept index-parallel to the quad's object vector, using
+ * the same swap-and-pop erase as spring::VectorErase, so the broad-phase
+ * distance tests of the Get*Exact queries can run over contiguous memory and
+ * only dereference the objects that pass.
+ */
+struct QuadFieldSoA {
+public:
+	using FloatBatch = xsimd::simd_type<float>;
+	static constexpr size_t BATCH_SIZE = xsimd::simd_traits<float>::size;
+
+	void Clear() {
+		xs.clear();
+		zs.clear();
+		rs.clear();
+	}
+
+	void PushBack(float x, float z, float r) {
+		xs.push_back(x);
+		zs.push_back(z);
+		rs.push_back(r);
+	}
+
+	void EraseAt(size_t i) {
+		assert(i < size());
+
+		xs[i] = xs.back(); xs.pop_back();
+		zs[i] = zs.back(); zs.pop_back();
+		rs[i] = rs.back(); rs.pop_back();
+	}
+
+	size_t size() const { return xs.size(); }
+
+	/**
+	 * Fills <indices> (in ascending order) with every entry whose circle
+	 * overlaps the circle of radius <r> around (x, z). The comparison is the
+	 * same as SqDistance2D(...) < Square(r + radius), and since adding the
+	 * non-negative dy*dy term can only increase the rounded sum it is also a
+	 * conservative pre-filter for the spherical SqDistance variant.
+	 */
+	void Overlapping2D(float x, float z, float r, std::vector<uint32_t>& indices) const {
+		indices.clear();
+
+		const size_t n = size();
+		const size_t nb = n - (n % BATCH_SIZE);
+
+		const FloatBatch bx(x);
+		const FloatBatch bz(z);
+		const FloatBatch br(r);
+		const FloatBatch ones(1.0f);
+		const FloatBatch zeros(0.0f);
+
+		for (size_t i = 0; i < nb; i += BATCH_SIZE) {
+			const FloatBatch dx = bx - xsimd::load_unaligned(&xs[i]);
+			const FloatBatch dz = bz - xsimd::load_unaligned(&zs[i]);
+			const FloatBatch tr = br + xsimd::load_unaligned(&rs[i]);
+
+			const auto hits = ((dx * dx + dz * dz) < (tr * tr));
+
+			// most batches in a populated quad are misses
+			if (!xsimd::any(hits))
+				continue;
+
+			alignas(64) float hitMask[BATCH_SIZE];
+			xsimd::store_aligned(&hitMask[0], xsimd::select(hits, ones, zeros));
+
+			for (size_t j = 0; j < BATCH_SIZE; ++j) {
+				if (hitMask[j] != 0.0f)
+					indices.push_back(i + j);
+			}
+		}
+
+		for (size_t i = nb; i < n; ++i) {
+			const float dx = x - xs[i];
+			const float dz = z - zs[i];
+			const float tr = r + rs[i];
+
+			if ((dx * dx + dz * dz) < (tr * tr))
+				indices.push_back(i);
+		}
+	}
+
+private:
+	std::vector<float> xs;
+	std::vector<float> zs;
+	std::vector<float> rs;
+};
+
+#endif /* QUAD_FIELD_SOA_H */
@@ -4,6 +4,7 @@
 #define MOVE_TYPE_COMPONENTS_H__
 
 #include "MoveTypesEvents.h"
+#include "Sim/MoveTypes/Utils/CollisionGrid.h"
 #include "System/Ecs/Components/BaseComponents.h"
 #include <System/Threading/ThreadPool.h>
 
@@ -47,6 +48,24 @@ struct YardmapTrapCheckSystemComponent {
 	std::array<std::vector<CUnit*>, ThreadPool::MAX_THREADS> trappedUnitLists;
 };
 
+// Broad phase of the ground unit collision checks, rebuilt by GroundMoveSystem
+// ahead of the (MT) collision detection phase.
+struct UnitCollisionGridSystemComponent {
+	static constexpr std::size_t page_size = 1;
+
+	CollisionGrid<CUnit> grid;
+	std::array<std::vector<CUnit*>, ThreadPool::MAX_THREADS> collideeLists;
+
+	std::vector<CUnit*>& GetCollidees(const float3& pos, float range, int curThread) {
+		std::vector<CUnit*>& collidees = collideeLists[curThread];
+
+		collidees.clear();
+		grid.ForEachInRange(pos, range, [&collidees](CUnit* unit) { collidees.push_back(unit); });
+
+		return collidees;
+	}
+};
+
 constexpr size_t UNIT_EVENT_VECTOR_RESERVE = 4;
 
 ALIAS_COMPONENT_LIST_RESERVE(FeatureCollisionEvents, std::vector<FeatureCollisionEvent>, UNIT_EVENT_VECTOR_RESERVE);
@@ -2784,12 +2784,11 @@ void CGroundMoveType::HandleUnitCollisions(
 	if ( !colliderMD->overrideUnitWaterline )
 		colliderInfo.DisableHeightChecks();
 
-	// copy on purpose, since the below can call Lua
-	QuadFieldQuery qfQuery;
-	qfQuery.threadOwner = curThread;
-	quadField.GetUnitsExact(qfQuery, collider->pos, searchRadius);
+	// broad phase, same criterion as quadField.GetUnitsExact but on a finer
+	// grid rebuilt by GroundMoveSystem right before the collision detection
+	auto& collisionGrid = Sim::systemGlobals.GetSystemComponent<UnitCollisionGridSystemComponent>();
 
-	for (CUnit* collidee: *qfQuery.units) {
+	for (CUnit* collidee: collisionGrid.GetCollidees(collider->pos, searchRadius, curThread)) {
 		if (collidee == collider) continue;
 		if (collidee->IsSkidding()) continue;
 		if (collidee->IsFlying()) continue;
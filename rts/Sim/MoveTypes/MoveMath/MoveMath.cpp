@@ -9,6 +9,7 @@
 #include "Sim/Misc/GroundBlockingObjectMap.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
 #include "Sim/MoveTypes/MoveType.h"
+#include "Sim/MoveTypes/MoveMath/SpeedModCache.h"
 #include "Sim/Objects/SolidObject.h"
 #include "Sim/Units/Unit.h"
 #include "System/Platform/Threading.h"
@@ -77,13 +78,23 @@ float CMoveMath::yLevel(const MoveDef& moveDef, const float3& pos)
 
 
 
-/* calculate the local speed-modifier for this MoveDef */
+/* get the local speed-modifier for this MoveDef */
 float CMoveMath::GetPosSpeedMod(const MoveDef& moveDef, unsigned xSquare, unsigned zSquare)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	if (xSquare >= mapDims.mapx || zSquare >= mapDims.mapy)
 		return 0.0f;
 
+	if (const float* speedMods = speedModCache.GetSpeedMods(moveDef); speedMods != nullptr)
+		return speedMods[xSquare + (zSquare * mapDims.mapx)];
+
+	return (CalcPosSpeedMod(moveDef, xSquare, zSquare));
+}
+
+/* calculate the local speed-modifier for this MoveDef */
+float CMoveMath::CalcPosSpeedMod(const MoveDef& moveDef, unsigned xSquare, unsigned zSquare)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
 	const int accurateSquare = xSquare + (zSquare * mapDims.mapx);
 	const int square = (xSquare >> 1) + ((zSquare >> 1) * mapDims.hmapx);
 	const int squareTerrType = readMap->GetTypeMapSynced()[square];
@@ -176,32 +187,32 @@ CMoveMath::BlockType CMoveMath::IsBlockedNoSpeedModCheckDiff(const MoveDef& move
 	const int tempNum = gs->GetMtTempNum(thread);
 
 	// footprints are point-symmetric around <xSquare, zSquare>
-	for (int z = zmin; z <= zmax; z += FOOTPRINT_ZSTEP) {
-		const int zOffset = z * mapDims.mapx;
+	groundBlockingObjectMap.ForEachOccupiedSquare(xmin, xmax, zmin, zmax, FOOTPRINT_XSTEP, FOOTPRINT_ZSTEP, [&](unsigned int mapSquare) {
+		const int x = mapSquare % mapDims.mapx;
+		const int z = mapSquare / mapDims.mapx;
 
-		for (int x = xmin; x <= xmax; x += FOOTPRINT_XSTEP) {
-
-			if (		z <= prev_zmax && z >= prev_zmin
-			 		&& 	x <= prev_xmax && x >= prev_xmin)
-				continue;
+		if (		z <= prev_zmax && z >= prev_zmin
+				&& 	x <= prev_xmax && x >= prev_xmin)
+			return false;
 
-			const CGroundBlockingObjectMap::BlockingMapCell& cell = groundBlockingObjectMap.GetCellUnsafeConst(zOffset + x);
+		const CGroundBlockingObjectMap::BlockingMapCell& cell = groundBlockingObjectMap.GetCellUnsafeConst(mapSquare);
 
-			for (size_t i = 0, n = cell.size(); i < n; i++) {
-				CSolidObject* collidee = cell[i];
+		for (size_t i = 0, n = cell.size(); i < n; i++) {
+			CSolidObject* collidee = cell[i];
 
-				if (collidee->mtTempNum[thread] == tempNum)
-					continue;
+			if (collidee->mtTempNum[thread] == tempNum)
+				continue;
 
-				collidee->mtTempNum[thread] = tempNum;
+			collidee->mtTempNum[thread] = tempNum;
 
-				if (((ret |= ObjectBlockType(collidee, &colliderInfo)) & BLOCK_STRUCTURE) == 0)
-					continue;
+			if (((ret |= ObjectBlockType(collidee, &colliderInfo)) & BLOCK_STRUCTURE) == 0)
+				continue;
 
-				return ret;
-			}
+			return true;
 		}
-	}
+
+		return false;
+	});
 
 	return ret;
 }
@@ -383,27 +394,25 @@ CMoveMath::BlockType CMoveMath::RangeIsBlockedSt(int xmin, int xmax, int zmin, i
 	BlockType ret = BLOCK_NONE;
 
 	// footprints are point-symmetric around <xSquare, zSquare>
-	for (int z = zmin; z <= zmax; z += FOOTPRINT_ZSTEP) {
-		const int zOffset = z * mapDims.mapx;
+	groundBlockingObjectMap.ForEachOccupiedSquare(xmin, xmax, zmin, zmax, FOOTPRINT_XSTEP, FOOTPRINT_ZSTEP, [&](unsigned int mapSquare) {
+		const CGroundBlockingObjectMap::BlockingMapCell& cell = groundBlockingObjectMap.GetCellUnsafeConst(mapSquare);
 
-		for (int x = xmin; x <= xmax; x += FOOTPRINT_XSTEP) {
-			const CGroundBlockingObjectMap::BlockingMapCell& cell = groundBlockingObjectMap.GetCellUnsafeConst(zOffset + x);
+		for (size_t i = 0, n = cell.size(); i < n; i++) {
+			CSolidObject* collidee = cell[i];
 
-			for (size_t i = 0, n = cell.size(); i < n; i++) {
-				CSolidObject* collidee = cell[i];
-
-				if (collidee->tempNum == tempNum)
-					continue;
+			if (collidee->tempNum == tempNum)
+				continue;
 
-				collidee->tempNum = tempNum;
+			collidee->tempNum = tempNum;
 
-				if (((ret |= ObjectBlockType(collidee, collider)) & BLOCK_STRUCTURE) == 0)
-					continue;
+			if (((ret |= ObjectBlockType(collidee, collider)) & BLOCK_STRUCTURE) == 0)
+				continue;
 
-				return ret;
-			}
+			return true;
 		}
-	}
+
+		return false;
+	});
 
 	return ret;
 }
@@ -415,27 +424,25 @@ CMoveMath::BlockType CMoveMath::RangeIsBlockedMt(int xmin, int xmax, int zmin, i
 	BlockType ret = BLOCK_NONE;
 
 	// footprints are point-symmetric around <xSquare, zSquare>
-	for (int z = zmin; z <= zmax; z += FOOTPRINT_ZSTEP) {
-		const int zOffset = z * mapDims.mapx;
+	groundBlockingObjectMap.ForEachOccupiedSquare(xmin, xmax, zmin, zmax, FOOTPRINT_XSTEP, FOOTPRINT_ZSTEP, [&](unsigned int mapSquare) {
+		const CGroundBlockingObjectMap::BlockingMapCell& cell = groundBlockingObjectMap.GetCellUnsafeConst(mapSquare);
 
-		for (int x = xmin; x <= xmax; x += FOOTPRINT_XSTEP) {
-			const CGroundBlockingObjectMap::BlockingMapCell& cell = groundBlockingObjectMap.GetCellUnsafeConst(zOffset + x);
+		for (size_t i = 0, n = cell.size(); i < n; i++) {
+			CSolidObject* collidee = cell[i];
 
-			for (size_t i = 0, n = cell.size(); i < n; i++) {
-				CSolidObject* collidee = cell[i];
-
-				if (collidee->mtTempNum[thread] == tempNum)
-					continue;
+			if (collidee->mtTempNum[thread] == tempNum)
+				continue;
 
-				collidee->mtTempNum[thread] = tempNum;
+			collidee->mtTempNum[thread] = tempNum;
 
-				if (((ret |= ObjectBlockType(collidee, collider)) & BLOCK_STRUCTURE) == 0)
-					continue;
+			if (((ret |= ObjectBlockType(collidee, collider)) & BLOCK_STRUCTURE) == 0)
+				continue;
 
-				return ret;
-			}
+			return true;
 		}
-	}
+
+		return false;
+	});
 
 	return ret;
 }
@@ -454,29 +461,27 @@ CMoveMath::BlockType CMoveMath::RangeIsBlockedHashedSt(int xmin, int xmax, int z
 	}
 
 	// footprints are point-symmetric around <xSquare, zSquare>
-	for (int z = zmin; z <= zmax; z += FOOTPRINT_ZSTEP) {
-		const int zOffset = z * mapDims.mapx;
+	groundBlockingObjectMap.ForEachOccupiedSquare(xmin, xmax, zmin, zmax, FOOTPRINT_XSTEP, FOOTPRINT_ZSTEP, [&](unsigned int mapSquare) {
+		const CGroundBlockingObjectMap::BlockingMapCell& cell = groundBlockingObjectMap.GetCellUnsafeConst(mapSquare);
 
-		for (int x = xmin; x <= xmax; x += FOOTPRINT_XSTEP) {
-			const CGroundBlockingObjectMap::BlockingMapCell& cell = groundBlockingObjectMap.GetCellUnsafeConst(zOffset + x);
+		for (size_t i = 0, n = cell.size(); i < n; i++) {
+			CSolidObject* collidee = cell[i];
 
-			for (size_t i = 0, n = cell.size(); i < n; i++) {
-				CSolidObject* collidee = cell[i];
-
-				auto blockMapResult = blockMap.find(collidee);
-				if (blockMapResult == blockMap.end()) {
-					blockMapResult = blockMap.emplace(collidee, ObjectBlockType(collidee, collider)).first;
-				}
+			auto blockMapResult = blockMap.find(collidee);
+			if (blockMapResult == blockMap.end()) {
+				blockMapResult = blockMap.emplace(collidee, ObjectBlockType(collidee, collider)).first;
+			}
 
-				ret |= blockMapResult->second;
+			ret |= blockMapResult->second;
 
-				if ((ret & BLOCK_STRUCTURE) == 0)
-					continue;
+			if ((ret & BLOCK_STRUCTURE) == 0)
+				continue;
 
-				return ret;
-			}
+			return true;
 		}
-	}
+
+		return false;
+	});
 
 	return ret;
 }
@@ -508,29 +513,27 @@ CMoveMath::BlockType CMoveMath::RangeIsBlockedHashedMt(int xmin, int xmax, int z
 	}
 
 	// footprints are point-symmetric around <xSquare, zSquare>
-	for (int z = zmin; z <= zmax; z += FOOTPRINT_ZSTEP) {
-		const int zOffset = z * mapDims.mapx;
+	groundBlockingObjectMap.ForEachOccupiedSquare(xmin, xmax, zmin, zmax, FOOTPRINT_XSTEP, FOOTPRINT_ZSTEP, [&](unsigned int mapSquare) {
+		const CGroundBlockingObjectMap::BlockingMapCell& cell = groundBlockingObjectMap.GetCellUnsafeConst(mapSquare);
 
-		for (int x = xmin; x <= xmax; x += FOOTPRINT_XSTEP) {
-			const CGroundBlockingObjectMap::BlockingMapCell& cell = groundBlockingObjectMap.GetCellUnsafeConst(zOffset + x);
+		for (size_t i = 0, n = cell.size(); i < n; i++) {
+			CSolidObject* collidee = cell[i];
 
-			for (size_t i = 0, n = cell.size(); i < n; i++) {
-				CSolidObject* collidee = cell[i];
-  
-				auto blockMapResult = blockMap.find(collidee);
-				if (blockMapResult == blockMap.end()) {
-					blockMapResult = blockMap.emplace(collidee, ObjectBlockType(collidee, collider)).first;
-				}
+			auto blockMapResult = blockMap.find(collidee);
+			if (blockMapResult == blockMap.end()) {
+				blockMapResult = blockMap.emplace(collidee, ObjectBlockType(collidee, collider)).first;
+			}
 
-				ret |= blockMapResult->second;
+			ret |= blockMapResult->second;
 
-				if ((ret & BLOCK_STRUCTURE) == 0)
-					continue;
+			if ((ret & BLOCK_STRUCTURE) == 0)
+				continue;
 
-				return ret;
-			}
+			return true;
 		}
-	}
+
+		return false;
+	});
 
 	return ret;
 }
@@ -552,6 +555,11 @@ void CMoveMath::FloodFillRangeIsBlocked(const MoveDef& moveDef, const CSolidObje
 		const int zOffset = z * mapDims.mapx;
 
 		for (int x = areaToSample.x1; x < areaToSample.x2; ++x) {
+			if (!groundBlockingObjectMap.SquareHasObjects(zOffset + x)) {
+				results.emplace_back(BLOCK_NONE);
+				continue;
+			}
+
 			const CGroundBlockingObjectMap::BlockingMapCell& cell = groundBlockingObjectMap.GetCellUnsafeConst(zOffset + x);
 			BlockType ret = BLOCK_NONE;
 
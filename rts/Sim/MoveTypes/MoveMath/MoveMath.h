@@ -81,6 +81,10 @@ public:
 	}
 	static float GetPosSpeedMod(const MoveDef& moveDef, unsigned squareIndex);
 
+	// uncached GetPosSpeedMod, used to fill CSpeedModCache
+	// coordinates must be inside the map
+	static float CalcPosSpeedMod(const MoveDef& moveDef, unsigned xSquare, unsigned zSquare);
+
 	// tells whether a position is blocked (inaccessible for a given object's MoveDef)
 	static inline BlockType IsBlocked(const MoveDef& moveDef, const float3& pos, const CSolidObject* collider, int thread);
 	static inline BlockType IsBlocked(const MoveDef& moveDef, int xSquare, int zSquare, const CSolidObject* collider, int thread);
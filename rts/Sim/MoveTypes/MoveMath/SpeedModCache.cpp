@@ -0,0 +1,135 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "SpeedModCache.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "MoveMath.h"
+#include "Map/ReadMap.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/Log/ILog.h"
+#include "System/Threading/ThreadPool.h"
+
+#include "System/Misc/TracyDefs.h"
+
+CONFIG(int, SpeedModCacheMaxMegaBytes).defaultValue(256).minimumValue(0).description("Memory budget for the per-MoveDef terrain speed-modifier grids; MoveDefs that do not fit compute their speed-modifiers on every query. Does not affect sync.");
+
+CSpeedModCache speedModCache;
+
+
+// true if GetPosSpeedMod gives the same results for both MoveDefs
+static bool SameSpeedModParams(const MoveDef& a, const MoveDef& b)
+{
+	if (a.speedModClass != b.speedModClass)
+		return false;
+	if (a.speedModClass == MoveDef::Ship)
+		return (a.depth == b.depth);
+	if (a.maxSlope != b.maxSlope || a.slopeMod != b.slopeMod)
+		return false;
+	if (a.speedModClass == MoveDef::Hover)
+		return true;
+
+	return (a.depth == b.depth && std::memcmp(a.depthModParams, b.depthModParams, sizeof(a.depthModParams)) == 0);
+}
+
+
+void CSpeedModCache::Init()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const size_t layerSize = mapDims.mapSquares * sizeof(float);
+	const size_t maxLayers = (size_t(configHandler->GetInt("SpeedModCacheMaxMegaBytes")) << 20) / layerSize;
+
+	layers.clear();
+	layerIndices.fill(-1);
+	layerOwners.fill(nullptr);
+
+	for (unsigned int i = 0, n = moveDefHandler.GetNumMoveDefs(); i < n; i++) {
+		const MoveDef* md = moveDefHandler.GetMoveDefByPathType(i);
+
+		const auto pred = [md](const Layer& l) { return SameSpeedModParams(*l.moveDef, *md); };
+		const auto iter = std::find_if(layers.begin(), layers.end(), pred);
+
+		if (iter != layers.end()) {
+			layerIndices[i] = iter - layers.begin();
+			layerOwners[i] = md;
+			continue;
+		}
+
+		if (layers.size() >= maxLayers)
+			continue;
+
+		layerIndices[i] = layers.size();
+		layerOwners[i] = md;
+
+		layers.emplace_back();
+		layers.back().moveDef = md;
+		layers.back().speedMods.resize(mapDims.mapSquares);
+	}
+
+	UpdateAll();
+
+	LOG("[SpeedModCache::%s] %u layers (%.1f MB) for %u MoveDefs", __func__,
+		static_cast<unsigned>(layers.size()), (layers.size() * layerSize) / (1024.0f * 1024.0f), moveDefHandler.GetNumMoveDefs());
+}
+
+void CSpeedModCache::Kill()
+{
+	layers.clear();
+	layerIndices.fill(-1);
+	layerOwners.fill(nullptr);
+}
+
+
+void CSpeedModCache::UpdateAll()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	UpdateArea({0, 0, mapDims.mapx, mapDims.mapy});
+}
+
+void CSpeedModCache::UpdateArea(const SRectangle& rect)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// slopes are smoothed over neighboring half-squares, see CReadMap::UpdateSlopemap
+	const SRectangle r = {
+		std::max(rect.x1 - 4, 0), std::max(rect.z1 - 4, 0),
+		std::min(rect.x2 + 4, mapDims.mapx), std::min(rect.z2 + 4, mapDims.mapy)
+	};
+
+	if (r.GetArea() <= 0)
+		return;
+
+	for (Layer& layer: layers) {
+		UpdateLayerArea(layer, r);
+	}
+}
+
+void CSpeedModCache::TerrainTypeChanged(int ttIndex)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const uint8_t* typeMap = readMap->GetTypeMapSynced();
+
+	for (Layer& layer: layers) {
+		for_mt_chunk(0, mapDims.hmapy, [&](const int tz) {
+			for (int tx = 0; tx < mapDims.hmapx; tx++) {
+				if (typeMap[tz * mapDims.hmapx + tx] != ttIndex)
+					continue;
+
+				for (int z = tz * 2; z < tz * 2 + 2; z++) {
+					for (int x = tx * 2; x < tx * 2 + 2; x++) {
+						layer.speedMods[z * mapDims.mapx + x] = CMoveMath::CalcPosSpeedMod(*layer.moveDef, x, z);
+					}
+				}
+			}
+		}, 16);
+	}
+}
+
+void CSpeedModCache::UpdateLayerArea(Layer& layer, const SRectangle& rect) const
+{
+	for_mt_chunk(rect.z1, rect.z2, [&](const int z) {
+		for (int x = rect.x1; x < rect.x2; x++) {
+			layer.speedMods[z * mapDims.mapx + x] = CMoveMath::CalcPosSpeedMod(*layer.moveDef, x, z);
+		}
+	}, 16);
+}
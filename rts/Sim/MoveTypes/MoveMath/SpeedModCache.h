@@ -0,0 +1,64 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef SPEEDMOD_CACHE_H
+#define SPEEDMOD_CACHE_H
+
+#include <array>
+#include <vector>
+
+#include "Sim/MoveTypes/MoveDefHandler.h"
+#include "System/Rectangle.h"
+
+/**
+ * Per-MoveDef grids of the terrain speed-modifiers returned by the
+ * non-directional CMoveMath::GetPosSpeedMod, one entry per heightmap square.
+ *
+ * The values are computed by the same code as an uncached query and stored
+ * as floats, so a cached lookup is bit-identical to computing it; whether a
+ * MoveDef is cached (see SpeedModCacheMaxMegaBytes) does not affect sync.
+ * MoveDefs with the same speed-mod parameters share a layer since most only
+ * differ in footprint size.
+ *
+ * The layers must be updated whenever the heightmap or terrain types change.
+ */
+class CSpeedModCache {
+public:
+	void Init();
+	void Kill();
+
+	/// heightmap area that changed, in squares, exclusive of x2 and z2
+	void UpdateArea(const SRectangle& rect);
+	void TerrainTypeChanged(int ttIndex);
+	void UpdateAll();
+
+	const float* GetSpeedMods(const MoveDef& moveDef) const {
+		const int layerIdx = layerIndices[moveDef.pathType];
+
+		// moveDef could also be a temporary copy
+		if (layerIdx < 0 || layerOwners[moveDef.pathType] != &moveDef)
+			return nullptr;
+
+		return layers[layerIdx].speedMods.data();
+	}
+
+	size_t GetNumLayers() const { return layers.size(); }
+
+private:
+	struct Layer {
+		const MoveDef* moveDef = nullptr;
+		std::vector<float> speedMods;
+	};
+
+	void UpdateLayerArea(Layer& layer, const SRectangle& rect) const;
+
+private:
+	std::vector<Layer> layers;
+
+	// per MoveDef::pathType, -1 if the MoveDef is not cached
+	std::array<int, MoveDefHandler::MAX_MOVE_DEFS> layerIndices;
+	std::array<const MoveDef*, MoveDefHandler::MAX_MOVE_DEFS> layerOwners;
+};
+
+extern CSpeedModCache speedModCache;
+
+#endif
@@ -84,16 +84,24 @@ void AMoveType::SlowUpdate()
 	UpdateGroundBlockMap();
 }
 
-void AMoveType::UpdateCollisionMap(bool force)
+bool AMoveType::UpdateCollisionPos(bool force)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	if (!force && ((gs->frameNum + owner->id) % modInfo.unitQuadPositionUpdateRate))
-		return;
+		return false;
+
+	if (owner->pos == oldCollisionUpdatePos)
+		return false;
+
+	oldCollisionUpdatePos = owner->pos;
+	return true;
+}
 
-	if (owner->pos != oldCollisionUpdatePos){
-		oldCollisionUpdatePos = owner->pos;
+void AMoveType::UpdateCollisionMap(bool force)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (UpdateCollisionPos(force))
 		quadField.MovedUnit(owner);
-	}
 }
 
 void AMoveType::UpdateGroundBlockMap() {
@@ -54,6 +54,8 @@ public:
 	virtual bool Update() = 0;
 	virtual void SlowUpdate();
 	void UpdateCollisionMap(bool force = false);
+	/// the owner-local half of UpdateCollisionMap, true if a QuadField move is due
+	bool UpdateCollisionPos(bool force = false);
 	void UpdateGroundBlockMap();
 
 	virtual bool IsSkidding() const { return false; }
@@ -40,7 +40,7 @@ void GeneralMoveSystem::Update() {
 
 			unit->PreUpdate();
 
-            if (moveType->Update())
+            if (moveType->Update() && eventHandler.HasSubscribers(CEventHandler::EVENT_UnitMoved))
                 eventHandler.UnitMoved(unit);
 
             // this unit is not coming back, kill it now without any death
@@ -4,20 +4,52 @@
 
 #include "GroundMoveSystem.h"
 
+#include "Map/ReadMap.h"
 #include "Sim/Ecs/Registry.h"
 #include "Sim/Features/Feature.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/MoveTypes/Components/MoveTypesComponents.h"
+#include "Sim/MoveTypes/MoveDefHandler.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitHandler.h"
 
 #include "System/EventHandler.h"
 #include "System/TimeProfiler.h"
+#include "System/Ecs/Utils/SystemGlobalUtils.h"
 #include "System/Threading/ThreadPool.h"
 
 using namespace MoveTypes;
 
-void GroundMoveSystem::Init() {}
+static void InitUnitCollisionGrid() {
+    auto& comp = Sim::systemGlobals.CreateSystemComponent<UnitCollisionGridSystemComponent>();
+
+    // one cell per largest MoveDef footprint; units tend to clump with
+    // their footprints touching, so this keeps the per-cell counts small
+    const float cellSize = std::clamp(
+        float(moveDefHandler.GetLargestFootPrintXSize() * SQUARE_SIZE),
+        float(SQUARE_SIZE * 4),
+        float(CQuadField::BASE_QUAD_SIZE)
+    );
+
+    comp.grid.Init(mapDims.mapx * SQUARE_SIZE, mapDims.mapy * SQUARE_SIZE, cellSize);
+}
+
+static void UpdateUnitCollisionGrid() {
+    auto& comp = Sim::systemGlobals.GetSystemComponent<UnitCollisionGridSystemComponent>();
+    const auto& units = unitHandler.GetActiveUnits();
+
+    comp.grid.Reset(units.size());
+    for_mt(0, units.size(), [&comp, &units](const int i){
+        comp.grid.SetObject(i, units[i]);
+    });
+    comp.grid.Finalize();
+}
+
+void GroundMoveSystem::Init() {
+    InitUnitCollisionGrid();
+
+    Sim::systemUtils.OnPostLoad().connect<&InitUnitCollisionGrid>();
+}
 
 template<typename T, typename F>
 void issue_events(F func)
@@ -106,6 +138,8 @@ void GroundMoveSystem::Update() {
 	}
     {
         SCOPED_TIMER("Sim::Unit::MoveType::3::CollisionDetection");
+        UpdateUnitCollisionGrid();
+
         auto view = Sim::registry.view<GroundMoveType>();
         //size_t count = view.storage<GroundMoveType>().size();
         for_mt(0, view.size(), [&view](const int i){
@@ -155,7 +189,7 @@ void GroundMoveSystem::Update() {
             CUnit* unit = unitHandler.GetUnit(unitId.value);
             CGroundMoveType* moveType = static_cast<CGroundMoveType*>(unit->moveType);
             assert(moveType != nullptr);
-            if (moveType->Update()) 
+            if (moveType->Update() && eventHandler.HasSubscribers(CEventHandler::EVENT_UnitMoved)) 
                 eventHandler.UnitMoved(unit);
 
             #ifndef NDEBUG
@@ -165,4 +199,6 @@ void GroundMoveSystem::Update() {
     }
 }
 
-void GroundMoveSystem::Shutdown() {}
+void GroundMoveSystem::Shutdown() {
+    Sim::systemUtils.OnPostLoad().disconnect<&InitUnitCollisionGrid>();
+}
@@ -0,0 +1,207 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef COLLISION_GRID_H__
+#define COLLISION_GRID_H__
+
+#include <algorithm>
+#include <vector>
+
+#include "System/float3.h"
+#include "System/SpringMath.h"
+
+namespace MoveTypes {
+
+/**
+ * Loose uniform grid over the map used as the broad phase of the ground unit
+ * collision checks. It is rebuilt from scratch every frame: SetObject may be
+ * called concurrently for distinct indices, Finalize then sorts the objects
+ * into cells in index order, which keeps queries deterministic.
+ *
+ * Objects no larger than a cell are stored once, in the cell holding their
+ * center, and queries look one cell further out to find them. Larger objects
+ * (mostly buildings) are stored in every cell their bounding circle overlaps,
+ * like CQuadField does, in a separate set of cells. The cells are sized after
+ * the largest MoveDef footprint instead of 128 elmos and each entry caches the
+ * position and radius, so rejecting far-away objects in dense clumps does not
+ * need to touch the objects themselves.
+ *
+ * T must provide pos and radius members.
+ */
+template<typename T>
+class CollisionGrid {
+public:
+	struct Entry {
+		float3 pos;
+		float radius = 0.0f;
+
+		// cell-rectangle covered by the object, inclusive
+		int x0 = 0;
+		int z0 = 0;
+		int x1 = 0;
+		int z1 = 0;
+
+		T* object = nullptr;
+
+		// true if larger than a cell, see ForEachInRange
+		bool large = false;
+	};
+
+	struct Cells {
+		std::vector<Entry> entries;
+		std::vector<int> starts;
+		std::vector<int> cursors;
+	};
+
+public:
+	void Init(float sizeX, float sizeZ, float _cellSize) {
+		cellSize = _cellSize;
+		invCellSize = 1.0f / cellSize;
+
+		numCellsX = std::max(1, int(sizeX * invCellSize) + 1);
+		numCellsZ = std::max(1, int(sizeZ * invCellSize) + 1);
+
+		for (Cells* cells: {&smallCells, &largeCells}) {
+			cells->entries.clear();
+			cells->starts.clear();
+			cells->starts.resize(numCellsX * numCellsZ + 1, 0);
+		}
+
+		objects.clear();
+	}
+
+	void Reset(size_t numObjects) { objects.resize(numObjects); }
+
+	void SetObject(size_t i, T* object) {
+		Entry& e = objects[i];
+
+		e.pos = object->pos;
+		e.radius = object->radius;
+		e.object = object;
+		e.large = (e.radius > cellSize);
+
+		if (!e.large) {
+			e.x0 = (e.x1 = CellX(e.pos.x));
+			e.z0 = (e.z1 = CellZ(e.pos.z));
+			return;
+		}
+
+		e.x0 = CellX(e.pos.x - e.radius);
+		e.z0 = CellZ(e.pos.z - e.radius);
+		e.x1 = CellX(e.pos.x + e.radius);
+		e.z1 = CellZ(e.pos.z + e.radius);
+	}
+
+	void Finalize() {
+		for (Cells* cells: {&smallCells, &largeCells}) {
+			std::fill(cells->starts.begin(), cells->starts.end(), 0);
+		}
+
+		for (const Entry& e: objects) {
+			Cells& cells = e.large? largeCells: smallCells;
+
+			for (int z = e.z0; z <= e.z1; z++) {
+				for (int x = e.x0; x <= e.x1; x++) {
+					cells.starts[z * numCellsX + x + 1] += 1;
+				}
+			}
+		}
+
+		for (Cells* cells: {&smallCells, &largeCells}) {
+			for (size_t i = 1; i < cells->starts.size(); i++) {
+				cells->starts[i] += cells->starts[i - 1];
+			}
+
+			cells->entries.resize(cells->starts.back());
+			cells->cursors.assign(cells->starts.begin(), cells->starts.end() - 1);
+		}
+
+		for (const Entry& e: objects) {
+			Cells& cells = e.large? largeCells: smallCells;
+
+			for (int z = e.z0; z <= e.z1; z++) {
+				for (int x = e.x0; x <= e.x1; x++) {
+					cells.entries[cells.cursors[z * numCellsX + x]++] = e;
+				}
+			}
+		}
+	}
+
+	/**
+	 * Calls func(T*) once for every object whose bounding sphere is within
+	 * range of pos, the same criterion as CQuadField::GetUnitsExact.
+	 * A large object is only reported from the first cell (lowest x and z)
+	 * that both it and the query rectangle cover.
+	 */
+	template<typename F>
+	void ForEachInRange(const float3& pos, float range, F&& func) const {
+		{
+			const int qx0 = CellX(pos.x - range - cellSize);
+			const int qz0 = CellZ(pos.z - range - cellSize);
+			const int qx1 = CellX(pos.x + range + cellSize);
+			const int qz1 = CellZ(pos.z + range + cellSize);
+
+			for (int z = qz0; z <= qz1; z++) {
+				// cells of a row are contiguous
+				const int i0 = smallCells.starts[z * numCellsX + qx0    ];
+				const int i1 = smallCells.starts[z * numCellsX + qx1 + 1];
+
+				for (int i = i0; i < i1; i++) {
+					const Entry& e = smallCells.entries[i];
+
+					if (pos.SqDistance(e.pos) >= Square(range + e.radius))
+						continue;
+
+					func(e.object);
+				}
+			}
+		}
+
+		if (largeCells.entries.empty())
+			return;
+
+		const int qx0 = CellX(pos.x - range);
+		const int qz0 = CellZ(pos.z - range);
+		const int qx1 = CellX(pos.x + range);
+		const int qz1 = CellZ(pos.z + range);
+
+		for (int z = qz0; z <= qz1; z++) {
+			for (int x = qx0; x <= qx1; x++) {
+				const int cellIdx = z * numCellsX + x;
+
+				for (int i = largeCells.starts[cellIdx], n = largeCells.starts[cellIdx + 1]; i < n; i++) {
+					const Entry& e = largeCells.entries[i];
+
+					if (x != std::max(e.x0, qx0) || z != std::max(e.z0, qz0))
+						continue;
+					if (pos.SqDistance(e.pos) >= Square(range + e.radius))
+						continue;
+
+					func(e.object);
+				}
+			}
+		}
+	}
+
+	float GetCellSize() const { return cellSize; }
+	size_t GetNumObjects() const { return objects.size(); }
+
+private:
+	int CellX(float x) const { return std::clamp(int(x * invCellSize), 0, numCellsX - 1); }
+	int CellZ(float z) const { return std::clamp(int(z * invCellSize), 0, numCellsZ - 1); }
+
+private:
+	std::vector<Entry> objects;
+
+	Cells smallCells;
+	Cells largeCells;
+
+	float cellSize = 1.0f;
+	float invCellSize = 1.0f;
+
+	int numCellsX = 1;
+	int numCellsZ = 1;
+};
+
+}
+
+#endif
@@ -30,6 +30,7 @@ namespace QTPFS {
 
 	struct INode {
 			friend SearchNode;
+			friend NodeLayer; // node-layer cache
 	public:
 		struct NeighbourPoints {
 			int nodeId;
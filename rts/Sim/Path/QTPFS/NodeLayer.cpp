@@ -2,7 +2,9 @@
 
 // #undef NDEBUG
 
+#include <cstring>
 #include <limits>
+#include <type_traits>
 
 #if defined(_MSC_VER)
 #include <intrin.h>
@@ -33,6 +35,60 @@ inline int __bsfd (int mask)
 
 #include "System/Misc/TracyDefs.h"
 
+namespace {
+	// bump whenever QTNode or the layout written by NodeLayer::WriteCache changes
+	constexpr std::uint32_t NODE_LAYER_CACHE_VERSION = 1;
+
+	template<typename T> void WriteCacheValues(std::vector<std::uint8_t>& buffer, const T* values, size_t count) {
+		static_assert(std::is_trivially_copyable_v<T>);
+
+		const size_t offset = buffer.size();
+
+		buffer.resize(offset + count * sizeof(T));
+		std::memcpy(buffer.data() + offset, values, count * sizeof(T));
+	}
+
+	template<typename T> void WriteCacheValue(std::vector<std::uint8_t>& buffer, const T& value) {
+		WriteCacheValues(buffer, &value, 1);
+	}
+
+	struct CacheReader {
+		CacheReader(const std::vector<std::uint8_t>& buffer)
+			: pos(buffer.data())
+			, end(buffer.data() + buffer.size())
+		{}
+
+		template<typename T> void ReadValues(T* values, size_t count) {
+			static_assert(std::is_trivially_copyable_v<T>);
+
+			if (!Skip(count * sizeof(T)))
+				return;
+
+			std::memcpy(values, pos - count * sizeof(T), count * sizeof(T));
+		}
+
+		template<typename T> T ReadValue() {
+			T value = {};
+			ReadValues(&value, 1);
+			return value;
+		}
+
+		bool Skip(size_t numBytes) {
+			valid &= (size_t(end - pos) >= numBytes);
+			pos += (numBytes * valid);
+			return valid;
+		}
+
+		bool AtEnd() const { return (valid && pos == end); }
+
+		const std::uint8_t* pos;
+		const std::uint8_t* end;
+
+		bool valid = true;
+	};
+}
+
+
 unsigned int QTPFS::NodeLayer::NUM_SPEEDMOD_BINS;
 float        QTPFS::NodeLayer::MIN_SPEEDMOD_VALUE;
 float        QTPFS::NodeLayer::MAX_SPEEDMOD_VALUE;
@@ -421,3 +477,125 @@ QTPFS::INode* QTPFS::NodeLayer::GetNodeThatEncasesPowerOfTwoArea(const SRectangl
 	assert(selectedNode != nullptr);
 	return selectedNode;
 }
+
+
+// layout: header, free-list, then all nodes ever allocated (freed ones included)
+// in pool order so that later allocations hand out exactly the same indices as
+// they would after a rebuild
+void QTPFS::NodeLayer::WriteCache(std::vector<std::uint8_t>& buffer) const {
+	RECOIL_DETAILED_TRACY_ZONE;
+	// the free-list starts out as [POOL_TOTAL_SIZE - 1, ..., 0]; only store
+	// the part that has been changed by (de)allocations
+	std::uint32_t numUntouchedIndcs = 0;
+
+	while (numUntouchedIndcs < nodeIndcs.size() && nodeIndcs[numUntouchedIndcs] == (POOL_TOTAL_SIZE - 1 - numUntouchedIndcs))
+		numUntouchedIndcs++;
+
+	WriteCacheValue(buffer, NODE_LAYER_CACHE_VERSION);
+	WriteCacheValue(buffer, std::uint32_t(layerNumber));
+	WriteCacheValue(buffer, std::uint32_t(numLeafNodes));
+	WriteCacheValue(buffer, std::uint32_t(updateCounter));
+	WriteCacheValue(buffer, std::uint32_t(numOpenNodes));
+	WriteCacheValue(buffer, std::uint32_t(numClosedNodes));
+	WriteCacheValue(buffer, std::uint32_t(maxNodesAlloced));
+
+	WriteCacheValue(buffer, numUntouchedIndcs);
+	WriteCacheValue(buffer, std::uint32_t(nodeIndcs.size() - numUntouchedIndcs));
+	WriteCacheValues(buffer, nodeIndcs.data() + numUntouchedIndcs, nodeIndcs.size() - numUntouchedIndcs);
+
+	for (int32_t nodeIndex = 0; nodeIndex < maxNodesAlloced; ++nodeIndex) {
+		const INode* node = GetPoolNode(nodeIndex);
+
+		WriteCacheValue(buffer, node->nodeNumber);
+		WriteCacheValue(buffer, node->index);
+		WriteCacheValue(buffer, node->points);
+		WriteCacheValue(buffer, node->moveCostAvg);
+		WriteCacheValue(buffer, node->childBaseIndex);
+
+		WriteCacheValue(buffer, std::uint32_t(node->neighbours.size()));
+		WriteCacheValues(buffer, node->neighbours.data(), node->neighbours.size());
+	}
+}
+
+bool QTPFS::NodeLayer::IsValidCache(const std::vector<std::uint8_t>& buffer, unsigned int layerNum) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	CacheReader reader(buffer);
+
+	if (reader.ReadValue<std::uint32_t>() != NODE_LAYER_CACHE_VERSION)
+		return false;
+	if (reader.ReadValue<std::uint32_t>() != layerNum)
+		return false;
+
+	reader.Skip(4 * sizeof(std::uint32_t));
+
+	const std::uint32_t maxNodes = reader.ReadValue<std::uint32_t>();
+	const std::uint32_t numUntouchedIndcs = reader.ReadValue<std::uint32_t>();
+	const std::uint32_t numChangedIndcs = reader.ReadValue<std::uint32_t>();
+
+	if (maxNodes > POOL_TOTAL_SIZE || numUntouchedIndcs > POOL_TOTAL_SIZE || numChangedIndcs > (POOL_TOTAL_SIZE - numUntouchedIndcs))
+		return false;
+
+	for (std::uint32_t i = 0; i < numChangedIndcs; ++i) {
+		if (reader.ReadValue<std::uint32_t>() >= maxNodes)
+			return false;
+	}
+
+	constexpr size_t nodeSize =
+		sizeof(INode::nodeNumber) +
+		sizeof(INode::index) +
+		sizeof(INode::points) +
+		sizeof(INode::moveCostAvg) +
+		sizeof(INode::childBaseIndex);
+
+	for (std::uint32_t i = 0; i < maxNodes && reader.valid; ++i) {
+		reader.Skip(nodeSize);
+		reader.Skip(reader.ReadValue<std::uint32_t>() * sizeof(INode::NeighbourPoints));
+	}
+
+	return reader.AtEnd();
+}
+
+void QTPFS::NodeLayer::ReadCache(const std::vector<std::uint8_t>& buffer) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	CacheReader reader(buffer);
+
+	reader.Skip(2 * sizeof(std::uint32_t));
+
+	numLeafNodes = reader.ReadValue<std::uint32_t>();
+	updateCounter = reader.ReadValue<std::uint32_t>();
+	numOpenNodes = reader.ReadValue<std::uint32_t>();
+	numClosedNodes = reader.ReadValue<std::uint32_t>();
+	maxNodesAlloced = reader.ReadValue<std::uint32_t>();
+
+	{
+		const std::uint32_t numUntouchedIndcs = reader.ReadValue<std::uint32_t>();
+		const std::uint32_t numChangedIndcs = reader.ReadValue<std::uint32_t>();
+
+		nodeIndcs.resize(numUntouchedIndcs + numChangedIndcs);
+
+		for (std::uint32_t i = 0; i < numUntouchedIndcs; ++i) {
+			nodeIndcs[i] = POOL_TOTAL_SIZE - 1 - i;
+		}
+
+		reader.ReadValues(nodeIndcs.data() + numUntouchedIndcs, numChangedIndcs);
+	}
+
+	for (int32_t nodeIndex = 0; nodeIndex < maxNodesAlloced; ++nodeIndex) {
+		if (poolNodes[nodeIndex / POOL_CHUNK_SIZE].empty())
+			poolNodes[nodeIndex / POOL_CHUNK_SIZE].resize(POOL_CHUNK_SIZE);
+
+		INode* node = GetPoolNode(nodeIndex);
+
+		node->nodeNumber = reader.ReadValue<decltype(node->nodeNumber)>();
+		node->index = reader.ReadValue<decltype(node->index)>();
+		node->points = reader.ReadValue<decltype(node->points)>();
+		node->moveCostAvg = reader.ReadValue<decltype(node->moveCostAvg)>();
+		node->childBaseIndex = reader.ReadValue<decltype(node->childBaseIndex)>();
+
+		node->neighbours.resize(reader.ReadValue<std::uint32_t>());
+		reader.ReadValues(node->neighbours.data(), node->neighbours.size());
+	}
+
+	assert(reader.AtEnd());
+	assert(numOpenNodes + numClosedNodes == numLeafNodes);
+}
@@ -165,6 +165,15 @@ namespace QTPFS {
 
 		bool UseShortestPath() { return useShortestPath; }
 
+		// (de)serialize the complete node tree and allocation state, see
+		// PathManager::ReadNodeLayersCache; ReadCache assumes the layer has
+		// been through PathManager::InitNodeLayer and the buffer passed the
+		// IsValidCache check
+		void WriteCache(std::vector<std::uint8_t>& buffer) const;
+		void ReadCache(const std::vector<std::uint8_t>& buffer);
+
+		static bool IsValidCache(const std::vector<std::uint8_t>& buffer, unsigned int layerNum);
+
 	private:
 		std::vector<QTNode> poolNodes[16];
 		std::vector<unsigned int> nodeIndcs;
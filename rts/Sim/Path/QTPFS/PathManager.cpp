@@ -9,6 +9,9 @@
 #include <cinttypes>
 #include <deque>
 #include <functional>
+#include <iomanip>
+#include <limits>
+#include <memory>
 
 #include "System/Threading/ThreadPool.h"
 #include "System/Threading/SpringThreading.h"
@@ -18,22 +21,33 @@
 
 #include "Utils/PathSpeedModInfoSystemUtils.h"
 
+#include "zlib.h"
+#include "minizip/zip.h"
+
 #include "Game/GameSetup.h"
+#include "Game/GlobalUnsynced.h"
 #include "Game/LoadScreen.h"
 #include "Map/MapInfo.h"
+#include "Map/ReadMap.h"
 
 #include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/GroundBlockingObjectMap.h"
 #include "Sim/Misc/ModInfo.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
 #include "Sim/MoveTypes/MoveMath/MoveMath.h"
 #include "Sim/Objects/SolidObject.h"
 #include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/ArchiveLoader.h"
 #include "System/FileSystem/ArchiveScanner.h"
+#include "System/FileSystem/Archives/IArchive.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/Log/ILog.h"
 #include "System/Platform/Threading.h"
 #include "System/Rectangle.h"
+#include "System/SpringHash.h"
 #include "System/TimeProfiler.h"
 #include "System/StringUtil.h"
 
@@ -57,6 +71,9 @@
 #define MAP_RECTANGLE SRectangle(0, 0,  mapDims.mapx, mapDims.mapy)
 
 CONFIG(int, PathingThreadCount).defaultValue(0).safemodeValue(1).minimumValue(0);
+CONFIG(std::string, QTPFSDumpSearches).defaultValue("").description("Record every path request queued to QTPFS in this file (one line per request), for benchmarking with QTPFSReplaySearches.");
+CONFIG(std::string, QTPFSReplaySearches).defaultValue("").description("Benchmark QTPFS by replaying the path requests recorded through QTPFSDumpSearches as soon as the node-layers are built, then quit.");
+CONFIG(bool, QTPFSCacheNodeLayers).defaultValue(true).description("Store the initial QTPFS node-layers in the cache directory and load them from there instead of rebuilding them when the same map, game and movedefs are used again.");
 
 namespace QTPFS {
 	struct PMLoadScreen {
@@ -127,6 +144,45 @@ namespace QTPFS {
 		return ((numThreads == 0)? numCores: numThreads);
 	}
 
+	static std::string GetNodeLayersCacheDir() {
+		return (FileSystem::GetCacheDir() + FileSystemAbstraction::GetNativePathSeparator() + "paths" + FileSystemAbstraction::GetNativePathSeparator());
+	}
+
+	static std::string GetNodeLayersCacheFileName(std::uint32_t hash) {
+		return (GetNodeLayersCacheDir() + mapInfo->map.name + ".qtpfs-" + IntToString(hash, "%x") + ".zip");
+	}
+
+	static std::string GetNodeLayerCacheEntryName(unsigned int layerNum) {
+		return ("nodelayer" + IntToString(layerNum));
+	}
+
+	// covers everything the initial tesselation depends on, including the
+	// Lua-modified terrain and whatever is blocking the map at load time;
+	// a false mismatch only costs a rebuild
+	static std::uint32_t CalcNodeLayersCacheHash(const sha512::raw_digest& mapCheckSum, const sha512::raw_digest& modCheckSum, int rootSize) {
+		RECOIL_DETAILED_TRACY_ZONE;
+		std::uint32_t hash = spring::LiteHash(mapCheckSum);
+
+		hash = spring::LiteHash(modCheckSum, hash);
+		hash = spring::LiteHash(readMap->CalcHeightmapChecksum(), hash);
+		hash = spring::LiteHash(readMap->CalcTypemapChecksum(), hash);
+		hash = spring::LiteHash(moveDefHandler.GetCheckSum(), hash);
+		hash = spring::LiteHash(mapInfo->pfs.qtpfs_constants, hash);
+		hash = spring::LiteHash(rootSize, hash);
+		hash = spring::LiteHash(sizeof(QTNode), hash);
+
+		for (int sqrIdx = 0, numSqrs = mapDims.mapx * mapDims.mapy; sqrIdx < numSqrs; ++sqrIdx) {
+			const CGroundBlockingObjectMap::BlockingMapCell& cell = groundBlockingObjectMap.GetCellUnsafeConst(sqrIdx);
+
+			for (size_t i = 0, n = cell.size(); i < n; ++i) {
+				hash = spring::LiteHash(sqrIdx, hash);
+				hash = spring::LiteHash(cell[i]->GetBlockingMapID(), hash);
+			}
+		}
+
+		return hash;
+	}
+
 	unsigned int PathManager::LAYERS_PER_UPDATE;
 	unsigned int PathManager::MAX_TEAM_SEARCHES;
 
@@ -233,6 +289,24 @@ std::int64_t QTPFS::PathManager::Finalize() {
 	const spring_time t1 = spring_gettime();
 	const spring_time dt = t1 - t0;
 
+	{
+		const std::string dumpFileName = configHandler->GetString("QTPFSDumpSearches");
+		const std::string replayFileName = configHandler->GetString("QTPFSReplaySearches");
+
+		if (!dumpFileName.empty()) {
+			searchDumpFile.open(dataDirsAccess.LocateFile(dumpFileName, FileQueryFlags::WRITE).c_str(), std::ios::out);
+
+			if (!searchDumpFile.is_open())
+				LOG_L(L_WARNING, "[QTPFS::%s] could not open \"%s\" for recording path requests", __func__, dumpFileName.c_str());
+
+			// enough digits for the positions to read back bit-exact
+			searchDumpFile << std::setprecision(std::numeric_limits<float>::max_digits10);
+		}
+
+		if (!replayFileName.empty())
+			ReplaySearches(replayFileName);
+	}
+
 	return (dt.toMilliSecsi());
 }
 
@@ -339,7 +413,17 @@ void QTPFS::PathManager::Load() {
 		sha512::dump_digest(mapCheckSum, mapCheckSumHex);
 		sha512::dump_digest(modCheckSum, modCheckSumHex);
 
-		InitNodeLayersThreaded(MAP_RECTANGLE);
+		if (configHandler->GetBool("QTPFSCacheNodeLayers")) {
+			const std::string cacheFileName = GetNodeLayersCacheFileName(CalcNodeLayersCacheHash(mapCheckSum, modCheckSum, rootSize));
+
+			if (!ReadNodeLayersCache(MAP_RECTANGLE, cacheFileName)) {
+				InitNodeLayersThreaded(MAP_RECTANGLE);
+				WriteNodeLayersCache(cacheFileName);
+			}
+		} else {
+			InitNodeLayersThreaded(MAP_RECTANGLE);
+		}
+
 		PathSpeedModInfoSystem::Init();
 		RemoveDeadPathsSystem::Init();
 		RequeuePathsSystem::Init();
@@ -431,6 +515,109 @@ std::uint64_t QTPFS::PathManager::GetMemFootPrint() const {
 
 
 
+void QTPFS::PathManager::SearchReplayStats::AddSearch(const PathSearch& search, int frame) {
+	if (frame != curFrame) {
+		curFrame = frame;
+		frameHashes.clear();
+	}
+
+	numSearches += 1;
+	numPathsFound += search.PathWasFound();
+	numNodesSearched += search.GetNumNodesSearched();
+
+	if (search.GetHash() != QTPFS::BAD_HASH)
+		numHashRepeats += (!frameHashes.insert(search.GetHash()).second);
+}
+
+void QTPFS::PathManager::DumpQueuedSearch(
+	const MoveDef* moveDef,
+	const float3& sourcePoint,
+	const float3& targetPoint,
+	float radius,
+	bool synced
+) {
+	// <frame> <pathType> <source.xyz> <target.xyz> <radius> <synced>
+	searchDumpFile << gs->frameNum << " " << moveDef->pathType << " ";
+	searchDumpFile << sourcePoint.x << " " << sourcePoint.y << " " << sourcePoint.z << " ";
+	searchDumpFile << targetPoint.x << " " << targetPoint.y << " " << targetPoint.z << " ";
+	searchDumpFile << radius << " " << synced << "\n";
+}
+
+void QTPFS::PathManager::ReplaySearches(const std::string& fileName) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	std::ifstream file(dataDirsAccess.LocateFile(fileName).c_str(), std::ios::in);
+
+	if (!file.is_open()) {
+		LOG_L(L_ERROR, "[QTPFS::%s] could not open \"%s\"", __func__, fileName.c_str());
+		return;
+	}
+
+	struct RecordedSearch {
+		int frame;
+		unsigned int pathType;
+		float3 sourcePoint;
+		float3 targetPoint;
+		float radius;
+		bool synced;
+	};
+
+	std::vector<RecordedSearch> searches;
+	RecordedSearch rs;
+
+	while (file >> rs.frame >> rs.pathType >> rs.sourcePoint.x >> rs.sourcePoint.y >> rs.sourcePoint.z >> rs.targetPoint.x >> rs.targetPoint.y >> rs.targetPoint.z >> rs.radius >> rs.synced) {
+		// recorded with a different set of movedefs
+		if (rs.pathType >= moveDefHandler.GetNumMoveDefs())
+			continue;
+
+		searches.push_back(rs);
+	}
+
+	LOG("[QTPFS::%s] replaying %u path requests from \"%s\"", __func__, uint32_t(searches.size()), fileName.c_str());
+
+	// all requests are executed as immediate unsynced searches, one at a
+	// time on this thread; sharing between synced paths and the per-frame
+	// request limits of a live game do not apply. Synced (unit) and unsynced
+	// (Lua) requests are replayed in separate passes since their mix differs
+	// per game, each keeping its recorded order
+	const std::uint64_t memFootPrintPre = GetMemFootPrint();
+
+	for (const bool synced: {true, false}) {
+		SearchReplayStats stats;
+
+		const char* kind = synced? "synced": "unsynced";
+		const spring_time t0 = spring_gettime();
+
+		for (const RecordedSearch& search: searches) {
+			if (search.synced != synced)
+				continue;
+
+			const MoveDef* moveDef = moveDefHandler.GetMoveDefByPathType(search.pathType);
+			const unsigned int pathID = QueueSearch(nullptr, moveDef, search.sourcePoint, search.targetPoint, search.radius, false, false);
+
+			if (pathID == 0)
+				continue;
+
+			if (ExecuteImmediateSearch(pathID, &stats, search.frame) != 0)
+				DeletePath(pathID, true);
+		}
+
+		const spring_time t1 = spring_gettime();
+
+		const float replaySecs = std::max((t1 - t0).toSecsf(), 1e-6f);
+		const float numSearches = std::max(stats.numSearches, size_t(1));
+
+		LOG("[QTPFS::%s] %s searches: %u (%u found) in %.3fs, %.1f searches/s", __func__, kind, uint32_t(stats.numSearches), uint32_t(stats.numPathsFound), replaySecs, stats.numSearches / replaySecs);
+		LOG("[QTPFS::%s] %s nodes searched: %u total, %.1f per search", __func__, kind, uint32_t(stats.numNodesSearched), stats.numNodesSearched / numSearches);
+		LOG("[QTPFS::%s] %s same-frame hash repeats (shareable paths): %u, %.1f%%", __func__, kind, uint32_t(stats.numHashRepeats), (stats.numHashRepeats * 100.0f) / numSearches);
+	}
+
+	const std::uint64_t memFootPrintPost = GetMemFootPrint();
+
+	LOG("[QTPFS::%s] mem-footprint: %uMB before, %uMB after", __func__, uint32_t(memFootPrintPre), uint32_t(memFootPrintPost));
+
+	gu->globalQuit = true;
+}
+
 void QTPFS::PathManager::InitNodeLayersThreaded(const SRectangle& rect) {
 	RECOIL_DETAILED_TRACY_ZONE;
 	streflop::streflop_init<streflop::Simple>();
@@ -484,6 +671,95 @@ void QTPFS::PathManager::InitNodeLayersThreaded(const SRectangle& rect) {
 	streflop::streflop_init<streflop::Simple>();
 }
 
+bool QTPFS::PathManager::ReadNodeLayersCache(const SRectangle& rect, const std::string& cacheFileName) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	LOG("[QTPFS::%s] file=\"%s\" (exists=%d)", __func__, cacheFileName.c_str(), FileSystem::FileExists(cacheFileName));
+
+	if (!FileSystem::FileExists(cacheFileName))
+		return false;
+
+	std::vector< std::vector<std::uint8_t> > layerBuffers(nodeLayers.size());
+	std::vector<std::uint8_t> validLayers(nodeLayers.size(), false);
+
+	{
+		std::unique_ptr<IArchive> upfile(archiveLoader.OpenArchive(dataDirsAccess.LocateFile(cacheFileName), "sdz"));
+
+		if (upfile != nullptr && upfile->IsOpen()) {
+			// archive reads are serialized anyway
+			for (unsigned int layerNum = 0; layerNum < nodeLayers.size(); ++layerNum) {
+				const unsigned int fid = upfile->FindFile(GetNodeLayerCacheEntryName(layerNum));
+
+				if (fid >= upfile->NumFiles() || !upfile->GetFile(fid, layerBuffers[layerNum]))
+					break;
+			}
+		}
+	}
+
+	for_mt(0, nodeLayers.size(), [&](const int layerNum) {
+		validLayers[layerNum] = NodeLayer::IsValidCache(layerBuffers[layerNum], layerNum);
+	});
+
+	// nothing has been touched yet, so a rebuild can take over from here
+	if (std::find(validLayers.begin(), validLayers.end(), false) != validLayers.end()) {
+		LOG_L(L_WARNING, "[QTPFS::%s] removing stale or corrupt cache-file \"%s\"", __func__, cacheFileName.c_str());
+		FileSystem::Remove(cacheFileName);
+		return false;
+	}
+
+	char loadMsg[512] = {'\0'};
+	const char* fmtString = "[PathManager::%s] reading %u node-layers from cache";
+	snprintf(loadMsg, sizeof(loadMsg), fmtString, __func__, uint32_t(nodeLayers.size()));
+	pmLoadScreen.AddMessage(loadMsg);
+
+	for_mt(0, nodeLayers.size(), [&](const int layerNum) {
+		InitNodeLayer(layerNum, rect);
+
+		nodeLayers[layerNum].ReadCache(layerBuffers[layerNum]);
+		layerBuffers[layerNum] = {};
+
+		pathCache.SetLayerPathCount(layerNum, INITIAL_PATH_RESERVE);
+	});
+
+	return true;
+}
+
+void QTPFS::PathManager::WriteNodeLayersCache(const std::string& cacheFileName) const {
+	RECOIL_DETAILED_TRACY_ZONE;
+	// we need this directory to exist
+	if (!FileSystem::CreateDirectory(GetNodeLayersCacheDir()))
+		return;
+
+	zipFile file = zipOpen(dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE).c_str(), APPEND_STATUS_CREATE);
+
+	if (file == nullptr) {
+		LOG_L(L_WARNING, "[QTPFS::%s] could not create cache-file \"%s\"", __func__, cacheFileName.c_str());
+		return;
+	}
+
+	std::vector<std::uint8_t> layerBuffer;
+	bool written = true;
+
+	for (unsigned int layerNum = 0; layerNum < nodeLayers.size(); ++layerNum) {
+		layerBuffer.clear();
+		nodeLayers[layerNum].WriteCache(layerBuffer);
+
+		// the layers are large and mostly read back, favour speed over size
+		written &= (zipOpenNewFileInZip(file, GetNodeLayerCacheEntryName(layerNum).c_str(), nullptr, nullptr, 0, nullptr, 0, nullptr, Z_DEFLATED, Z_BEST_SPEED) == ZIP_OK);
+		written &= (zipWriteInFileInZip(file, layerBuffer.data(), layerBuffer.size()) == ZIP_OK);
+		written &= (zipCloseFileInZip(file) == ZIP_OK);
+	}
+
+	written &= (zipClose(file, nullptr) == ZIP_OK);
+
+	if (!written) {
+		LOG_L(L_WARNING, "[QTPFS::%s] could not write cache-file \"%s\"", __func__, cacheFileName.c_str());
+		FileSystem::Remove(cacheFileName);
+		return;
+	}
+
+	LOG("[QTPFS::%s] written cache-file \"%s\"", __func__, cacheFileName.c_str());
+}
+
 void QTPFS::PathManager::InitRootSize(const SRectangle& r) {
 	RECOIL_DETAILED_TRACY_ZONE;
 	// setup the root node system
@@ -707,6 +983,11 @@ void QTPFS::PathManager::Update() {
 		SCOPED_TIMER("Sim::Path::Requests");
 		ThreadUpdate();
 	}
+
+	// keep the recording usable if the process gets killed
+	if (searchDumpFile.is_open())
+		searchDumpFile.flush();
+
 	{
 		SCOPED_TIMER("Sim::Path::MapUpdates");
 
@@ -1275,6 +1556,9 @@ unsigned int QTPFS::PathManager::QueueSearch(
 	newSearch->initialized = false;
 	newSearch->synced = synced;
 
+	if (searchDumpFile.is_open())
+		DumpQueuedSearch(moveDef, sourcePoint, targetPoint, radius, synced);
+
 	// LOG("%s: %s (%x) %d -> %d ", __func__
 	// 		, unit != nullptr ? unit->unitDef->name.c_str() : "non-unit"
 	// 		, newPath->GetID()
@@ -1487,7 +1771,7 @@ unsigned int QTPFS::PathManager::RequestPath(
 	return returnPathId;
 }
 
-unsigned int QTPFS::PathManager::ExecuteImmediateSearch(unsigned int pathId){
+unsigned int QTPFS::PathManager::ExecuteImmediateSearch(unsigned int pathId, SearchReplayStats* replayStats, int replayFrame){
 	RECOIL_DETAILED_TRACY_ZONE;
 	QTPFS::entity pathEntity = QTPFS::entity(pathId);
 	assert(registry.valid(pathEntity));
@@ -1500,6 +1784,9 @@ unsigned int QTPFS::PathManager::ExecuteImmediateSearch(unsigned int pathId){
 	NodeLayer& nodeLayer = nodeLayers[pathType];
 	ExecuteSearch(&pathSearch, nodeLayer, pathType);
 
+	if (replayStats != nullptr)
+		replayStats->AddSearch(pathSearch, replayFrame);
+
 	if (registry.valid(pathEntity)) {
 		IPath* path = GetPath(pathEntity);
 		if (path != nullptr) {
@@ -3,6 +3,7 @@
 #ifndef QTPFS_PATHMANAGER_HDR
 #define QTPFS_PATHMANAGER_HDR
 
+#include <fstream>
 #include <vector>
 
 #include "Sim/Misc/ModInfo.h"
@@ -11,6 +12,7 @@
 #include "PathCache.h"
 #include "PathSearch.h"
 #include "System/UnorderedMap.hpp"
+#include "System/UnorderedSet.hpp"
 
 struct MoveDef;
 struct SRectangle;
@@ -100,6 +102,22 @@ namespace QTPFS {
 
 		std::uint64_t GetMemFootPrint() const;
 
+		struct SearchReplayStats {
+			void AddSearch(const PathSearch& search, int frame);
+
+			size_t numSearches = 0;
+			size_t numPathsFound = 0;
+			size_t numNodesSearched = 0;
+			/// searches whose hash matched an earlier one queued in the same frame, i.e. could have shared its path
+			size_t numHashRepeats = 0;
+
+			int curFrame = -1;
+			spring::unordered_set<PathHashType> frameHashes;
+		};
+
+		void DumpQueuedSearch(const MoveDef* moveDef, const float3& sourcePoint, const float3& targetPoint, float radius, bool synced);
+		void ReplaySearches(const std::string& fileName);
+
 		typedef void (PathManager::*MemberFunc)(
 			unsigned int threadNum,
 			unsigned int numThreads,
@@ -118,6 +136,8 @@ namespace QTPFS {
 		typedef std::vector<PathSearch*>::iterator PathSearchVectIt;
 
 		void InitNodeLayersThreaded(const SRectangle& rect);
+		bool ReadNodeLayersCache(const SRectangle& rect, const std::string& cacheFileName);
+		void WriteNodeLayersCache(const std::string& cacheFileName) const;
 		void InitNodeLayer(unsigned int layerNum, const SRectangle& r);
 		void InitRootSize(const SRectangle& r);
 		void UpdateNodeLayer(unsigned int layerNum, const SRectangle& r, int currentThread);
@@ -156,7 +176,7 @@ namespace QTPFS {
 			unsigned int pathType
 		);
 
-		unsigned int ExecuteImmediateSearch(unsigned int pathId);
+		unsigned int ExecuteImmediateSearch(unsigned int pathId, SearchReplayStats* replayStats = nullptr, int replayFrame = 0);
 
 		bool IsFinalized() const { return isFinalized; }
 
@@ -180,6 +200,9 @@ namespace QTPFS {
 
 		NodeLayersChangeTrack nodeLayersMapDamageTrack;
 
+		// see QTPFSDumpSearches
+		std::ofstream searchDumpFile;
+
 		int deadPathsToUpdatePerFrame = 1;
 		int recalcDeadPathUpdateRateOnFrame = 0;
 		int rootSize = 0;
@@ -124,6 +124,7 @@ namespace QTPFS {
 		const PathHashType GetPartialSearchHash() const { return pathPartialSearchHash; };
 
 		bool PathWasFound() const { return haveFullPath | havePartPath; }
+		size_t GetNumNodesSearched() const { return fwdNodesSearched + bwdNodesSearched; }
 
 		void SetPathType(int newPathType) { pathType = newPathType; }
 		int GetPathType() const { return pathType; }
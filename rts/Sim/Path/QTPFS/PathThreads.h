@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "Node.h"
+#include "SearchQueue.h"
 
 #include "Map/ReadMap.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
@@ -89,28 +90,11 @@ namespace QTPFS {
         }
     };
 
-    struct SearchQueueNode {
-        SearchQueueNode(int index, float newPriorty)
-            : heapPriority(newPriorty)
-            , nodeIndex(index)
-            {}
-
-        float heapPriority;
-        int nodeIndex;
-    };
-
-    /// Functor to define node priority.
-    /// Needs to guarantee stable ordering, even if the sorting algorithm itself is not stable.
-    struct ShouldMoveTowardsBottomOfPriorityQueue {
-        inline bool operator() (const SearchQueueNode& lhs, const SearchQueueNode& rhs) const {
-            return std::tie(lhs.heapPriority, lhs.nodeIndex) > std::tie(rhs.heapPriority, rhs.nodeIndex);
-        }
-    };
-
-
-    // Reminder that std::priority does comparisons to push element back to the bottom. So using
-    // ShouldMoveTowardsBottomOfPriorityQueue here means the smallest value will be top()
-    typedef std::priority_queue<SearchQueueNode, std::vector<SearchQueueNode>, ShouldMoveTowardsBottomOfPriorityQueue> SearchPriorityQueue;
+#ifdef QTPFS_BUCKETED_SEARCH_QUEUE
+    typedef BucketedSearchQueue SearchPriorityQueue;
+#else
+    typedef BinarySearchQueue SearchPriorityQueue;
+#endif
 
 	struct SearchThreadData {
 
@@ -0,0 +1,215 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef QTPFS_SEARCHQUEUE_HDR
+#define QTPFS_SEARCHQUEUE_HDR
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "PathDefines.h"
+
+namespace QTPFS {
+    struct SearchQueueNode {
+        SearchQueueNode(int index, float newPriorty)
+            : heapPriority(newPriorty)
+            , nodeIndex(index)
+            {}
+
+        float heapPriority;
+        int nodeIndex;
+    };
+
+    /// Functor to define node priority.
+    /// Needs to guarantee stable ordering, even if the sorting algorithm itself is not stable.
+    struct ShouldMoveTowardsBottomOfPriorityQueue {
+        inline bool operator() (const SearchQueueNode& lhs, const SearchQueueNode& rhs) const {
+            return std::tie(lhs.heapPriority, lhs.nodeIndex) > std::tie(rhs.heapPriority, rhs.nodeIndex);
+        }
+    };
+
+
+    // Reminder that std::priority does comparisons to push element back to the bottom. So using
+    // ShouldMoveTowardsBottomOfPriorityQueue here means the smallest value will be top()
+    typedef std::priority_queue<SearchQueueNode, std::vector<SearchQueueNode>, ShouldMoveTowardsBottomOfPriorityQueue> BinarySearchQueue;
+
+
+    /**
+     * Drop-in replacement for BinarySearchQueue which only keeps the bucket
+     * holding the lowest priorities heap-ordered; everything else is appended
+     * unsorted to one of NUM_BUCKETS buckets of equal priority-width, or to an
+     * overflow list past the last bucket. The buckets are re-spread over the
+     * overflow's priority range whenever they run empty.
+     *
+     * The bucket index is a monotonic function of the priority, so every node
+     * in a lower bucket has a lower priority than any in a higher one and the
+     * pop order is exactly that of BinarySearchQueue (paths stay in sync); it
+     * also holds for nodes pushed below the current bucket, which A* does with
+     * inconsistent heuristics, since they are simply added to the heap.
+     */
+    class BucketedSearchQueue {
+    public:
+        using value_type = SearchQueueNode;
+
+        static constexpr size_t NUM_BUCKETS = 256;
+
+        bool empty() const { return (numNodes == 0); }
+        size_t size() const { return numNodes; }
+
+        const SearchQueueNode& top() const {
+            assert(!empty());
+            return buckets[curBucket].front();
+        }
+
+        void push(const SearchQueueNode& n) {
+            assert(!std::isnan(n.heapPriority));
+
+            const float relKey = (n.heapPriority - baseKey) * invBucketWidth;
+
+            numNodes += 1;
+
+            if (singleHeap || relKey < float(curBucket + 1)) {
+                PushHeap(buckets[curBucket], n);
+                return;
+            }
+
+            if (relKey < float(NUM_BUCKETS)) {
+                buckets[size_t(relKey)].push_back(n);
+            } else {
+                overflow.push_back(n);
+            }
+
+            // only possible if we were empty
+            if (buckets[curBucket].empty())
+                Advance();
+        }
+
+        template<typename... Args>
+        void emplace(Args&&... args) { push(SearchQueueNode(std::forward<Args>(args)...)); }
+
+        void pop() {
+            assert(!empty());
+
+            std::vector<SearchQueueNode>& heap = buckets[curBucket];
+
+            std::pop_heap(heap.begin(), heap.end(), cmp);
+            heap.pop_back();
+
+            numNodes -= 1;
+
+            if (heap.empty())
+                Advance();
+        }
+
+        void clear() {
+            for (std::vector<SearchQueueNode>& bucket: buckets) {
+                bucket.clear();
+            }
+
+            overflow.clear();
+
+            numNodes = 0;
+            curBucket = 0;
+            singleHeap = false;
+        }
+
+    private:
+        void PushHeap(std::vector<SearchQueueNode>& heap, const SearchQueueNode& n) {
+            heap.push_back(n);
+            std::push_heap(heap.begin(), heap.end(), cmp);
+        }
+
+        // makes the first non-empty bucket the current one
+        void Advance() {
+            singleHeap = false;
+
+            if (numNodes == 0) {
+                assert(overflow.empty());
+                curBucket = 0;
+                return;
+            }
+
+            for (size_t i = curBucket + 1; i < NUM_BUCKETS; ++i) {
+                if (buckets[i].empty())
+                    continue;
+
+                std::make_heap(buckets[i].begin(), buckets[i].end(), cmp);
+                curBucket = i;
+                return;
+            }
+
+            Rebase();
+        }
+
+        void Rebase() {
+            assert(!overflow.empty());
+
+            float minKey = std::numeric_limits<float>::infinity();
+            float maxKey = -std::numeric_limits<float>::infinity();
+
+            for (const SearchQueueNode& n: overflow) {
+                minKey = std::min(minKey, n.heapPriority);
+
+                if (std::isfinite(n.heapPriority))
+                    maxKey = std::max(maxKey, n.heapPriority);
+            }
+
+            curBucket = 0;
+
+            // only unreachable (infinite-cost) nodes left, order them by index
+            if (!std::isfinite(minKey)) {
+                buckets[0].swap(overflow);
+                std::make_heap(buckets[0].begin(), buckets[0].end(), cmp);
+
+                singleHeap = true;
+                return;
+            }
+
+            baseKey = minKey;
+
+            if (maxKey > minKey)
+                invBucketWidth = (NUM_BUCKETS - 1) / (maxKey - minKey);
+
+            size_t numOverflow = 0;
+
+            for (const SearchQueueNode& n: overflow) {
+                const float relKey = (n.heapPriority - baseKey) * invBucketWidth;
+
+                if (relKey < float(NUM_BUCKETS)) {
+                    buckets[size_t(relKey)].push_back(n);
+                } else {
+                    overflow[numOverflow++] = n;
+                }
+            }
+
+            overflow.erase(overflow.begin() + numOverflow, overflow.end());
+
+            // the minimum maps to bucket 0
+            assert(!buckets[0].empty());
+            std::make_heap(buckets[0].begin(), buckets[0].end(), cmp);
+        }
+
+    private:
+        std::array<std::vector<SearchQueueNode>, NUM_BUCKETS> buckets;
+        std::vector<SearchQueueNode> overflow;
+
+        ShouldMoveTowardsBottomOfPriorityQueue cmp;
+
+        size_t numNodes = 0;
+        size_t curBucket = 0;
+
+        float baseKey = 0.0f;
+        float invBucketWidth = 1.0f;
+
+        // set while all nodes are kept in buckets[0], see Rebase
+        bool singleHeap = false;
+    };
+}
+
+#endif
@@ -46,6 +46,15 @@ public:
 	//Not inheritable - used for removing a projectile from Lua.
 	void Delete();
 	virtual void Update();
+
+	// synced projectiles whose Update() only touches their own state (and
+	// reads shared state) can be advanced in parallel; anything with a side
+	// effect on the simulation or on shared containers must be deferred to
+	// CommitConcurrentUpdate(), which runs on the main thread in ID order
+	virtual bool CanUpdateConcurrently() const { return false; }
+	virtual void UpdateConcurrently() { Update(); }
+	virtual void CommitConcurrentUpdate() {}
+
 	virtual void Init(const CUnit* owner, const float3& offset) override;
 
 	virtual void Draw() {}
@@ -42,6 +42,7 @@
 
 CONFIG(int, MaxParticles).defaultValue(10000).headlessValue(0).minimumValue(0);
 CONFIG(int, MaxNanoParticles).defaultValue(2000).headlessValue(0).minimumValue(0);
+CONFIG(bool, UpdateSyncedProjectilesMT).defaultValue(true).description("Run CProjectile::Update for self-contained synced projectiles on worker threads, committing QuadField moves and trail effects afterwards in serial order, and gather the units and features synced projectiles may collide with there. Self-contained projectiles update before the others either way, so clients with different settings stay in sync.");
 
 
 CR_BIND(CProjectileHandler, )
@@ -55,7 +56,12 @@ CR_REG_METADATA(CProjectileHandler, (
 	CR_MEMBER(maxNanoParticles),
 	CR_MEMBER(currentNanoParticles),
 	CR_MEMBER_UN(frameCurrentParticles),
-	CR_MEMBER_UN(frameProjectileCounts)
+	CR_MEMBER_UN(frameProjectileCounts),
+
+	CR_IGNORED(syncedUpdateActions),
+	CR_IGNORED(updateSyncedMT),
+	CR_IGNORED(collisionCandidates),
+	CR_IGNORED(liveCollisionCandidates)
 ))
 
 
@@ -79,6 +85,7 @@ void CProjectileHandler::Init()
 
 	maxParticles     = configHandler->GetInt("MaxParticles");
 	maxNanoParticles = configHandler->GetInt("MaxNanoParticles");
+	updateSyncedMT   = configHandler->GetBool("UpdateSyncedProjectilesMT");
 
 	projMemPool.clear();
 	projMemPool.reserve(1024);
@@ -191,12 +198,52 @@ void CProjectileHandler::UpdateProjectilesImpl()
 
 	// WARNING: same as above but for p->Update()
 	if constexpr (synced) {
+		// the concurrent pass always runs and only its scheduling depends on
+		// UpdateSyncedProjectilesMT, so projectiles updated in the serial pass
+		// observe the same state on every client regardless of that setting
+		const size_t numProjectiles = pc.size();
+
+		syncedUpdateActions.clear();
+		syncedUpdateActions.resize(numProjectiles, PROJ_UPDATE_SERIAL);
+
+		{
+			SCOPED_TIMER("Sim::Projectiles::UpdateSyncedMT");
+
+			const auto UpdateConcurrently = [&](size_t i) {
+				CProjectile* p = pc[i];
+				assert(p != nullptr);
+
+				if (!p->CanUpdateConcurrently())
+					return;
+
+				MAPPOS_SANITY_CHECK(p->pos);
+				p->UpdateConcurrently();
+				MAPPOS_SANITY_CHECK(p->pos);
+
+				syncedUpdateActions[i] = PROJ_UPDATE_COMMIT;
+			};
+
+			if (updateSyncedMT) {
+				for_mt_chunk(0, numProjectiles, UpdateConcurrently);
+			} else {
+				for (size_t i = 0; i < numProjectiles; ++i) {
+					UpdateConcurrently(i);
+				}
+			}
+		}
 
 		SCOPED_TIMER("Sim::Projectiles::UpdateSyncedST");
+		// projectiles spawned by Update() get appended and are updated here as well
 		for (size_t i = 0; i < pc.size(); ++i) {
 			CProjectile* p = pc[i];
 			assert(p != nullptr);
 
+			if (i < numProjectiles && syncedUpdateActions[i] == PROJ_UPDATE_COMMIT) {
+				quadField.MovedProjectile(p);
+				p->CommitConcurrentUpdate();
+				continue;
+			}
+
 			MAPPOS_SANITY_CHECK(p->pos);
 
 			p->Update();
@@ -422,7 +469,7 @@ static bool CheckProjectileCollisionFlags(const CProjectile* p, const CUnit* u)
 }
 
 
-void CProjectileHandler::CheckUnitCollisions(
+bool CProjectileHandler::CheckUnitCollisions(
 	CProjectile* p,
 	std::vector<CUnit*>& tempUnits,
 	const float3 ppos0,
@@ -430,7 +477,7 @@ void CProjectileHandler::CheckUnitCollisions(
 ) {
 	RECOIL_DETAILED_TRACY_ZONE;
 	if (!p->checkCol)
-		return;
+		return false;
 
 	CollisionQuery cq;
 
@@ -458,12 +505,14 @@ void CProjectileHandler::CheckUnitCollisions(
 				p->Collision(unit);
 			}
 
-			break;
+			return true;
 		}
 	}
+
+	return false;
 }
 
-void CProjectileHandler::CheckFeatureCollisions(
+bool CProjectileHandler::CheckFeatureCollisions(
 	CProjectile* p,
 	std::vector<CFeature*>& tempFeatures,
 	const float3 ppos0,
@@ -472,10 +521,10 @@ void CProjectileHandler::CheckFeatureCollisions(
 	RECOIL_DETAILED_TRACY_ZONE;
 	// already collided with unit?
 	if (!p->checkCol)
-		return;
+		return false;
 
 	if ((p->GetCollisionFlags() & Collision::NOFEATURES) != 0)
-		return;
+		return false;
 
 	CollisionQuery cq;
 
@@ -497,13 +546,15 @@ void CProjectileHandler::CheckFeatureCollisions(
 				p->Collision(feature);
 			}
 
-			break;
+			return true;
 		}
 	}
+
+	return false;
 }
 
 
-void CProjectileHandler::CheckShieldCollisions(
+bool CProjectileHandler::CheckShieldCollisions(
 	CProjectile* p,
 	std::vector<CPlasmaRepulser*>& tempRepulsers,
 	const float3 ppos0,
@@ -511,10 +562,10 @@ void CProjectileHandler::CheckShieldCollisions(
 ) {
 	RECOIL_DETAILED_TRACY_ZONE;
 	if (!p->checkCol)
-		return;
+		return false;
 	// skip unsynced and non-weapon projectiles
 	if (!p->weapon)
-		return;
+		return false;
 
 	CWeaponProjectile* wpro = static_cast<CWeaponProjectile*>(p);
 	const WeaponDef* wdef = wpro->GetWeaponDef();
@@ -524,7 +575,9 @@ void CProjectileHandler::CheckShieldCollisions(
 
 	// bail early
 	if (interceptType == 0)
-		return;
+		return false;
+
+	bool intercepted = false;
 
 	CollisionQuery cq;
 
@@ -552,21 +605,77 @@ void CProjectileHandler::CheckShieldCollisions(
 		if (cq.InsideHit() && repulser->IgnoreInteriorHit(wpro))
 			continue;
 
+		intercepted = true;
+
 		if (repulser->IncomingProjectile(wpro, cq.GetHitPos()))
-			return;
+			break;
 	}
+
+	return intercepted;
+}
+
+// swept-sphere test of the ray p0-p1 against the bounding sphere of o's volume;
+// conservative for every DetectHit variant except piece-trees, whose volumes
+// are not enclosed by the object's own
+static bool MayHitSolidObject(const CSolidObject* o, const float3& p0, const float3& p1)
+{
+	const CollisionVolume* cv = &o->collisionVolume;
+
+	if (cv->DefaultToPieceTree())
+		return true;
+
+	const float3 cvPos = cv->GetWorldSpacePos(o);
+	const float3 rayPos = ClosestPointOnLine(p0, p1, cvPos);
+
+	// small margin to absorb the rounding of the exact tests' transforms
+	return (rayPos.SqDistance(cvPos) <= Square(cv->GetBoundingRadius() + 1.0f));
+}
+
+void CProjectileHandler::GetCollisionCandidates(const CProjectile* p, CollisionCandidates& cc)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	cc.clear();
+
+	if (!p->checkCol || p->deleteMe)
+		return;
+
+	const float3 ppos0 = p->pos;
+	const float3 ppos1 = p->pos + p->speed;
+
+	const auto MayMiss = [&](const CSolidObject* o) { return !MayHitSolidObject(o, ppos0, ppos1); };
+
+	quadField.GetUnitsAndFeaturesColVol(p->pos, p->speed.w + p->radius, cc.units, cc.features, &cc.repulsers);
+
+	// order-preserving, the first hit object in query order wins
+	cc.units.erase(std::remove_if(cc.units.begin(), cc.units.end(), MayMiss), cc.units.end());
+	cc.features.erase(std::remove_if(cc.features.begin(), cc.features.end(), MayMiss), cc.features.end());
 }
 
 void CProjectileHandler::CheckUnitFeatureCollisions(bool synced)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	static std::vector<CUnit*> tempUnits;
-	static std::vector<CFeature*> tempFeatures;
-	static std::vector<CPlasmaRepulser*> tempRepulsers;
+	auto& pc = projectiles[synced];
+
+	// the broad-phase of a projectile only reads state that nothing but the
+	// collision responses below change, so it can run on the thread pool for
+	// all of them up front; once a projectile hits something its response
+	// may have created, moved or removed objects (wrecks, Lua, ...) and the
+	// candidates of the projectiles after it are gathered again, in windows
+	// sized after the distance between the last hits
+	const size_t numProjectiles = pc.size();
+	const bool gatherMT = (updateSyncedMT || !synced);
+
+	if (collisionCandidates.size() < numProjectiles)
+		collisionCandidates.resize(numProjectiles);
+
+	// candidates of [0, gatheredEnd) reflect the current state
+	size_t gatheredEnd = 0;
+	size_t lastHitIdx = 0;
+	size_t hitDistance = numProjectiles;
 
 	//can't use iterators here, because instructions inside the loop modify projectiles[synced]
-	for (size_t i = 0; i < projectiles[synced].size(); ++i) {
-		CProjectile* p = projectiles[synced][i];
+	for (size_t i = 0; i < pc.size(); ++i) {
+		CProjectile* p = pc[i];
 
 		if (!p->checkCol) continue;
 		if ( p->deleteMe) continue;
@@ -575,11 +684,40 @@ void CProjectileHandler::CheckUnitFeatureCollisions(bool synced)
 		const float3 ppos1 = p->pos + p->speed;
 		// const float3 ppos1 = p->pos + p->dir * (p->speed.w + p->radius);
 
-		quadField.GetUnitsAndFeaturesColVol(p->pos, p->speed.w + p->radius, tempUnits, tempFeatures, &tempRepulsers);
+		CollisionCandidates* cc = &liveCollisionCandidates;
+
+		if (gatherMT && i < numProjectiles) {
+			if (i >= gatheredEnd) {
+				SCOPED_TIMER("Sim::Projectiles::CollisionCandidates");
+
+				const size_t gatherBeg = i;
+				const size_t gatherEnd = std::min(numProjectiles, i + std::max(hitDistance * 2, size_t(64)));
+
+				for_mt_chunk(gatherBeg, gatherEnd, [&](const int j) {
+					GetCollisionCandidates(pc[j], collisionCandidates[j]);
+				});
+
+				gatheredEnd = gatherEnd;
+			}
+
+			cc = &collisionCandidates[i];
+		} else {
+			// added by an earlier projectile's collision, or serial
+			GetCollisionCandidates(p, *cc);
+		}
+
+		bool hit = false;
+
+		hit |= CheckShieldCollisions (p, cc->repulsers, ppos0, ppos1);
+		hit |= CheckUnitCollisions   (p, cc->units    , ppos0, ppos1);
+		hit |= CheckFeatureCollisions(p, cc->features , ppos0, ppos1);
+
+		if (!hit)
+			continue;
 
-		CheckShieldCollisions (p, tempRepulsers, ppos0, ppos1); tempRepulsers.clear();
-		CheckUnitCollisions   (p, tempUnits    , ppos0, ppos1); tempUnits.clear();
-		CheckFeatureCollisions(p, tempFeatures , ppos0, ppos1); tempFeatures.clear();
+		hitDistance = i - lastHitIdx;
+		lastHitIdx = i;
+		gatheredEnd = std::min(gatheredEnd, i + 1);
 	}
 }
 
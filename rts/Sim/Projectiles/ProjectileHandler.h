@@ -43,9 +43,10 @@ public:
 		return projectiles[synced];
 	}
 
-	void CheckUnitCollisions(CProjectile*, std::vector<CUnit*>&, const float3, const float3);
-	void CheckFeatureCollisions(CProjectile*, std::vector<CFeature*>&, const float3, const float3);
-	void CheckShieldCollisions(CProjectile*, std::vector<CPlasmaRepulser*>&, const float3, const float3);
+	// true if the projectile hit something and its collision response ran
+	bool CheckUnitCollisions(CProjectile*, std::vector<CUnit*>&, const float3, const float3);
+	bool CheckFeatureCollisions(CProjectile*, std::vector<CFeature*>&, const float3, const float3);
+	bool CheckShieldCollisions(CProjectile*, std::vector<CPlasmaRepulser*>&, const float3, const float3);
 	void CheckUnitFeatureCollisions(bool synced);
 	void CheckGroundCollisions(bool synced);
 	void CheckCollisions();
@@ -95,6 +96,22 @@ public:
 	// unsynced
 	GroundFlashContainer groundFlashes;
 
+private:
+	/// broad-phase result of one projectile for CheckUnitFeatureCollisions, in QuadField query order
+	struct CollisionCandidates {
+		void clear() {
+			units.clear();
+			features.clear();
+			repulsers.clear();
+		}
+
+		std::vector<CUnit*> units;
+		std::vector<CFeature*> features;
+		std::vector<CPlasmaRepulser*> repulsers;
+	};
+
+	static void GetCollisionCandidates(const CProjectile* p, CollisionCandidates& cc);
+
 private:
 	// event-notifiers
 	void CreateProjectile(CProjectile*);
@@ -115,6 +132,21 @@ private:
 	// [1] contains only projectiles that can     change simulation state
 	spring::FreeListMapCompact<CProjectile*, int> projectiles[2];
 
+	enum {
+		PROJ_UPDATE_SERIAL = 0, ///< Update() runs in the serial pass
+		PROJ_UPDATE_COMMIT = 1, ///< UpdateConcurrently() ran, commit in the serial pass
+	};
+
+	///< per-index UpdateProjectilesImpl<true> pass-results, see PROJ_UPDATE_*
+	std::vector<uint8_t> syncedUpdateActions;
+	///< whether the concurrent part of the synced update runs on the thread pool
+	bool updateSyncedMT = true;
+
+	///< per-index candidates gathered on the thread pool by CheckUnitFeatureCollisions
+	std::vector<CollisionCandidates> collisionCandidates;
+	///< candidates of projectiles added during CheckUnitFeatureCollisions, or of all if serial
+	CollisionCandidates liveCollisionCandidates;
+
 	static uint32_t UnsyncedRandInt(uint32_t N);
 	static uint32_t   SyncedRandInt(uint32_t N);
 
@@ -6,7 +6,6 @@
 #include "Map/Ground.h"
 #include "Rendering/GL/RenderBuffers.h"
 #include "Rendering/Textures/TextureAtlas.h"
-#include "Sim/Projectiles/ExplosionGenerator.h"
 #include "Sim/Projectiles/ProjectileHandler.h"
 #include "Sim/Weapons/WeaponDef.h"
 
@@ -55,7 +54,7 @@ void CEmgProjectile::Update()
 		intensity -= 0.1f;
 		intensity = std::max(intensity, 0.0f);
 	} else {
-		explGenHandler.GenExplosion(cegID, pos, speed, ttl, intensity, 0.0f, owner(), nullptr);
+		GenTrailExplosion(cegID, pos, speed, ttl, intensity);
 	}
 
 	UpdateGroundBounce();
@@ -64,6 +63,11 @@ void CEmgProjectile::Update()
 	--ttl;
 }
 
+bool CEmgProjectile::CanUpdateConcurrently() const
+{
+	return (HasLocalUpdate());
+}
+
 void CEmgProjectile::Draw()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -7,7 +7,6 @@
 #include "Rendering/GL/RenderBuffers.h"
 #include "Rendering/Textures/ColorMap.h"
 #include "Rendering/Textures/TextureAtlas.h"
-#include "Sim/Projectiles/ExplosionGenerator.h"
 #include "Sim/Projectiles/ProjectileHandler.h"
 #include "Sim/Weapons/WeaponDef.h"
 
@@ -54,7 +53,7 @@ void CExplosiveProjectile::Update()
 		Collision();
 	} else {
 		if (ttl > 0)
-			explGenHandler.GenExplosion(cegID, pos, speed, ttl, damages->damageAreaOfEffect, 0.0f, owner(), nullptr);
+			GenTrailExplosion(cegID, pos, speed, ttl, damages->damageAreaOfEffect);
 	}
 
 	curTime += invttl;
@@ -69,6 +68,12 @@ void CExplosiveProjectile::Update()
 	UpdateInterception();
 }
 
+bool CExplosiveProjectile::CanUpdateConcurrently() const
+{
+	// ttl running out this frame means exploding
+	return (ttl != 1 && HasLocalUpdate());
+}
+
 void CExplosiveProjectile::Draw()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -15,6 +15,7 @@ public:
 	CExplosiveProjectile(const ProjectileParams& params);
 
 	void Update() override;
+	bool CanUpdateConcurrently() const override;
 	void Draw() override;
 
 	int GetProjectilesCount() const override;
@@ -7,7 +7,6 @@
 #include "Rendering/Env/Particles/Classes/SimpleParticleSystem.h"
 #include "Rendering/GL/RenderBuffers.h"
 #include "Sim/Misc/GlobalConstants.h"
-#include "Sim/Projectiles/ExplosionGenerator.h"
 #include "Sim/Projectiles/ProjectileHandler.h"
 #include "Sim/Weapons/WeaponDef.h"
 
@@ -77,10 +76,15 @@ void CLaserProjectile::Update()
 	deleteMe |= ((intensity <= 0.01f) && (!weaponDef->laserHardStop));
 }
 
+bool CLaserProjectile::CanUpdateConcurrently() const
+{
+	return (HasLocalUpdate());
+}
+
 void CLaserProjectile::UpdateIntensity() {
 	RECOIL_DETAILED_TRACY_ZONE;
 	if (ttl > 0) {
-		explGenHandler.GenExplosion(cegID, pos, speed, ttl, intensity, 0.0f, owner(), nullptr);
+		GenTrailExplosion(cegID, pos, speed, ttl, intensity);
 		return;
 	}
 
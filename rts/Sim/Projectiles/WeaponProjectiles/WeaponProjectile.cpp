@@ -41,6 +41,9 @@ CR_REG_METADATA(CWeaponProjectile,(
 	CR_MEMBER(ttl),
 	CR_MEMBER(bounces),
 	CR_MEMBER(weaponNum),
+	CR_IGNORED(deferredTrailExpl),
+	CR_IGNORED(deferTrailExpl),
+	CR_IGNORED(interceptsProjectile),
 
 	CR_POSTLOAD(PostLoad)
 ))
@@ -123,6 +126,7 @@ CWeaponProjectile::CWeaponProjectile(const ProjectileParams& params)
 		if ((po = dynamic_cast<CWeaponProjectile*>(target)) != nullptr) {
 			po->SetBeingIntercepted(po->IsBeingIntercepted() || weaponDef->interceptSolo);
 			AddDeathDependence(po, DEPENDENCE_INTERCEPTTARGET);
+			interceptsProjectile = true;
 		}
 	}
 
@@ -276,6 +280,49 @@ void CWeaponProjectile::Update()
 	UpdateInterception();
 }
 
+void CWeaponProjectile::UpdateConcurrently()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	deferTrailExpl = true;
+	Update();
+	deferTrailExpl = false;
+}
+
+void CWeaponProjectile::CommitConcurrentUpdate()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!deferredTrailExpl.valid)
+		return;
+
+	const DeferredTrailExplosion& dte = deferredTrailExpl;
+
+	explGenHandler.GenExplosion(dte.expGenID, dte.pos, dte.dir, dte.damage, dte.radius, 0.0f, dte.owner, nullptr);
+	deferredTrailExpl.valid = false;
+}
+
+bool CWeaponProjectile::HasLocalUpdate() const
+{
+	// bounces spawn CEG's and change our path from ground-state, interceptors
+	// collide with (i.e. modify) their target, see UpdateGroundBounce and
+	// UpdateInterception
+	if (weaponDef->groundBounce || weaponDef->waterBounce)
+		return false;
+
+	return !interceptsProjectile;
+}
+
+void CWeaponProjectile::GenTrailExplosion(unsigned int expGenID, const float3& expPos, const float3& expDir, float damage, float radius)
+{
+	if (!deferTrailExpl) {
+		explGenHandler.GenExplosion(expGenID, expPos, expDir, damage, radius, 0.0f, owner(), nullptr);
+		return;
+	}
+
+	// at most one trail CEG per frame
+	assert(!deferredTrailExpl.valid);
+	deferredTrailExpl = {expGenID, expPos, expDir, damage, radius, owner(), true};
+}
+
 void CWeaponProjectile::UpdateWeaponAnimParams()
 {
 	assert(weaponDef);
@@ -412,6 +459,7 @@ void CWeaponProjectile::DependentDied(CObject* o)
 		return;
 
 	target = nullptr;
+	interceptsProjectile = false;
 }
 
 
@@ -420,4 +468,5 @@ void CWeaponProjectile::PostLoad()
 	RECOIL_DETAILED_TRACY_ZONE;
 	assert(weaponDef != nullptr);
 	model = weaponDef->LoadModel();
+	interceptsProjectile = (dynamic_cast<const CWeaponProjectile*>(target) != nullptr);
 }
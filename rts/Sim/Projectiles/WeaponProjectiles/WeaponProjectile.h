@@ -31,6 +31,9 @@ public:
 	void Collision(CUnit* unit) override;
 	void Update() override;
 
+	void UpdateConcurrently() override;
+	void CommitConcurrentUpdate() override;
+
 	void UpdateWeaponAnimParams();
 
 	template <uint32_t texIdx>
@@ -57,6 +60,7 @@ public:
 			targetPos = newTarget->pos;
 
 		target = newTarget;
+		interceptsProjectile = (dynamic_cast<const CWeaponProjectile*>(target) != nullptr);
 	}
 
 	const CWorldObject* GetTargetObject() const { return target; }
@@ -86,6 +90,25 @@ protected:
 	void UpdateInterception();
 	virtual void UpdateGroundBounce();
 
+	/// true if neither bouncing nor intercepting can have side-effects during Update
+	bool HasLocalUpdate() const;
+	/// spawns the trail CEG now, or in CommitConcurrentUpdate if inside UpdateConcurrently
+	void GenTrailExplosion(unsigned int expGenID, const float3& expPos, const float3& expDir, float damage, float radius);
+
+private:
+	struct DeferredTrailExplosion {
+		unsigned int expGenID = 0;
+		float3 pos;
+		float3 dir;
+		float damage = 0.0f;
+		float radius = 0.0f;
+		CUnit* owner = nullptr;
+		bool valid = false;
+	};
+
+	DeferredTrailExplosion deferredTrailExpl;
+	bool deferTrailExpl = false;
+
 protected:
 	const WeaponDef* weaponDef;
 
@@ -100,6 +123,8 @@ protected:
 	// and an interceptor projectile is on the way
 	bool targeted;
 	bool bounced;
+	/// true if target is a CWeaponProjectile, cached for HasLocalUpdate
+	bool interceptsProjectile = false;
 
 	float3 startPos;
 	float3 targetPos;
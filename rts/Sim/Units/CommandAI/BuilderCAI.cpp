@@ -548,6 +548,7 @@ void CBuilderCAI::ReclaimFeature(CFeature* f)
 		StopMoveAndFinishCommand();
 	} else {
 		commandQue.push_front(Command(CMD_RECLAIM, 0, f->id + unitHandler.MaxUnits()));
+		CBuilderCaches::CommandQueueChanged(owner);
 		// this assumes that the reclaim command can never return directly
 		// without having reclaimed the target
 		SlowUpdate();
@@ -912,6 +913,7 @@ void CBuilderCAI::ExecuteGuard(Command& c)
 			Command nc(CMD_REPAIR, c.GetOpts(), b->curBuild->id);
 
 			commandQue.push_front(nc);
+			CBuilderCaches::CommandQueueChanged(owner);
 			inCommand = CMD_STOP;
 			SlowUpdate();
 			return;
@@ -929,6 +931,7 @@ void CBuilderCAI::ExecuteGuard(Command& c)
 			StopSlowGuard();
 
 			commandQue.push_front(Command(CMD_REPAIR, c.GetOpts(), fac->curBuild->id));
+			CBuilderCaches::CommandQueueChanged(owner);
 			inCommand = CMD_STOP;
 			// SlowUpdate();
 			return;
@@ -954,6 +957,7 @@ void CBuilderCAI::ExecuteGuard(Command& c)
 			StopSlowGuard();
 
 			commandQue.push_front(Command(CMD_REPAIR, c.GetOpts(), guardee->id));
+			CBuilderCaches::CommandQueueChanged(owner);
 			inCommand = CMD_STOP;
 			return;
 		}
@@ -1195,6 +1199,7 @@ void CBuilderCAI::ExecutePatrol(Command& c)
 	commandQue.push_back(c);
 	commandQue.pop_front();
 	commandQue.push_front(temp);
+	CBuilderCaches::CommandQueueChanged(owner);
 	Command tmpC(CMD_PATROL);
 	eoh->CommandFinished(*owner, tmpC);
 	SlowUpdate();
@@ -1505,6 +1510,7 @@ bool CBuilderCAI::FindReclaimTargetAndReclaim(const float3& pos, float radius, u
 	Command c(CMD_RECLAIM, cmdopt | INTERNAL_ORDER, rid, pos);
 	c.PushParam(radius);
 	commandQue.push_front(c);
+	CBuilderCaches::CommandQueueChanged(owner);
 	return true;
 }
 
@@ -1548,6 +1554,7 @@ bool CBuilderCAI::FindResurrectableFeatureAndResurrect(
 
 	if (best != nullptr) {
 		commandQue.push_front(Command(CMD_RESURRECT, options | INTERNAL_ORDER, unitHandler.MaxUnits() + best->id));
+		CBuilderCaches::CommandQueueChanged(owner);
 		return true;
 	}
 
@@ -1603,6 +1610,7 @@ bool CBuilderCAI::FindCaptureTargetAndCapture(
 
 	if (best != nullptr) {
 		commandQue.push_front(Command(CMD_CAPTURE, options | INTERNAL_ORDER, best->id));
+		CBuilderCaches::CommandQueueChanged(owner);
 		return true;
 	}
 
@@ -1715,9 +1723,11 @@ bool CBuilderCAI::FindRepairTargetAndRepair(
 		Command c(CMD_REPAIR, options | INTERNAL_ORDER, bestUnit->id, pos);
 		c.PushParam(radius);
 		commandQue.push_front(c);
+		CBuilderCaches::CommandQueueChanged(owner);
 	} else {
 		PushOrUpdateReturnFight(); // attackEnemy must be true
 		commandQue.push_front(Command(CMD_ATTACK, options | INTERNAL_ORDER, bestUnit->id));
+		CBuilderCaches::CommandQueueChanged(owner);
 	}
 
 	return true;
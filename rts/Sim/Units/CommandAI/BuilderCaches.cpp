@@ -4,6 +4,8 @@
 #include "Sim/Units/UnitHandler.h"
 #include "Sim/Units/Unit.h"
 
+#include <algorithm>
+
 // not adding to creg, should repopulate itself
 spring::unordered_set<int> CBuilderCaches::reclaimers;
 spring::unordered_set<int> CBuilderCaches::featureReclaimers;
@@ -11,138 +13,195 @@ spring::unordered_set<int> CBuilderCaches::resurrecters;
 
 std::vector<int> CBuilderCaches::removees;
 
-void CBuilderCaches::InitStatic()
+CBuilderCaches::TargetIndex CBuilderCaches::reclaimeeIndex;
+CBuilderCaches::TargetIndex CBuilderCaches::featureReclaimeeIndex;
+CBuilderCaches::TargetIndex CBuilderCaches::resurrecteeIndex;
+
+
+// target of the builder's front command as filed in each index, false
+// if the front command is not one the index is for
+static bool GetReclaimeeID(const CUnit* builder, int& targetID)
 {
-	spring::clear_unordered_set(reclaimers);
-	spring::clear_unordered_set(featureReclaimers);
-	spring::clear_unordered_set(resurrecters);
+	const CCommandQueue& cq = builder->commandAI->commandQue;
+
+	if (cq.empty())
+		return false;
+
+	const Command& c = cq.front();
+
+	if (c.GetID() != CMD_RECLAIM || (c.GetNumParams() != 1 && c.GetNumParams() != 5))
+		return false;
+
+	targetID = (int)c.GetParam(0);
+	return true;
 }
 
-void CBuilderCaches::AddUnitToReclaimers(CUnit* unit) { reclaimers.insert(unit->id); }
-void CBuilderCaches::RemoveUnitFromReclaimers(CUnit* unit) { reclaimers.erase(unit->id); }
+static bool GetFeatureReclaimeeID(const CUnit* builder, int& targetID)
+{
+	if (!GetReclaimeeID(builder, targetID))
+		return false;
 
-void CBuilderCaches::AddUnitToFeatureReclaimers(CUnit* unit) { featureReclaimers.insert(unit->id); }
-void CBuilderCaches::RemoveUnitFromFeatureReclaimers(CUnit* unit) { featureReclaimers.erase(unit->id); }
+	targetID -= unitHandler.MaxUnits();
+	return true;
+}
 
-void CBuilderCaches::AddUnitToResurrecters(CUnit* unit) { resurrecters.insert(unit->id); }
-void CBuilderCaches::RemoveUnitFromResurrecters(CUnit* unit) { resurrecters.erase(unit->id); }
+static bool GetResurrecteeID(const CUnit* builder, int& targetID)
+{
+	const CCommandQueue& cq = builder->commandAI->commandQue;
 
+	if (cq.empty())
+		return false;
 
-/**
- * Checks if a unit is being reclaimed by a friendly con.
- *
- * We assume that there will not be a lot of reclaimers, because performance
- * would suck if there were. Ideally, reclaimers should be assigned on a
- * per-unit basis, but this requires tracking of deaths, which albeit
- * already done, is not exactly simple to follow.
- *
- * TODO easy: store reclaiming units per allyteam
- * TODO harder: update reclaimers as they start/finish reclaims and/or die
- */
-bool CBuilderCaches::IsUnitBeingReclaimed(const CUnit* unit, const CUnit* friendUnit)
+	const Command& c = cq.front();
+
+	if (c.GetID() != CMD_RESURRECT || c.GetNumParams() != 1)
+		return false;
+
+	targetID = (int)c.GetParam(0) - unitHandler.MaxUnits();
+	return true;
+}
+
+
+void CBuilderCaches::TargetIndex::Clear()
 {
-	bool retval = false;
+	spring::clear_unordered_map(builderTargets);
+	spring::clear_unordered_map(targetBuilders);
+}
 
-	removees.clear();
-	removees.reserve(reclaimers.size());
+void CBuilderCaches::TargetIndex::Insert(int builderID, int targetID)
+{
+	const auto it = builderTargets.find(builderID);
 
-	for (auto it = reclaimers.begin(); it != reclaimers.end(); ++it) {
-		const CUnit* u = unitHandler.GetUnit(*it);
-		const CCommandAI* cai = u->commandAI;
-		const CCommandQueue& cq = cai->commandQue;
+	if (it != builderTargets.end()) {
+		if (it->second == targetID)
+			return;
 
-		if (cq.empty()) {
-			removees.push_back(u->id);
-			continue;
-		}
-		const Command& c = cq.front();
-		if (c.GetID() != CMD_RECLAIM || (c.GetNumParams() != 1 && c.GetNumParams() != 5)) {
-			removees.push_back(u->id);
-			continue;
-		}
-		const int cmdUnitId = (int)c.GetParam(0);
-		if (cmdUnitId == unit->id && (friendUnit == nullptr || teamHandler.Ally(friendUnit->allyteam, u->allyteam))) {
-			retval = true;
-			break;
-		}
+		Erase(builderID);
 	}
 
-	for (auto it = removees.begin(); it != removees.end(); ++it)
-		RemoveUnitFromReclaimers(unitHandler.GetUnit(*it));
-
-	return retval;
+	builderTargets[builderID] = targetID;
+	targetBuilders[targetID].push_back(builderID);
 }
 
+void CBuilderCaches::TargetIndex::Erase(int builderID)
+{
+	const auto it = builderTargets.find(builderID);
 
+	if (it == builderTargets.end())
+		return;
 
-bool CBuilderCaches::IsFeatureBeingReclaimed(int featureId, const CUnit* friendUnit)
+	const int targetID = it->second;
+	std::vector<int>& builders = targetBuilders[targetID];
+
+	builders.erase(std::find(builders.begin(), builders.end(), builderID));
+	builderTargets.erase(builderID);
+
+	if (builders.empty())
+		targetBuilders.erase(targetID);
+}
+
+
+void CBuilderCaches::InitStatic()
 {
-	bool retval = false;
+	spring::clear_unordered_set(reclaimers);
+	spring::clear_unordered_set(featureReclaimers);
+	spring::clear_unordered_set(resurrecters);
 
-	removees.clear();
-	removees.reserve(featureReclaimers.size());
+	reclaimeeIndex.Clear();
+	featureReclaimeeIndex.Clear();
+	resurrecteeIndex.Clear();
+}
 
-	for (auto it = featureReclaimers.begin(); it != featureReclaimers.end(); ++it) {
-		const CUnit* u = unitHandler.GetUnit(*it);
-		const CCommandAI* cai = u->commandAI;
-		const CCommandQueue& cq = cai->commandQue;
+void CBuilderCaches::AddUnitToReclaimers(CUnit* unit) { reclaimers.insert(unit->id); UpdateIndex(reclaimers, reclaimeeIndex, unit, GetReclaimeeID); }
+void CBuilderCaches::RemoveUnitFromReclaimers(CUnit* unit) { reclaimers.erase(unit->id); reclaimeeIndex.Erase(unit->id); }
 
-		if (cq.empty()) {
-			removees.push_back(u->id);
-			continue;
-		}
-		const Command& c = cq.front();
-		if (c.GetID() != CMD_RECLAIM || (c.GetNumParams() != 1 && c.GetNumParams() != 5)) {
-			removees.push_back(u->id);
-			continue;
-		}
-		const int cmdFeatureId = (int)c.GetParam(0);
-		if ((cmdFeatureId - unitHandler.MaxUnits()) == featureId && (friendUnit == nullptr || teamHandler.Ally(friendUnit->allyteam, u->allyteam))) {
-			retval = true;
-			break;
-		}
-	}
+void CBuilderCaches::AddUnitToFeatureReclaimers(CUnit* unit) { featureReclaimers.insert(unit->id); UpdateIndex(featureReclaimers, featureReclaimeeIndex, unit, GetFeatureReclaimeeID); }
+void CBuilderCaches::RemoveUnitFromFeatureReclaimers(CUnit* unit) { featureReclaimers.erase(unit->id); featureReclaimeeIndex.Erase(unit->id); }
 
-	for (auto it = removees.begin(); it != removees.end(); ++it)
-		RemoveUnitFromFeatureReclaimers(unitHandler.GetUnit(*it));
+void CBuilderCaches::AddUnitToResurrecters(CUnit* unit) { resurrecters.insert(unit->id); UpdateIndex(resurrecters, resurrecteeIndex, unit, GetResurrecteeID); }
+void CBuilderCaches::RemoveUnitFromResurrecters(CUnit* unit) { resurrecters.erase(unit->id); resurrecteeIndex.Erase(unit->id); }
 
-	return retval;
+
+void CBuilderCaches::CommandQueueChanged(const CUnit* unit)
+{
+	if (reclaimers.find(unit->id) != reclaimers.end())
+		UpdateIndex(reclaimers, reclaimeeIndex, unit, GetReclaimeeID);
+	if (featureReclaimers.find(unit->id) != featureReclaimers.end())
+		UpdateIndex(featureReclaimers, featureReclaimeeIndex, unit, GetFeatureReclaimeeID);
+	if (resurrecters.find(unit->id) != resurrecters.end())
+		UpdateIndex(resurrecters, resurrecteeIndex, unit, GetResurrecteeID);
 }
 
+void CBuilderCaches::UpdateIndex(spring::unordered_set<int>& builders, TargetIndex& index, const CUnit* unit, GetTargetIDFunc getTargetID)
+{
+	int targetID = 0;
 
-bool CBuilderCaches::IsFeatureBeingResurrected(int featureId, const CUnit* friendUnit)
+	if (getTargetID(unit, targetID)) {
+		index.Insert(unit->id, targetID);
+		return;
+	}
+
+	// no longer working on anything of this kind
+	builders.erase(unit->id);
+	index.Erase(unit->id);
+}
+
+
+/**
+ * Checks if targetID is the target of a builder's front command, where the
+ * builder is allied to friendUnit if given.
+ *
+ * Builders are filed under their target when added and whenever their
+ * command queue changes, so this only has to look at the builders working
+ * on the same target. Their commands are still checked here since a few
+ * places modify the front command in-place; builders found to be filed
+ * under an outdated target are re-filed or dropped.
+ */
+bool CBuilderCaches::IsTargetOfBuilder(spring::unordered_set<int>& builders, TargetIndex& index, int targetID, const CUnit* friendUnit, GetTargetIDFunc getTargetID)
 {
+	const auto it = index.targetBuilders.find(targetID);
+
+	if (it == index.targetBuilders.end())
+		return false;
+
 	bool retval = false;
 
 	removees.clear();
-	removees.reserve(resurrecters.size());
 
-	for (auto it = resurrecters.begin(); it != resurrecters.end(); ++it) {
-		const CUnit* u = unitHandler.GetUnit(*it);
-		const CCommandAI* cai = u->commandAI;
-		const CCommandQueue& cq = cai->commandQue;
+	for (const int builderID: it->second) {
+		const CUnit* u = unitHandler.GetUnit(builderID);
 
-		if (cq.empty()) {
-			removees.push_back(u->id);
-			continue;
-		}
-		const Command& c = cq.front();
-		if (c.GetID() != CMD_RESURRECT || c.GetNumParams() != 1) {
-			removees.push_back(u->id);
+		int curTargetID = 0;
+
+		if (!getTargetID(u, curTargetID) || curTargetID != targetID) {
+			removees.push_back(builderID);
 			continue;
 		}
-		const int cmdFeatureId = (int)c.GetParam(0);
-		if ((cmdFeatureId - unitHandler.MaxUnits()) == featureId && (friendUnit == nullptr || teamHandler.Ally(friendUnit->allyteam, u->allyteam))) {
+
+		if (friendUnit == nullptr || teamHandler.Ally(friendUnit->allyteam, u->allyteam)) {
 			retval = true;
 			break;
 		}
 	}
 
-	for (auto it = removees.begin(); it != removees.end(); ++it)
-		RemoveUnitFromResurrecters(unitHandler.GetUnit(*it));
+	for (const int builderID: removees)
+		UpdateIndex(builders, index, unitHandler.GetUnit(builderID), getTargetID);
 
 	return retval;
 }
 
 
+bool CBuilderCaches::IsUnitBeingReclaimed(const CUnit* unit, const CUnit* friendUnit)
+{
+	return (IsTargetOfBuilder(reclaimers, reclaimeeIndex, unit->id, friendUnit, GetReclaimeeID));
+}
 
+bool CBuilderCaches::IsFeatureBeingReclaimed(int featureId, const CUnit* friendUnit)
+{
+	return (IsTargetOfBuilder(featureReclaimers, featureReclaimeeIndex, featureId, friendUnit, GetFeatureReclaimeeID));
+}
+
+bool CBuilderCaches::IsFeatureBeingResurrected(int featureId, const CUnit* friendUnit)
+{
+	return (IsTargetOfBuilder(resurrecters, resurrecteeIndex, featureId, friendUnit, GetResurrecteeID));
+}
@@ -3,6 +3,7 @@
 #ifndef _BUILDER_CACHES_H_
 #define _BUILDER_CACHES_H_
 
+#include "System/UnorderedMap.hpp"
 #include "System/UnorderedSet.hpp"
 
 #include <vector>
@@ -36,6 +37,32 @@ public:
 	/// fix for patrolling cons reclaiming stuff that is being resurrected
 	static void AddUnitToResurrecters(CUnit*);
 	static void RemoveUnitFromResurrecters(CUnit*);
+
+	/// re-indexes the unit by its new front command if it is in any of the sets above
+	static void CommandQueueChanged(const CUnit*);
+
+private:
+	struct TargetIndex;
+	using GetTargetIDFunc = bool (*)(const CUnit*, int&);
+
+	static void UpdateIndex(spring::unordered_set<int>& builders, TargetIndex& index, const CUnit* unit, GetTargetIDFunc getTargetID);
+	static bool IsTargetOfBuilder(spring::unordered_set<int>& builders, TargetIndex& index, int targetID, const CUnit* friendUnit, GetTargetIDFunc getTargetID);
+
+	/// target ID -> builders whose front command targets it, one per set above
+	struct TargetIndex {
+		void Clear();
+		void Insert(int builderID, int targetID);
+		void Erase(int builderID);
+
+		// builder ID -> target ID it is filed under
+		spring::unordered_map<int, int> builderTargets;
+		// target ID -> builder IDs
+		spring::unordered_map<int, std::vector<int>> targetBuilders;
+	};
+
+	static TargetIndex reclaimeeIndex;
+	static TargetIndex featureReclaimeeIndex;
+	static TargetIndex resurrecteeIndex;
 };
 
 #endif // _BUILDER_CACHES_H_
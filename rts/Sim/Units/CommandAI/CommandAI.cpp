@@ -4,6 +4,7 @@
 #include "CommandAI.h"
 
 #include "BuilderCAI.h"
+#include "BuilderCaches.h"
 #include "FactoryCAI.h"
 #include "ExternalAI/EngineOutHandler.h"
 #include "ExternalAI/SkirmishAIHandler.h"
@@ -826,6 +827,7 @@ void CCommandAI::GiveCommand(const Command& c, int playerNum, bool fromSynced, b
 
 	eventHandler.UnitCommand(owner, c, playerNum, fromSynced, fromLua);
 	GiveCommandReal(c, fromSynced); // send to the sub-classes
+	CBuilderCaches::CommandQueueChanged(owner);
 }
 
 
@@ -1671,6 +1673,7 @@ void CCommandAI::FinishCommand()
 		commandQue.push_back(cmd);
 
 	commandQue.pop_front();
+	CBuilderCaches::CommandQueueChanged(owner);
 
 	inCommand = CMD_STOP;
 	targetDied = false;
@@ -0,0 +1,250 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "CobBytecode.h"
+#include "CobOpcodes.h"
+
+#include <cassert>
+
+namespace CobBytecode {
+
+struct OpInfo {
+	Op op;
+	int numOperands;
+};
+
+static OpInfo GetOpInfo(int opcode)
+{
+	switch (opcode) {
+		case MOVE            : return {OP_MOVE            , 2};
+		case TURN            : return {OP_TURN            , 2};
+		case SPIN            : return {OP_SPIN            , 2};
+		case STOP_SPIN       : return {OP_STOP_SPIN       , 2};
+		case SHOW            : return {OP_SHOW            , 1};
+		case HIDE            : return {OP_HIDE            , 1};
+		case CACHE           : return {OP_NOP             , 1};
+		case DONT_CACHE      : return {OP_NOP             , 1};
+		case MOVE_NOW        : return {OP_MOVE_NOW        , 2};
+		case TURN_NOW        : return {OP_TURN_NOW        , 2};
+		case SHADE           : return {OP_NOP             , 1};
+		case DONT_SHADE      : return {OP_NOP             , 1};
+		case EMIT_SFX        : return {OP_EMIT_SFX        , 1};
+
+		case WAIT_TURN       : return {OP_WAIT_TURN       , 2};
+		case WAIT_MOVE       : return {OP_WAIT_MOVE       , 2};
+		case SLEEP           : return {OP_SLEEP           , 0};
+
+		case PUSH_CONSTANT   : return {OP_PUSH_CONSTANT   , 1};
+		case PUSH_LOCAL_VAR  : return {OP_PUSH_LOCAL_VAR  , 1};
+		case PUSH_STATIC     : return {OP_PUSH_STATIC     , 1};
+		case CREATE_LOCAL_VAR: return {OP_CREATE_LOCAL_VAR, 0};
+		case POP_LOCAL_VAR   : return {OP_POP_LOCAL_VAR   , 1};
+		case POP_STATIC      : return {OP_POP_STATIC      , 1};
+		case POP_STACK       : return {OP_POP_STACK       , 0};
+
+		case ADD             : return {OP_ADD             , 0};
+		case SUB             : return {OP_SUB             , 0};
+		case MUL             : return {OP_MUL             , 0};
+		case DIV             : return {OP_DIV             , 0};
+		case MOD             : return {OP_MOD             , 0};
+		case BITWISE_AND     : return {OP_BITWISE_AND     , 0};
+		case BITWISE_OR      : return {OP_BITWISE_OR      , 0};
+		case BITWISE_XOR     : return {OP_BITWISE_XOR     , 0};
+		case BITWISE_NOT     : return {OP_BITWISE_NOT     , 0};
+
+		case RAND            : return {OP_RAND            , 0};
+		case GET_UNIT_VALUE  : return {OP_GET_UNIT_VALUE  , 0};
+		case GET             : return {OP_GET             , 0};
+
+		case SET_LESS            : return {OP_SET_LESS            , 0};
+		case SET_LESS_OR_EQUAL   : return {OP_SET_LESS_OR_EQUAL   , 0};
+		case SET_GREATER         : return {OP_SET_GREATER         , 0};
+		case SET_GREATER_OR_EQUAL: return {OP_SET_GREATER_OR_EQUAL, 0};
+		case SET_EQUAL           : return {OP_SET_EQUAL           , 0};
+		case SET_NOT_EQUAL       : return {OP_SET_NOT_EQUAL       , 0};
+		case LOGICAL_AND         : return {OP_LOGICAL_AND         , 0};
+		case LOGICAL_OR          : return {OP_LOGICAL_OR          , 0};
+		case LOGICAL_XOR         : return {OP_LOGICAL_XOR         , 0};
+		case LOGICAL_NOT         : return {OP_LOGICAL_NOT         , 0};
+
+		case START           : return {OP_START           , 2};
+		case CALL            : return {OP_REAL_CALL       , 2}; // resolved below
+		case REAL_CALL       : return {OP_REAL_CALL       , 2};
+		case LUA_CALL        : return {OP_LUA_CALL        , 2};
+		case JUMP            : return {OP_JUMP            , 1};
+		case RETURN          : return {OP_RETURN          , 0};
+		case JUMP_NOT_EQUAL  : return {OP_JUMP_NOT_EQUAL  , 1};
+		case SIGNAL          : return {OP_SIGNAL          , 0};
+		case SET_SIGNAL_MASK : return {OP_SET_SIGNAL_MASK , 0};
+
+		case EXPLODE         : return {OP_EXPLODE         , 1};
+		case PLAY_SOUND      : return {OP_PLAY_SOUND      , 1};
+
+		case SET             : return {OP_SET             , 0};
+		case ATTACH          : return {OP_ATTACH          , 0};
+		case DROP            : return {OP_DROP            , 0};
+	}
+
+	return {OP_INVALID, 0};
+}
+
+static Insn MakeInvalid(int pc, int opcode, InvalidReason reason)
+{
+	return {pc + 1, {opcode, reason}, OP_INVALID};
+}
+
+static Insn DecodeSingle(
+	const std::vector<int>& code,
+	const std::vector<std::string>& scriptNames,
+	const std::vector<int>& scriptLengths,
+	int pc
+) {
+	const int numWords = static_cast<int>(code.size());
+	const int opcode = code[pc];
+	const OpInfo info = GetOpInfo(opcode);
+
+	if (info.op == OP_INVALID)
+		return MakeInvalid(pc, opcode, INVALID_OPCODE);
+
+	if ((pc + info.numOperands) >= numWords)
+		return MakeInvalid(pc, opcode, INVALID_OPERANDS);
+
+	Insn insn = {pc + 1 + info.numOperands, {0, 0}, static_cast<uint8_t>(info.op)};
+
+	for (int i = 0; i < info.numOperands; i++) {
+		insn.arg[i] = code[pc + 1 + i];
+	}
+
+	switch (info.op) {
+		case OP_JUMP:
+		case OP_JUMP_NOT_EQUAL: {
+			// every jump lands on a valid entry, so dispatch needs no bounds-checks
+			if (insn.arg[0] < 0 || insn.arg[0] >= numWords)
+				insn.arg[0] = numWords;
+		} break;
+
+		case OP_START:
+		case OP_REAL_CALL: {
+			if (static_cast<size_t>(insn.arg[0]) >= scriptNames.size())
+				return MakeInvalid(pc, opcode, INVALID_FUNCTION);
+
+			// CCobThread::TickInterpreted rewrites CALL on first execution, do it here once
+			if (opcode == CALL && scriptNames[insn.arg[0]].find("lua_") == 0) {
+				insn.op = OP_LUA_CALL;
+				break;
+			}
+
+			// calls to (and starts of) zero-length functions are skipped
+			if (scriptLengths[insn.arg[0]] == 0)
+				insn.op = OP_NOP;
+		} break;
+
+		default: {
+		} break;
+	}
+
+	return insn;
+}
+
+static Op GetFusedOp(uint8_t first, uint8_t second)
+{
+	switch (first) {
+		case OP_PUSH_CONSTANT: {
+			switch (second) {
+				case OP_SLEEP        : return OP_PUSH_CONSTANT_SLEEP;
+				case OP_PUSH_CONSTANT: return OP_PUSH_CONSTANT_PUSH_CONSTANT;
+				default: {} break;
+			}
+		} break;
+		case OP_PUSH_LOCAL_VAR: {
+			if (second == OP_PUSH_CONSTANT)
+				return OP_PUSH_LOCAL_VAR_PUSH_CONSTANT;
+		} break;
+		default: {} break;
+	}
+
+	if (second != OP_JUMP_NOT_EQUAL)
+		return OP_INVALID;
+
+	switch (first) {
+		case OP_SET_LESS            : return OP_SET_LESS_JUMP;
+		case OP_SET_LESS_OR_EQUAL   : return OP_SET_LESS_OR_EQUAL_JUMP;
+		case OP_SET_GREATER         : return OP_SET_GREATER_JUMP;
+		case OP_SET_GREATER_OR_EQUAL: return OP_SET_GREATER_OR_EQUAL_JUMP;
+		case OP_SET_EQUAL           : return OP_SET_EQUAL_JUMP;
+		case OP_SET_NOT_EQUAL       : return OP_SET_NOT_EQUAL_JUMP;
+		default: {} break;
+	}
+
+	return OP_INVALID;
+}
+
+
+void Decode(
+	const std::vector<int>& code,
+	const std::vector<std::string>& scriptNames,
+	const std::vector<int>& scriptLengths,
+	std::vector<Insn>& insns
+) {
+	assert(scriptNames.size() == scriptLengths.size());
+
+	const int numWords = static_cast<int>(code.size());
+
+	insns.clear();
+	insns.reserve(numWords + 1);
+
+	for (int pc = 0; pc < numWords; pc++) {
+		insns.push_back(DecodeSingle(code, scriptNames, scriptLengths, pc));
+	}
+
+	insns.push_back(MakeInvalid(numWords, 0, INVALID_PC));
+	// the sentinel must not fall through to anything
+	insns.back().next = numWords;
+
+	// fuse pairs in ascending order, so insns[first.next] is still unfused;
+	// the second half keeps its own entry for jumps that target it directly
+	for (int pc = 0; pc < numWords; pc++) {
+		Insn& first = insns[pc];
+
+		if (first.op == OP_INVALID || first.next >= numWords)
+			continue;
+
+		const Insn& second = insns[first.next];
+		const Op fusedOp = GetFusedOp(first.op, second.op);
+
+		if (fusedOp == OP_INVALID)
+			continue;
+
+		switch (fusedOp) {
+			case OP_PUSH_CONSTANT_SLEEP: {
+			} break;
+			case OP_PUSH_CONSTANT_PUSH_CONSTANT:
+			case OP_PUSH_LOCAL_VAR_PUSH_CONSTANT: {
+				first.arg[1] = second.arg[0];
+			} break;
+			default: {
+				// SET_* carries no operand, the jump target moves into arg[0]
+				first.arg[0] = second.arg[0];
+			} break;
+		}
+
+		first.op = fusedOp;
+		first.next = second.next;
+	}
+}
+
+
+const char* GetOpName(uint8_t op)
+{
+	#define COB_BYTECODE_NAME(name) #name,
+	static constexpr const char* OP_NAMES[] = {
+		COB_BYTECODE_OPS(COB_BYTECODE_NAME)
+	};
+	#undef COB_BYTECODE_NAME
+
+	if (op >= OP_COUNT)
+		return "UNKNOWN";
+
+	return OP_NAMES[op];
+}
+
+}
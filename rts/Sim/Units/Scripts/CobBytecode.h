@@ -0,0 +1,127 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef COB_BYTECODE_H
+#define COB_BYTECODE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Load-time translation of raw COB code into a stream of pre-decoded
+ * instructions, executed by CCobThread::TickPredecoded.
+ *
+ * Every code word gets its own entry, decoded as if an instruction
+ * started there, so program counters (including those stored in saved
+ * games and call-stacks) index both representations identically and a
+ * jump into the middle of a fused pair simply executes the unfused tail.
+ */
+namespace CobBytecode {
+	// X-macro so the enum and the dispatch table can not get out of sync
+	#define COB_BYTECODE_OPS(X) \
+		X(INVALID)              \
+		X(NOP)                  \
+		X(MOVE)                 \
+		X(TURN)                 \
+		X(SPIN)                 \
+		X(STOP_SPIN)            \
+		X(SHOW)                 \
+		X(HIDE)                 \
+		X(MOVE_NOW)             \
+		X(TURN_NOW)             \
+		X(EMIT_SFX)             \
+		X(WAIT_TURN)            \
+		X(WAIT_MOVE)            \
+		X(SLEEP)                \
+		X(PUSH_CONSTANT)        \
+		X(PUSH_LOCAL_VAR)       \
+		X(PUSH_STATIC)          \
+		X(CREATE_LOCAL_VAR)     \
+		X(POP_LOCAL_VAR)        \
+		X(POP_STATIC)           \
+		X(POP_STACK)            \
+		X(ADD)                  \
+		X(SUB)                  \
+		X(MUL)                  \
+		X(DIV)                  \
+		X(MOD)                  \
+		X(BITWISE_AND)          \
+		X(BITWISE_OR)           \
+		X(BITWISE_XOR)          \
+		X(BITWISE_NOT)          \
+		X(RAND)                 \
+		X(GET_UNIT_VALUE)       \
+		X(GET)                  \
+		X(SET_LESS)             \
+		X(SET_LESS_OR_EQUAL)    \
+		X(SET_GREATER)          \
+		X(SET_GREATER_OR_EQUAL) \
+		X(SET_EQUAL)            \
+		X(SET_NOT_EQUAL)        \
+		X(LOGICAL_AND)          \
+		X(LOGICAL_OR)           \
+		X(LOGICAL_XOR)          \
+		X(LOGICAL_NOT)          \
+		X(START)                \
+		X(REAL_CALL)            \
+		X(LUA_CALL)             \
+		X(JUMP)                 \
+		X(RETURN)               \
+		X(JUMP_NOT_EQUAL)       \
+		X(SIGNAL)               \
+		X(SET_SIGNAL_MASK)      \
+		X(EXPLODE)              \
+		X(PLAY_SOUND)           \
+		X(SET)                  \
+		X(ATTACH)               \
+		X(DROP)                 \
+		/* fused pairs */       \
+		X(PUSH_CONSTANT_SLEEP)  \
+		X(PUSH_CONSTANT_PUSH_CONSTANT)  \
+		X(PUSH_LOCAL_VAR_PUSH_CONSTANT) \
+		/* SET_* + JUMP_NOT_EQUAL */    \
+		X(SET_LESS_JUMP)                \
+		X(SET_LESS_OR_EQUAL_JUMP)       \
+		X(SET_GREATER_JUMP)             \
+		X(SET_GREATER_OR_EQUAL_JUMP)    \
+		X(SET_EQUAL_JUMP)               \
+		X(SET_NOT_EQUAL_JUMP)
+
+	#define COB_BYTECODE_ENUM(name) OP_##name,
+	enum Op: uint8_t {
+		COB_BYTECODE_OPS(COB_BYTECODE_ENUM)
+		OP_COUNT
+	};
+	#undef COB_BYTECODE_ENUM
+
+	// stored in arg[1] of OP_INVALID entries
+	enum InvalidReason {
+		INVALID_OPCODE     = 0,
+		INVALID_OPERANDS   = 1, // operands run past the end of the code
+		INVALID_FUNCTION   = 2, // CALL or START of a nonexistent function
+		INVALID_PC         = 3, // sentinel, jump or entry point outside the code
+	};
+
+	struct Insn {
+		int32_t next;   // pc after this instruction (pair)
+		int32_t arg[2]; // immediate operands, jump targets are bounds-checked
+		uint8_t op;
+	};
+
+	/**
+	 * Decodes <code> into <insns>, which ends up with code.size() + 1 entries;
+	 * the last one is an OP_INVALID sentinel that every out-of-range jump
+	 * target is redirected to. <scriptLengths> and <scriptNames> resolve
+	 * CALL and START targets.
+	 */
+	void Decode(
+		const std::vector<int>& code,
+		const std::vector<std::string>& scriptNames,
+		const std::vector<int>& scriptLengths,
+		std::vector<Insn>& insns
+	);
+
+	const char* GetOpName(uint8_t op);
+}
+
+#endif // COB_BYTECODE_H
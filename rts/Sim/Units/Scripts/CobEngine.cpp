@@ -22,11 +22,24 @@ CR_REG_METADATA(CCobEngine, (
 	CR_IGNORED(curThread),
 
 	CR_MEMBER(currentTime),
-	CR_MEMBER(threadCounter)
+	CR_MEMBER(threadCounter),
+
+	CR_IGNORED(predecodedDispatch)
+))
+
+CR_BIND(CCobSleepQueue, )
+CR_REG_METADATA(CCobSleepQueue, (
+	CR_MEMBER(wheelSlots),
+	CR_MEMBER(farThreads),
+	CR_MEMBER(dueThreads),
+	CR_MEMBER(dueIndex),
+	CR_MEMBER(numThreads),
+	CR_MEMBER(nextSlot),
+	CR_MEMBER(dueTime)
 ))
 
-CR_BIND(CCobEngine::SleepingThread, )
-CR_REG_METADATA(CCobEngine::SleepingThread, (
+CR_BIND(CCobSleepQueue::SleepingThread, )
+CR_REG_METADATA(CCobSleepQueue::SleepingThread, (
 	CR_MEMBER(id),
 	CR_MEMBER(wt)
 ))
@@ -93,7 +106,7 @@ void CCobEngine::ScheduleThread(const CCobThread* thread)
 			waitingThreadIDs.push_back(thread->GetID());
 		} break;
 		case CCobThread::Sleep: {
-			sleepingThreadIDs.push(SleepingThread{thread->GetID(), thread->GetWakeTime()});
+			sleepingThreadIDs.Push(SleepingThread{thread->GetID(), thread->GetWakeTime()});
 		} break;
 		default: {
 			LOG_L(L_ERROR, "[COBEngine::%s] unknown state %d for thread %d", __func__, thread->GetState(), thread->GetID());
@@ -132,21 +145,15 @@ void CCobEngine::TickThread(CCobThread* thread)
 void CCobEngine::WakeSleepingThreads()
 {
 	ZoneScoped;
+	// collect the sleepers whose wake-time has passed, in (time, ID) order
+	sleepingThreadIDs.Advance(currentTime);
+
 	// check on the sleeping threads, remove any whose owner died
-	while (!sleepingThreadIDs.empty()) {
-		CCobThread* zzzThread = GetThread((sleepingThreadIDs.top()).id);
+	while (sleepingThreadIDs.HasDue()) {
+		CCobThread* zzzThread = GetThread((sleepingThreadIDs.PopDue()).id);
 
-		if (zzzThread == nullptr) {
-			sleepingThreadIDs.pop();
+		if (zzzThread == nullptr)
 			continue;
-		}
-
-		// not yet time to execute this thread or any subsequent sleepers
-		if (zzzThread->GetWakeTime() >= currentTime)
-			break;
-
-		// remove executing thread from the queue
-		sleepingThreadIDs.pop();
 
 		// wake up the thread and tick it (if not dead)
 		// this can quite possibly re-add the thread to <sleepingThreadIDs>
@@ -11,8 +11,8 @@
 #include <vector>
 
 #include "CobThread.h"
+#include "CobSleepQueue.h"
 #include "System/creg/creg_cond.h"
-#include "System/creg/STL_Queue.h"
 #include "System/creg/STL_Map.h"
 #include "System/Cpp11Compat.hpp"
 
@@ -26,19 +26,7 @@ class CCobEngine
 	CR_DECLARE_STRUCT(CCobEngine)
 
 public:
-	struct SleepingThread {
-		CR_DECLARE_STRUCT(SleepingThread)
-
-		int id;
-		int wt;
-	};
-
-	struct CCobThreadComp {
-	public:
-		bool operator() (const SleepingThread& a, const SleepingThread& b) const {
-			return a.wt > b.wt || (a.wt == b.wt && a.id > b.id);
-		}
-	};
+	using SleepingThread = CCobSleepQueue::SleepingThread;
 
 public:
 	void Init() {
@@ -48,7 +36,7 @@ public:
 		runningThreadIDs.reserve(512);
 		waitingThreadIDs.reserve(512);
 
-		sleepingThreadIDs = {};
+		sleepingThreadIDs.Clear();
 
 		curThread = nullptr;
 
@@ -64,9 +52,7 @@ public:
 		runningThreadIDs.clear();
 		waitingThreadIDs.clear();
 
-		while (!sleepingThreadIDs.empty()) {
-			sleepingThreadIDs.pop();
-		}
+		sleepingThreadIDs.Clear();
 	}
 
 	void Tick(int deltaTime);
@@ -102,6 +88,9 @@ public:
 	const auto  GetCurrTime() const { return currentTime; }
 	const auto  GetThreadCounter() const { return threadCounter; }
 	const auto  GetCurrCounter() const { return threadCounter; }
+
+	bool UsePredecodedDispatch() const { return predecodedDispatch; }
+	void SetPredecodedDispatch(bool b) { predecodedDispatch = b; }
 private:
 	void TickThread(CCobThread* thread);
 
@@ -121,12 +110,15 @@ private:
 
 	// stores <id, waketime> pairs s.t. after waking up the ID can be checked
 	// for validity; thread owner might get removed while a thread is sleeping
-	std::priority_queue<SleepingThread, std::vector<SleepingThread>, CCobThreadComp> sleepingThreadIDs;
+	CCobSleepQueue sleepingThreadIDs;
 
 	CCobThread* curThread = nullptr;
 
 	int currentTime = 0;
 	int threadCounter = 0;
+
+	// run threads from CCobFile::insns rather than interpreting raw code
+	bool predecodedDispatch = true;
 };
 
 
@@ -8,6 +8,7 @@
 #include <string>
 
 #include "Lua/LuaHashString.h"
+#include "CobBytecode.h"
 #include "CobScriptNames.h"
 #include "System/UnorderedMap.hpp"
 
@@ -23,6 +24,7 @@ public:
 		numStaticVars = f.numStaticVars;
 
 		code = std::move(f.code);
+		insns = std::move(f.insns);
 		scriptNames = std::move(f.scriptNames);
 		scriptOffsets = std::move(f.scriptOffsets);
 
@@ -43,6 +45,8 @@ public:
 	int numStaticVars = 0;
 
 	std::vector<int> code;
+	/// pre-decoded <code>, one entry per code word plus a trailing sentinel
+	std::vector<CobBytecode::Insn> insns;
 	std::vector<std::string> scriptNames;
 	std::vector<int> scriptOffsets;
 	/// Assumes that the scripts are sorted by offset in the file
@@ -0,0 +1,205 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef COB_SLEEP_QUEUE_H
+#define COB_SLEEP_QUEUE_H
+
+#include <algorithm>
+#include <queue>
+#include <vector>
+
+#include "System/creg/creg_cond.h"
+#include "System/creg/STL_Queue.h"
+
+/*
+ * Scheduler for sleeping COB threads: a timing wheel of WHEEL_SIZE slots,
+ * each covering SLOT_WIDTH milliseconds of wake-times, backed by a heap for
+ * sleepers that wake up beyond the wheel's horizon. Inserting a thread that
+ * sleeps for less than the horizon is O(1) regardless of how many others are
+ * asleep; only the threads that become due in a tick ever get sorted.
+ *
+ * Due threads are handed out in (wake-time, ID) order, as they were by the
+ * single heap this replaces, so wakeups stay deterministic. Threads pushed
+ * while due ones are being processed and whose wake-time has already passed
+ * (negative sleeps) join the current batch in that same order.
+ */
+class CCobSleepQueue
+{
+	CR_DECLARE_STRUCT(CCobSleepQueue)
+
+public:
+	struct SleepingThread {
+		CR_DECLARE_STRUCT(SleepingThread)
+
+		int id;
+		int wt;
+	};
+
+	struct CCobThreadComp {
+	public:
+		bool operator() (const SleepingThread& a, const SleepingThread& b) const {
+			return a.wt > b.wt || (a.wt == b.wt && a.id > b.id);
+		}
+	};
+
+	using SleepingThreadHeap = std::priority_queue<SleepingThread, std::vector<SleepingThread>, CCobThreadComp>;
+
+	static constexpr int SLOT_SHIFT = 5;
+	static constexpr int SLOT_WIDTH = 1 << SLOT_SHIFT;
+	static constexpr int WHEEL_SIZE = 2048;
+	static constexpr int WHEEL_MASK = WHEEL_SIZE - 1;
+
+	static_assert((WHEEL_SIZE & WHEEL_MASK) == 0, "WHEEL_SIZE must be a power of two");
+
+public:
+	void Clear() {
+		wheelSlots.clear();
+		wheelSlots.resize(WHEEL_SIZE);
+
+		farThreads = {};
+		dueThreads.clear();
+		dueIndex = 0;
+
+		numThreads = 0;
+		nextSlot = 0;
+		dueTime = 0;
+	}
+
+	void Push(const SleepingThread& st) {
+		if (wheelSlots.empty())
+			wheelSlots.resize(WHEEL_SIZE);
+
+		numThreads += 1;
+
+		if (st.wt < dueTime) {
+			// rare (negative sleeps), keep the remaining batch sorted; zero
+			// sleeps wake up with the next Advance like they did in the heap
+			const auto pos = std::upper_bound(dueThreads.begin() + dueIndex, dueThreads.end(), st, IsEarlier);
+			dueThreads.insert(pos, st);
+			return;
+		}
+
+		// st.wt >= dueTime implies GetSlot(st.wt) >= nextSlot
+		if (GetSlot(st.wt) < (nextSlot + WHEEL_SIZE)) {
+			wheelSlots[GetSlot(st.wt) & WHEEL_MASK].push_back(st);
+			return;
+		}
+
+		farThreads.push(st);
+	}
+
+	/**
+	 * Moves every thread with a wake-time before <time> into the due batch.
+	 * <time> must not decrease between calls.
+	 */
+	void Advance(int time) {
+		if (wheelSlots.empty())
+			wheelSlots.resize(WHEEL_SIZE);
+
+		dueThreads.erase(dueThreads.begin(), dueThreads.begin() + dueIndex);
+		dueIndex = 0;
+
+		const size_t numDue = dueThreads.size();
+
+		// slots before endSlot only contain wake-times before <time>
+		const int endSlot = GetSlot(time);
+		const int numFullSlots = std::min(endSlot - nextSlot, WHEEL_SIZE);
+
+		for (int i = 0; i < numFullSlots; i++) {
+			std::vector<SleepingThread>& slot = wheelSlots[(nextSlot + i) & WHEEL_MASK];
+
+			dueThreads.insert(dueThreads.end(), slot.begin(), slot.end());
+			slot.clear();
+		}
+
+		nextSlot = std::max(nextSlot, endSlot);
+		dueTime = time;
+
+		{
+			// the slot containing <time> is only partially due
+			std::vector<SleepingThread>& slot = wheelSlots[nextSlot & WHEEL_MASK];
+
+			for (size_t i = 0; i < slot.size(); ) {
+				if (slot[i].wt >= time) {
+					i++;
+					continue;
+				}
+
+				dueThreads.push_back(slot[i]);
+				slot[i] = slot.back();
+				slot.pop_back();
+			}
+		}
+
+		// pull sleepers that came within the horizon into the wheel
+		while (!farThreads.empty() && GetSlot(farThreads.top().wt) < (nextSlot + WHEEL_SIZE)) {
+			const SleepingThread st = farThreads.top();
+
+			farThreads.pop();
+
+			if (st.wt < time) {
+				dueThreads.push_back(st);
+			} else {
+				wheelSlots[GetSlot(st.wt) & WHEEL_MASK].push_back(st);
+			}
+		}
+
+		// leftovers from an unfinished batch are still sorted
+		std::sort(dueThreads.begin() + numDue, dueThreads.end(), IsEarlier);
+		std::inplace_merge(dueThreads.begin(), dueThreads.begin() + numDue, dueThreads.end(), IsEarlier);
+	}
+
+	bool HasDue() const { return (dueIndex < static_cast<int>(dueThreads.size())); }
+
+	SleepingThread PopDue() {
+		numThreads -= 1;
+		return dueThreads[dueIndex++];
+	}
+
+	// all sleeping threads in wakeup order, for sync dumps
+	std::vector<SleepingThread> GetSortedThreads() const {
+		std::vector<SleepingThread> threads;
+		threads.reserve(numThreads);
+
+		for (const auto& slot: wheelSlots) {
+			threads.insert(threads.end(), slot.begin(), slot.end());
+		}
+
+		for (SleepingThreadHeap heap = farThreads; !heap.empty(); heap.pop()) {
+			threads.push_back(heap.top());
+		}
+
+		threads.insert(threads.end(), dueThreads.begin() + dueIndex, dueThreads.end());
+		std::sort(threads.begin(), threads.end(), IsEarlier);
+
+		return threads;
+	}
+
+	int size() const { return numThreads; }
+	bool empty() const { return (numThreads == 0); }
+
+private:
+	// arithmetic shift, so negative wake-times map to slots before zero
+	static int GetSlot(int time) { return (time >> SLOT_SHIFT); }
+
+	static bool IsEarlier(const SleepingThread& a, const SleepingThread& b) { return CCobThreadComp()(b, a); }
+
+private:
+	// threads waking up within WHEEL_SIZE slots of nextSlot
+	std::vector< std::vector<SleepingThread> > wheelSlots;
+	// threads waking up beyond that
+	SleepingThreadHeap farThreads;
+	// threads whose wake-time lies before dueTime, sorted; the
+	// first dueIndex entries have already been handed out
+	std::vector<SleepingThread> dueThreads;
+
+	int dueIndex = 0;
+
+	int numThreads = 0;
+
+	// first slot of the wheel that has not been (completely) drained
+	int nextSlot = 0;
+	// time passed to the last Advance call
+	int dueTime = 0;
+};
+
+#endif // COB_SLEEP_QUEUE_H
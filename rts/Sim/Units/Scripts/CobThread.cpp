@@ -2,9 +2,11 @@
 
 
 #include "CobThread.h"
+#include "CobBytecode.h"
 #include "CobFile.h"
 #include "CobInstance.h"
 #include "CobEngine.h"
+#include "CobOpcodes.h"
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/GlobalSynced.h"
 
@@ -226,86 +228,6 @@ void CCobThread::InitStack(unsigned int n, CCobThread* t)
 
 
 
-// Command documentation from http://visualta.tauniverse.com/Downloads/cob-commands.txt
-// And some information from basm0.8 source (basm ops.txt)
-
-// Model interaction
-static constexpr int MOVE       = 0x10001000;
-static constexpr int TURN       = 0x10002000;
-static constexpr int SPIN       = 0x10003000;
-static constexpr int STOP_SPIN  = 0x10004000;
-static constexpr int SHOW       = 0x10005000;
-static constexpr int HIDE       = 0x10006000;
-static constexpr int CACHE      = 0x10007000;
-static constexpr int DONT_CACHE = 0x10008000;
-static constexpr int MOVE_NOW   = 0x1000B000;
-static constexpr int TURN_NOW   = 0x1000C000;
-static constexpr int SHADE      = 0x1000D000;
-static constexpr int DONT_SHADE = 0x1000E000;
-static constexpr int EMIT_SFX   = 0x1000F000;
-
-// Blocking operations
-static constexpr int WAIT_TURN  = 0x10011000;
-static constexpr int WAIT_MOVE  = 0x10012000;
-static constexpr int SLEEP      = 0x10013000;
-
-// Stack manipulation
-static constexpr int PUSH_CONSTANT    = 0x10021001;
-static constexpr int PUSH_LOCAL_VAR   = 0x10021002;
-static constexpr int PUSH_STATIC      = 0x10021004;
-static constexpr int CREATE_LOCAL_VAR = 0x10022000;
-static constexpr int POP_LOCAL_VAR    = 0x10023002;
-static constexpr int POP_STATIC       = 0x10023004;
-static constexpr int POP_STACK        = 0x10024000; ///< Not sure what this is supposed to do
-
-// Arithmetic operations
-static constexpr int ADD         = 0x10031000;
-static constexpr int SUB         = 0x10032000;
-static constexpr int MUL         = 0x10033000;
-static constexpr int DIV         = 0x10034000;
-static constexpr int MOD		  = 0x10034001; ///< spring specific
-static constexpr int BITWISE_AND = 0x10035000;
-static constexpr int BITWISE_OR  = 0x10036000;
-static constexpr int BITWISE_XOR = 0x10037000;
-static constexpr int BITWISE_NOT = 0x10038000;
-
-// Native function calls
-static constexpr int RAND           = 0x10041000;
-static constexpr int GET_UNIT_VALUE = 0x10042000;
-static constexpr int GET            = 0x10043000;
-
-// Comparison
-static constexpr int SET_LESS             = 0x10051000;
-static constexpr int SET_LESS_OR_EQUAL    = 0x10052000;
-static constexpr int SET_GREATER          = 0x10053000;
-static constexpr int SET_GREATER_OR_EQUAL = 0x10054000;
-static constexpr int SET_EQUAL            = 0x10055000;
-static constexpr int SET_NOT_EQUAL        = 0x10056000;
-static constexpr int LOGICAL_AND          = 0x10057000;
-static constexpr int LOGICAL_OR           = 0x10058000;
-static constexpr int LOGICAL_XOR          = 0x10059000;
-static constexpr int LOGICAL_NOT          = 0x1005A000;
-
-// Flow control
-static constexpr int START           = 0x10061000;
-static constexpr int CALL            = 0x10062000; ///< converted when executed
-static constexpr int REAL_CALL       = 0x10062001; ///< spring custom
-static constexpr int LUA_CALL        = 0x10062002; ///< spring custom
-static constexpr int JUMP            = 0x10064000;
-static constexpr int RETURN          = 0x10065000;
-static constexpr int JUMP_NOT_EQUAL  = 0x10066000;
-static constexpr int SIGNAL          = 0x10067000;
-static constexpr int SET_SIGNAL_MASK = 0x10068000;
-
-// Piece destruction
-static constexpr int EXPLODE    = 0x10071000;
-static constexpr int PLAY_SOUND = 0x10072000;
-
-// Special functions
-static constexpr int SET    = 0x10082000;
-static constexpr int ATTACH = 0x10083000;
-static constexpr int DROP   = 0x10084000;
-
 // Indices for SET, GET, and GET_UNIT_VALUE for LUA return values
 static constexpr int LUA0 = 110; // (LUA0 returns the lua call status, 0 or 1)
 static constexpr int LUA1 = 111;
@@ -416,6 +338,14 @@ bool CCobThread::Tick()
 
 	state = Run;
 
+	if (cobEngine->UsePredecodedDispatch() && !cobFile->insns.empty())
+		return (TickPredecoded());
+
+	return (TickInterpreted());
+}
+
+bool CCobThread::TickInterpreted()
+{
 	int r1, r2, r3, r4, r5, r6;
 
 	while (state == Run) {
@@ -895,6 +825,499 @@ bool CCobThread::Tick()
 	return (state != Dead);
 }
 
+bool CCobThread::TickPredecoded()
+{
+	using namespace CobBytecode;
+
+	const Insn* insns = cobFile->insns.data();
+	const Insn* insn = nullptr;
+
+	// index of the OP_INVALID sentinel that out-of-range jumps were redirected to
+	const int sentinelPC = static_cast<int>(cobFile->insns.size()) - 1;
+	const auto ClampPC = [&](int newPC) { return ((static_cast<unsigned int>(newPC) > static_cast<unsigned int>(sentinelPC))? sentinelPC: newPC); };
+
+	int r1, r2, r3;
+
+	// entry points and return addresses are the only unchecked sources of pc
+	pc = ClampPC(pc);
+
+#if defined(__GNUC__)
+	// direct-threaded dispatch through the labels-as-values extension
+	#define COB_OP_LABEL(name) &&OP_LABEL_##name,
+	static const void* const DISPATCH_TABLE[] = {
+		COB_BYTECODE_OPS(COB_OP_LABEL)
+	};
+	#undef COB_OP_LABEL
+
+	#define COB_OP(name) OP_LABEL_##name:
+	#define COB_NEXT()                           \
+		do {                                     \
+			if (state != Run)                    \
+				goto done;                       \
+			insn = &insns[pc];                   \
+			pc = insn->next;                     \
+			goto *DISPATCH_TABLE[insn->op];      \
+		} while (false)
+
+	COB_NEXT();
+#else
+	#define COB_OP(name) case OP_##name:
+	#define COB_NEXT() continue
+
+	while (state == Run) {
+		insn = &insns[pc];
+		pc = insn->next;
+
+		switch (insn->op) {
+#endif
+
+	COB_OP(INVALID) {
+		static constexpr const char* INVALID_REASONS[] = {"unknown opcode", "truncated instruction", "invalid function index", "invalid jump target"};
+
+		const char* name = cobFile->name.c_str();
+		const char* func = cobFile->scriptNames[LocalFunctionID()].c_str();
+		const char* desc = INVALID_REASONS[insn->arg[1]];
+
+		LOG_L(L_ERROR, "[COBThread::%s] %s %x (in %s:%s at %x)", __func__, desc, insn->arg[0], name, func, static_cast<int>(insn - insns));
+
+		state = Dead;
+		return false;
+	}
+	COB_OP(NOP) {
+	} COB_NEXT();
+
+	COB_OP(PUSH_CONSTANT) {
+		PushDataStack(insn->arg[0]);
+	} COB_NEXT();
+	COB_OP(SLEEP) {
+		r1 = PopDataStack();
+		wakeTime = cobEngine->GetCurrTime() + r1;
+		state = Sleep;
+
+		cobEngine->ScheduleThread(this);
+		return true;
+	}
+	COB_OP(SPIN) {
+		r1 = PopDataStack(); // speed
+		r2 = PopDataStack(); // accel
+		cobInst->Spin(insn->arg[0], insn->arg[1], r1, r2);
+	} COB_NEXT();
+	COB_OP(STOP_SPIN) {
+		r1 = PopDataStack(); // decel
+		cobInst->StopSpin(insn->arg[0], insn->arg[1], r1);
+	} COB_NEXT();
+	COB_OP(RETURN) {
+		retCode = PopDataStack();
+
+		if (LocalReturnAddr() == -1) {
+			state = Dead;
+
+			// leave values intact on stack in case caller wants to check them
+			return false;
+		}
+
+		// return to caller
+		pc = ClampPC(LocalReturnAddr());
+		if (dataStack.size() > LocalStackFrame())
+			dataStack.resize(LocalStackFrame());
+
+		callStack.pop_back();
+	} COB_NEXT();
+
+
+	COB_OP(REAL_CALL) {
+		CallInfo& ci = PushCallStackRef();
+		ci.functionId = insn->arg[0];
+		ci.returnAddr = pc;
+		ci.stackTop = dataStack.size() - insn->arg[1];
+
+		paramCount = insn->arg[1];
+
+		// call cobFile->scriptNames[arg[0]]
+		pc = ClampPC(cobFile->scriptOffsets[insn->arg[0]]);
+	} COB_NEXT();
+	COB_OP(LUA_CALL) {
+		LuaCall(insn->arg[0], insn->arg[1]);
+	} COB_NEXT();
+
+
+	COB_OP(POP_STATIC) {
+		r1 = PopDataStack();
+
+		if (static_cast<size_t>(insn->arg[0]) < cobInst->staticVars.size())
+			cobInst->staticVars[insn->arg[0]] = r1;
+	} COB_NEXT();
+	COB_OP(POP_STACK) {
+		PopDataStack();
+	} COB_NEXT();
+
+
+	COB_OP(START) {
+		CCobThread t(cobInst);
+
+		t.SetID(cobEngine->GenThreadID());
+		t.InitStack(insn->arg[1], this);
+		t.Start(insn->arg[0], signalMask, {{0}}, true);
+
+		// calling AddThread directly might move <this>, defer it
+		cobEngine->QueueAddThread(std::move(t));
+	} COB_NEXT();
+
+	COB_OP(CREATE_LOCAL_VAR) {
+		if (paramCount == 0) {
+			PushDataStack(0);
+		} else {
+			paramCount--;
+		}
+	} COB_NEXT();
+	COB_OP(GET_UNIT_VALUE) {
+		r1 = PopDataStack();
+
+		if ((r1 >= LUA0) && (r1 <= LUA9)) {
+			PushDataStack(luaArgs[r1 - LUA0]);
+		} else {
+			PushDataStack(cobInst->GetUnitVal(r1, 0, 0, 0, 0));
+		}
+	} COB_NEXT();
+
+
+	COB_OP(JUMP_NOT_EQUAL) {
+		if (PopDataStack() == 0)
+			pc = insn->arg[0];
+	} COB_NEXT();
+	COB_OP(JUMP) {
+		pc = insn->arg[0];
+	} COB_NEXT();
+
+
+	COB_OP(POP_LOCAL_VAR) {
+		r1 = PopDataStack();
+		dataStack[LocalStackFrame() + insn->arg[0]] = r1;
+	} COB_NEXT();
+	COB_OP(PUSH_LOCAL_VAR) {
+		PushDataStack(dataStack[LocalStackFrame() + insn->arg[0]]);
+	} COB_NEXT();
+
+
+	COB_OP(BITWISE_AND) {
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+		PushDataStack(r1 & r2);
+	} COB_NEXT();
+	COB_OP(BITWISE_OR) {
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+		PushDataStack(r1 | r2);
+	} COB_NEXT();
+	COB_OP(BITWISE_XOR) {
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+		PushDataStack(r1 ^ r2);
+	} COB_NEXT();
+	COB_OP(BITWISE_NOT) {
+		r1 = PopDataStack();
+		PushDataStack(~r1);
+	} COB_NEXT();
+
+	COB_OP(EXPLODE) {
+		r1 = PopDataStack();
+		cobInst->Explode(insn->arg[0], r1);
+	} COB_NEXT();
+	COB_OP(PLAY_SOUND) {
+		r1 = PopDataStack();
+		cobInst->PlayUnitSound(insn->arg[0], r1);
+	} COB_NEXT();
+
+	COB_OP(PUSH_STATIC) {
+		if (static_cast<size_t>(insn->arg[0]) < cobInst->staticVars.size())
+			PushDataStack(cobInst->staticVars[insn->arg[0]]);
+	} COB_NEXT();
+
+	COB_OP(SET_NOT_EQUAL) {
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+		PushDataStack(int(r1 != r2));
+	} COB_NEXT();
+	COB_OP(SET_EQUAL) {
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+		PushDataStack(int(r1 == r2));
+	} COB_NEXT();
+	COB_OP(SET_LESS) {
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		PushDataStack(int(r1 < r2));
+	} COB_NEXT();
+	COB_OP(SET_LESS_OR_EQUAL) {
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		PushDataStack(int(r1 <= r2));
+	} COB_NEXT();
+	COB_OP(SET_GREATER) {
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		PushDataStack(int(r1 > r2));
+	} COB_NEXT();
+	COB_OP(SET_GREATER_OR_EQUAL) {
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		PushDataStack(int(r1 >= r2));
+	} COB_NEXT();
+
+	COB_OP(RAND) {
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		r3 = gsRNG.NextInt(r2 - r1 + 1) + r1;
+		PushDataStack(r3);
+	} COB_NEXT();
+	COB_OP(EMIT_SFX) {
+		r1 = PopDataStack();
+		cobInst->EmitSfx(r1, insn->arg[0]);
+	} COB_NEXT();
+	COB_OP(MUL) {
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+		PushDataStack(r1 * r2);
+	} COB_NEXT();
+
+
+	COB_OP(SIGNAL) {
+		r1 = PopDataStack();
+		cobInst->Signal(r1);
+	} COB_NEXT();
+	COB_OP(SET_SIGNAL_MASK) {
+		signalMask = PopDataStack();
+	} COB_NEXT();
+
+
+	COB_OP(TURN) {
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		cobInst->Turn(insn->arg[0], insn->arg[1], r1, r2);
+	} COB_NEXT();
+	COB_OP(GET) {
+		int args[5];
+
+		// popped last to first
+		for (int i = 4; i >= 0; i--) {
+			args[i] = PopDataStack();
+		}
+
+		if ((args[0] >= LUA0) && (args[0] <= LUA9)) {
+			PushDataStack(luaArgs[args[0] - LUA0]);
+		} else {
+			PushDataStack(cobInst->GetUnitVal(args[0], args[1], args[2], args[3], args[4]));
+		}
+	} COB_NEXT();
+	COB_OP(ADD) {
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		PushDataStack(r1 + r2);
+	} COB_NEXT();
+	COB_OP(SUB) {
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		PushDataStack(r1 - r2);
+	} COB_NEXT();
+
+	COB_OP(DIV) {
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+
+		if (r2 != 0) {
+			r3 = r1 / r2;
+		} else {
+			r3 = 1000; // infinity!
+			ShowError("division by zero");
+		}
+		PushDataStack(r3);
+	} COB_NEXT();
+	COB_OP(MOD) {
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+
+		if (r2 != 0) {
+			PushDataStack(r1 % r2);
+		} else {
+			PushDataStack(0);
+			ShowError("modulo division by zero");
+		}
+	} COB_NEXT();
+
+	COB_OP(MOVE) {
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		cobInst->Move(insn->arg[0], insn->arg[1], r1, r2);
+	} COB_NEXT();
+	COB_OP(MOVE_NOW) {
+		r1 = PopDataStack();
+		cobInst->MoveNow(insn->arg[0], insn->arg[1], r1);
+	} COB_NEXT();
+	COB_OP(TURN_NOW) {
+		r1 = PopDataStack();
+		cobInst->TurnNow(insn->arg[0], insn->arg[1], r1);
+	} COB_NEXT();
+
+
+	COB_OP(WAIT_TURN) {
+		if (cobInst->NeedsWait(CCobInstance::ATurn, insn->arg[0], insn->arg[1])) {
+			state = WaitTurn;
+			waitPiece = insn->arg[0];
+			waitAxis = insn->arg[1];
+			return true;
+		}
+	} COB_NEXT();
+	COB_OP(WAIT_MOVE) {
+		if (cobInst->NeedsWait(CCobInstance::AMove, insn->arg[0], insn->arg[1])) {
+			state = WaitMove;
+			waitPiece = insn->arg[0];
+			waitAxis = insn->arg[1];
+			return true;
+		}
+	} COB_NEXT();
+
+
+	COB_OP(SET) {
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+
+		if ((r1 >= LUA0) && (r1 <= LUA9)) {
+			luaArgs[r1 - LUA0] = r2;
+		} else {
+			cobInst->SetUnitVal(r1, r2);
+		}
+	} COB_NEXT();
+
+
+	COB_OP(ATTACH) {
+		r3 = PopDataStack();
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		cobInst->AttachUnit(r2, r1);
+	} COB_NEXT();
+	COB_OP(DROP) {
+		r1 = PopDataStack();
+		cobInst->DropUnit(r1);
+	} COB_NEXT();
+
+	// like bitwise ops, but only on values 1 and 0
+	COB_OP(LOGICAL_NOT) {
+		r1 = PopDataStack();
+		PushDataStack(int(r1 == 0));
+	} COB_NEXT();
+	COB_OP(LOGICAL_AND) {
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+		PushDataStack(int(r1 && r2));
+	} COB_NEXT();
+	COB_OP(LOGICAL_OR) {
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+		PushDataStack(int(r1 || r2));
+	} COB_NEXT();
+	COB_OP(LOGICAL_XOR) {
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+		PushDataStack(int((!!r1) ^ (!!r2)));
+	} COB_NEXT();
+
+
+	COB_OP(HIDE) {
+		cobInst->SetVisibility(insn->arg[0], false);
+	} COB_NEXT();
+	COB_OP(SHOW) {
+		int i;
+		for (i = 0; i < MAX_WEAPONS_PER_UNIT; ++i)
+			if (LocalFunctionID() == cobFile->scriptIndex[COBFN_FirePrimary + COBFN_Weapon_Funcs * i])
+				break;
+
+		// if true, we are in a Fire-script and should show a special flare effect
+		if (i < MAX_WEAPONS_PER_UNIT) {
+			cobInst->ShowFlare(insn->arg[0]);
+		} else {
+			cobInst->SetVisibility(insn->arg[0], true);
+		}
+	} COB_NEXT();
+
+
+	// fused pairs, see CobBytecode::Decode
+	COB_OP(PUSH_CONSTANT_SLEEP) {
+		wakeTime = cobEngine->GetCurrTime() + insn->arg[0];
+		state = Sleep;
+
+		cobEngine->ScheduleThread(this);
+		return true;
+	}
+	COB_OP(PUSH_CONSTANT_PUSH_CONSTANT) {
+		PushDataStack(insn->arg[0]);
+		PushDataStack(insn->arg[1]);
+	} COB_NEXT();
+	COB_OP(PUSH_LOCAL_VAR_PUSH_CONSTANT) {
+		PushDataStack(dataStack[LocalStackFrame() + insn->arg[0]]);
+		PushDataStack(insn->arg[1]);
+	} COB_NEXT();
+
+	COB_OP(SET_LESS_JUMP) {
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+
+		if (!(r1 < r2))
+			pc = insn->arg[0];
+	} COB_NEXT();
+	COB_OP(SET_LESS_OR_EQUAL_JUMP) {
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+
+		if (!(r1 <= r2))
+			pc = insn->arg[0];
+	} COB_NEXT();
+	COB_OP(SET_GREATER_JUMP) {
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+
+		if (!(r1 > r2))
+			pc = insn->arg[0];
+	} COB_NEXT();
+	COB_OP(SET_GREATER_OR_EQUAL_JUMP) {
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+
+		if (!(r1 >= r2))
+			pc = insn->arg[0];
+	} COB_NEXT();
+	COB_OP(SET_EQUAL_JUMP) {
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+
+		if (!(r1 == r2))
+			pc = insn->arg[0];
+	} COB_NEXT();
+	COB_OP(SET_NOT_EQUAL_JUMP) {
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+
+		if (!(r1 != r2))
+			pc = insn->arg[0];
+	} COB_NEXT();
+
+#if !defined(__GNUC__)
+			case OP_COUNT: {
+				assert(false);
+			} break;
+		}
+	}
+#endif
+
+	#undef COB_NEXT
+	#undef COB_OP
+
+#if defined(__GNUC__)
+done:
+#endif
+	// can arrive here as dead, through CCobInstance::Signal()
+	return (state != Dead);
+}
+
 void CCobThread::ShowError(const char* msg)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -919,6 +1342,11 @@ void CCobThread::LuaCall()
 	const int r1 = GET_LONG_PC(); // script id
 	const int r2 = GET_LONG_PC(); // arg count
 
+	LuaCall(r1, r2);
+}
+
+void CCobThread::LuaCall(int r1, int r2)
+{
 	// setup the parameter array
 	const int size = static_cast<int>(dataStack.size());
 	const int argCount = std::min(r2, MAX_LUA_COB_ARGS);
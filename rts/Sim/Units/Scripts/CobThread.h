@@ -105,7 +105,11 @@ protected:
 		int stackTop = -1;
 	};
 
+	bool TickInterpreted();
+	bool TickPredecoded();
+
 	void LuaCall();
+	void LuaCall(int scriptId, int argCount);
 
 	void PushCallStack(CallInfo v) { callStack.push_back(v); }
 	void PushDataStack(int v) { dataStack.push_back(v); }
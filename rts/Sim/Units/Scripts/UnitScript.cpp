@@ -57,6 +57,7 @@ CR_REG_METADATA(CUnitScript, (
 	CR_MEMBER(busy),
 	CR_MEMBER(anims),
 	CR_MEMBER(doneAnims),
+	CR_MEMBER(animatingSlot),
 
 	//Populated by children
 	CR_IGNORED(pieces),
@@ -90,7 +91,7 @@ CUnitScript::CUnitScript(CUnit* unit)
 CUnitScript::~CUnitScript()
 {
 	// Remove us from possible animation ticking
-	if (!HaveAnimations())
+	if (animatingSlot < 0)
 		return;
 
 	unitScriptEngine->RemoveInstance(this);
@@ -174,8 +175,9 @@ bool CUnitScript::DoSpin(float& cur, float dest, float& speed, float accel, int
 /**
  * @brief The multithreaded first half of the original CUnitScript::Tick function first does the heavy lifting of calculating all
 			  new piece positions according to the animations
+ * @return true if TickAnimFinished has work to do, i.e. listeners to unblock or no animations left
 */
-void CUnitScript::TickAllAnims(int deltaTime)
+bool CUnitScript::TickAllAnims(int deltaTime)
 {
 	ZoneScoped;
 
@@ -184,6 +186,8 @@ void CUnitScript::TickAllAnims(int deltaTime)
 
 	const int tickRate = 1000 / deltaTime;
 
+	bool haveDoneAnims = false;
+
 	for (int animType = ATurn; animType <= AMove; animType++) {
 		auto& currAnims = anims[animType];
 		const auto& currFunc = TICK_ANIM_FUNCS[animType];
@@ -204,7 +208,11 @@ void CUnitScript::TickAllAnims(int deltaTime)
 
 			++i;
 		}
+
+		haveDoneAnims |= !currDoneAnims.empty();
 	}
+
+	return (haveDoneAnims || !HaveAnimations());
 }
 
 /**
@@ -19,6 +19,8 @@ class CUnitScript
 {
 	CR_DECLARE(CUnitScript)
 	CR_DECLARE_SUB(AnimInfo)
+
+	friend class CUnitScriptEngine;
 public:
 	enum AnimType {ANone = -1, ATurn = 0, ASpin = 1, AMove = 2};
 
@@ -45,6 +47,9 @@ protected:
 	std::array<AnimContainerType, AMove + 1> anims;
 	std::array<AnimContainerType, AMove + 1> doneAnims;
 
+	// index into CUnitScriptEngine::animating, -1 if not registered there
+	int animatingSlot = -1;
+
 	bool hasSetSFXOccupy;
 	bool hasRockUnit;
 	bool hasStartBuilding;
@@ -106,7 +111,7 @@ public:
 	      CUnit* GetUnit()       { return unit; }
 	const CUnit* GetUnit() const { return unit; }
 
-	void TickAllAnims(int tickRate);
+	bool TickAllAnims(int tickRate);
 	bool TickAnimFinished(int tickRate);
 	// note: must copy-and-set here (LMP dirty flag, etc)
 	bool TickMoveAnim(int tickRate, LocalModelPiece& lmp, AnimInfo& ai) { float3 pos = lmp.GetPosition(); const bool ret = MoveToward(pos[ai.axis], ai.dest, ai.speed / tickRate); lmp.SetPosition(pos); return ret; }
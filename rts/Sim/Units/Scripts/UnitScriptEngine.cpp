@@ -18,6 +18,7 @@
 #include "System/Misc/TracyDefs.h"
 
 CONFIG(bool, AnimationMT).deprecated(true);
+CONFIG(bool, CobPredecodedDispatch).defaultValue(true).description("Run COB scripts from an instruction list decoded once when the script is loaded, instead of decoding the raw bytecode every time a thread executes it. Both forms run the same instructions with the same operands.");
 
 static CCobEngine gCobEngine;
 static CCobFileHandler gCobFileHandler;
@@ -34,7 +35,9 @@ CR_REG_METADATA(CUnitScriptEngine, (
 	CR_MEMBER(animating),
 
 	// always null when saving
-	CR_IGNORED(currentScript)
+	CR_IGNORED(currentScript),
+	CR_IGNORED(animFinishedFlags),
+	CR_IGNORED(animFinishedScripts)
 ))
 
 
@@ -45,6 +48,7 @@ void CUnitScriptEngine::InitStatic() {
 	unitScriptEngine = &gUnitScriptEngine;
 
 	cobEngine->Init();
+	cobEngine->SetPredecodedDispatch(configHandler->GetBool("CobPredecodedDispatch"));
 	cobFileHandler->Init();
 	unitScriptEngine->Init();
 }
@@ -105,13 +109,15 @@ void CUnitScriptEngine::ReloadScripts(const UnitDef* udef)
 }
 
 
+int& CUnitScriptEngine::AnimatingSlot(CUnitScript* script) { return script->animatingSlot; }
+
 void CUnitScriptEngine::AddInstance(CUnitScript* instance)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	if (instance == currentScript)
 		return;
 
-	spring::VectorInsertUnique(animating, instance/*, true*/);
+	spring::VectorInsertSlotted(animating, instance, AnimatingSlot);
 }
 
 void CUnitScriptEngine::RemoveInstance(CUnitScript* instance)
@@ -120,7 +126,7 @@ void CUnitScriptEngine::RemoveInstance(CUnitScript* instance)
 	if (instance == currentScript)
 		return;
 
-	spring::VectorErase(animating, instance);
+	spring::VectorEraseSlotted(animating, instance, AnimatingSlot);
 }
 
 void CUnitScriptEngine::Tick(int deltaTime)
@@ -133,24 +139,38 @@ void CUnitScriptEngine::Tick(int deltaTime)
 	{
 		ZoneScopedN("CUnitScriptEngine::Tick(MT)");
 
+		animFinishedFlags.resize(animating.size());
+
 		// setting currentScript = animating[i]; is not required here, only in ST section below
 		for_mt(0, animating.size(), [&](const int i) {
-			animating[i]->TickAllAnims(deltaTime);
+			animFinishedFlags[i] = animating[i]->TickAllAnims(deltaTime);
 		});
 	}
 	{
 		ZoneScopedN("CUnitScriptEngine::Tick(ST)");
-		for (size_t i = 0; i < animating.size(); ) {
-			currentScript = animating[i];
 
-			if (!currentScript->TickAnimFinished(deltaTime)) {
-				animating[i] = animating.back();
-				animating.pop_back();
-				continue;
+		// only scripts with listeners to unblock or without animations left need
+		// the serial pass; collect them first since AnimFinished callbacks can add
+		// and remove other scripts which reorders <animating>
+		animFinishedScripts.clear();
+
+		for (size_t i = 0; i < animating.size(); i++) {
+			if (animFinishedFlags[i] != 0)
+				animFinishedScripts.push_back(animating[i]);
+		}
+
+		for (CUnitScript* script: animFinishedScripts) {
+			currentScript = script;
+
+			// Add/RemoveInstance ignore currentScript, settle its membership here;
+			// it may even have been removed by an earlier script's AnimFinished
+			if (script->TickAnimFinished(deltaTime)) {
+				spring::VectorInsertSlotted(animating, script, AnimatingSlot);
+			} else {
+				spring::VectorEraseSlotted(animating, script, AnimatingSlot);
 			}
-			i++;
 		}
 	}
 
 	currentScript = nullptr;
-}
\ No newline at end of file
+}
@@ -5,6 +5,7 @@
 #ifndef UNIT_SCRIPT_ENGINE_H
 #define UNIT_SCRIPT_ENGINE_H
 
+#include <cstdint>
 #include <vector>
 
 #include "System/creg/creg_cond.h"
@@ -26,14 +27,26 @@ public:
 	void Tick(int deltaTime);
 
 	void Init() { animating.reserve(256); }
-	void Kill() { animating.clear(); }
+	void Kill() {
+		animating.clear();
+		animFinishedFlags.clear();
+		animFinishedScripts.clear();
+	}
 
 	static void InitStatic();
 	static void KillStatic();
+private:
+	static int& AnimatingSlot(CUnitScript* script);
+
 private:
 	CUnitScript* currentScript = nullptr;
 
+	// each script knows its own index here (CUnitScript::animatingSlot)
 	std::vector<CUnitScript*> animating;
+
+	// scratch for Tick, marks the scripts that TickAnimFinished must visit
+	std::vector<std::uint8_t> animFinishedFlags;
+	std::vector<CUnitScript*> animFinishedScripts;
 };
 
 extern CUnitScriptEngine* unitScriptEngine;
@@ -1317,7 +1317,9 @@ void CUnit::DoDamage(
 	ApplyDamage(attacker, damages, baseDamage, experienceMod);
 
 	{
-		eventHandler.UnitDamaged(this, attacker, baseDamage, weaponDefID, projectileID, isParalyzer);
+		// called for every hit; the batched call-in also needs the event
+		if (eventHandler.HasSubscribers(CEventHandler::EVENT_UnitDamaged) || eventHandler.HasSubscribers(CEventHandler::EVENT_UnitDamagedBatch))
+			eventHandler.UnitDamaged(this, attacker, baseDamage, weaponDefID, projectileID, isParalyzer);
 
 		// unit might have been killed via Lua from within UnitDamaged (e.g.
 		// through a recursive DoDamage call from AddUnitDamage or directly
@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <bit>
 #include <cassert>
 
 #include "UnitHandler.h"
@@ -11,8 +12,10 @@
 #include "UnitTypes/Factory.h"
 
 #include "CommandAI/BuilderCAI.h"
+#include "Game/GameHelper.h"
 #include "Sim/Ecs/Registry.h"
 #include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/ModInfo.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/MoveTypes/MoveType.h"
@@ -36,6 +39,8 @@
 #include "System/Config/ConfigHandler.h"
 CONFIG(bool, UpdateWeaponVectorsMT).deprecated(true);
 CONFIG(bool, UpdateBoundingVolumeMT).deprecated(true);
+CONFIG(bool, UpdateUnitsMT).defaultValue(true).description("Run CUnit::Update for self-contained units on worker threads instead of the main thread. Self-contained units update before the others either way, so clients with different settings stay in sync.");
+CONFIG(bool, UpdateUnitLosStatesMT).defaultValue(true).description("Evaluate the per-allyteam LOS states of units on worker threads; the resulting Entered/Left call-ins are still dispatched serially in unit order.");
 
 
 CR_BIND(CUnitHandler, )
@@ -55,7 +60,12 @@ CR_REG_METADATA(CUnitHandler, (
 	CR_MEMBER(maxUnits),
 	CR_MEMBER(maxUnitRadius),
 
-	CR_MEMBER(inUpdateCall)
+	CR_MEMBER(inUpdateCall),
+
+	CR_IGNORED(unitUpdateActions),
+	CR_IGNORED(unitLosChangeMasks),
+	CR_IGNORED(updateUnitsMT),
+	CR_IGNORED(updateUnitLosStatesMT)
 ))
 
 
@@ -113,6 +123,9 @@ void CUnitHandler::Init() {
 	{
 		activeSlowUpdateUnit = 0;
 		activeUpdateUnit = 0;
+
+		updateUnitsMT = configHandler->GetBool("UpdateUnitsMT");
+		updateUnitLosStatesMT = configHandler->GetBool("UpdateUnitLosStatesMT");
 	}
 	{
 		units.resize(maxUnits, nullptr);
@@ -335,12 +348,59 @@ void CUnitHandler::UpdateUnitMoveTypes()
 	UnitTrapCheckSystem::Update();
 }
 
+void CUnitHandler::FindUnitLosChanges(size_t unitIdx, size_t numWords)
+{
+	CUnit* unit = activeUnits[unitIdx];
+	uint64_t* mask = &unitLosChangeMasks[unitIdx * numWords];
+
+	for (int at = 0, n = teamHandler.ActiveAllyTeams(); at < n; ++at) {
+		const unsigned short currStatus = unit->losStatus[at];
+
+		// all changes are masked, nothing to dispatch
+		if ((currStatus & LOS_ALL_MASK_BITS) == LOS_ALL_MASK_BITS)
+			continue;
+		if (unit->CalcLosStatus(at) == currStatus)
+			continue;
+
+		mask[at / 64] |= (uint64_t(1) << (at % 64));
+	}
+}
+
 void CUnitHandler::UpdateUnitLosStates()
 {
 	ZoneScopedC(tracy::Color::Goldenrod);
-	for (CUnit* unit: activeUnits) {
-		for (int at = 0; at < teamHandler.ActiveAllyTeams(); ++at) {
-			unit->UpdateLosStatus(at);
+
+	const size_t activeUnitCount = activeUnits.size();
+	const size_t numWords = (teamHandler.ActiveAllyTeams() + 63) / 64;
+
+	// one bit per (unit, allyteam) whose status would change this frame;
+	// CalcLosStatus only reads the LOS maps and unit state, so finding the
+	// changes is safe to spread over the pool while the (call-in emitting)
+	// SetLosStatus part below stays serial and in the same unit/allyteam
+	// order on every client regardless of UpdateUnitLosStatesMT
+	unitLosChangeMasks.clear();
+	unitLosChangeMasks.resize(activeUnitCount * numWords, 0);
+
+	if (updateUnitLosStatesMT) {
+		for_mt_chunk(0, activeUnitCount, [this, numWords](const int i) {
+			FindUnitLosChanges(i, numWords);
+		});
+	} else {
+		for (size_t i = 0; i < activeUnitCount; ++i) {
+			FindUnitLosChanges(i, numWords);
+		}
+	}
+
+	for (size_t i = 0; i < activeUnitCount; ++i) {
+		CUnit* unit = activeUnits[i];
+
+		for (size_t w = 0; w < numWords; ++w) {
+			for (uint64_t bits = unitLosChangeMasks[i * numWords + w]; bits != 0; bits &= (bits - 1)) {
+				// recalculated since call-ins dispatched for earlier units may have
+				// altered this one (e.g. its LOS mask); those that did not flag the
+				// unit above are picked up on the next frame
+				unit->UpdateLosStatus(w * 64 + std::countr_zero(bits));
+			}
 		}
 	}
 }
@@ -367,6 +427,9 @@ void CUnitHandler::SlowUpdateUnits()
 
 	static std::vector<CUnit*> updateBoundingVolumeList;
 	updateBoundingVolumeList.clear();
+
+	// weapon target candidates are gathered up front, AutoTarget only scores them
+	helper->BeginWeaponTargetsBatch(activeUnits, idxBeg, idxEnd);
 	{
 		ZoneScopedN("Sim::Unit::SlowUpdateST");
 		for (size_t i = idxBeg; i < idxEnd; ++i) {
@@ -381,6 +444,7 @@ void CUnitHandler::SlowUpdateUnits()
 				updateBoundingVolumeList.emplace_back(unit);
 		}
 	}
+	helper->EndWeaponTargetsBatch();
 	// Since the bounding volumes are calculated from the maximum piecematrix-offset piece vertices
 	// They dont have much of an effect if updated late-ish.
 	{
@@ -391,22 +455,86 @@ void CUnitHandler::SlowUpdateUnits()
 	}
 }
 
+static bool CanUpdateUnitConcurrently(const CUnit* unit)
+{
+	const UnitDef* ud = unit->unitDef;
+
+	// builders and factories do their build-work in Update, which touches
+	// other units, team resources and the event system (see NewUnit)
+	if (ud->IsFactoryUnit() || ud->IsMobileBuilderUnit() || ud->IsStaticBuilderUnit())
+		return false;
+
+	// transports write into their transportees (UpdateTransportees); both
+	// sides must keep their relative serial order
+	return (unit->transportedUnits.empty() && unit->GetTransporter() == nullptr);
+}
+
+void CUnitHandler::UpdateUnit(CUnit* unit)
+{
+	unit->SanityCheck();
+	unit->Update();
+	unit->moveType->UpdateCollisionMap();
+	// unsynced; done on-demand when drawing unit
+	// unit->UpdateLocalModel();
+	unit->SanityCheck();
+}
+
+void CUnitHandler::UpdateUnitConcurrently(size_t unitIdx)
+{
+	CUnit* unit = activeUnits[unitIdx];
+
+	if (!CanUpdateUnitConcurrently(unit))
+		return;
+
+	unit->SanityCheck();
+	unit->Update();
+	unit->SanityCheck();
+
+	unitUpdateActions[unitIdx] = unit->moveType->UpdateCollisionPos()? UNIT_UPDATE_MOVED: UNIT_UPDATE_DONE;
+}
+
 void CUnitHandler::UpdateUnits()
 {
 	SCOPED_TIMER("Sim::Unit::Update");
 
-	size_t activeUnitCount = activeUnits.size();
-	for (size_t i = 0; i < activeUnitCount; ++i) {
-		CUnit* unit = activeUnits[i];
+	const size_t activeUnitCount = activeUnits.size();
+
+	// one slot per active unit, written only by the thread owning that index;
+	// the commit pass below walks them in activeUnits order, which is the order
+	// the serial path would have touched the QuadField in
+	//
+	// self-contained units are always updated before the serial ones, also when
+	// UpdateUnitsMT is disabled, so the serial units observe the same state on
+	// every client regardless of that setting
+	unitUpdateActions.clear();
+	unitUpdateActions.resize(activeUnitCount, UNIT_UPDATE_SERIAL);
+
+	{
+		ZoneScopedN("Sim::Unit::UpdateMT");
+
+		if (updateUnitsMT) {
+			for_mt_chunk(0, activeUnitCount, [this](const int i) {
+				UpdateUnitConcurrently(i);
+			});
+		} else {
+			for (size_t i = 0; i < activeUnitCount; ++i) {
+				UpdateUnitConcurrently(i);
+			}
+		}
+	}
+	{
+		ZoneScopedN("Sim::Unit::UpdateST");
+		for (size_t i = 0; i < activeUnitCount; ++i) {
+			CUnit* unit = activeUnits[i];
 
-		unit->SanityCheck();
-		unit->Update();
-		unit->moveType->UpdateCollisionMap();
-		// unsynced; done on-demand when drawing unit
-		// unit->UpdateLocalModel();
-		unit->SanityCheck();
+			switch (unitUpdateActions[i]) {
+				case UNIT_UPDATE_SERIAL: { UpdateUnit(unit);         } break;
+				case UNIT_UPDATE_MOVED : { quadField.MovedUnit(unit); } break;
+				default                : {                            } break;
+			}
 
-		assert(activeUnits[i] == unit);
+			assert(activeUnits[i] == unit);
+		}
 	}
 }
 
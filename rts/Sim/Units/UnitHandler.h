@@ -83,7 +83,10 @@ private:
 	void SlowUpdateUnits();
 	void UpdateUnitPathing(const size_t idxBeg, const size_t idxEnd);
 	void UpdateUnitMoveTypes();
+	void FindUnitLosChanges(size_t unitIdx, size_t numWords);
 	void UpdateUnitLosStates();
+	void UpdateUnit(CUnit* unit);
+	void UpdateUnitConcurrently(size_t unitIdx);
 	void UpdateUnits();
 	void UpdateUnitWeapons();
 
@@ -116,6 +119,22 @@ private:
 	float maxUnitRadius = 0.0f;
 
 	bool inUpdateCall = false;
+
+	enum {
+		UNIT_UPDATE_SERIAL = 0, ///< unit was skipped by the MT pass, run it in the commit pass
+		UNIT_UPDATE_DONE   = 1, ///< updated by the MT pass, nothing left to commit
+		UNIT_UPDATE_MOVED  = 2, ///< updated by the MT pass, QuadField move pending
+	};
+
+	///< per-activeUnits-index result of the MT pass of UpdateUnits
+	std::vector<uint8_t> unitUpdateActions;
+	///< per-activeUnits-index bitsets of the allyteams whose LOS status changes this frame
+	std::vector<uint64_t> unitLosChangeMasks;
+
+	///< whether UpdateUnits runs self-contained units on the thread pool
+	bool updateUnitsMT = true;
+	///< whether UpdateUnitLosStates looks for changes on the thread pool
+	bool updateUnitLosStatesMT = true;
 };
 
 extern CUnitHandler unitHandler;
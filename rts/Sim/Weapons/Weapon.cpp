@@ -281,14 +281,20 @@ void CWeapon::UpdateWeaponVectors()
 	relAimFromPos = owner->script->GetPiecePos(aimFromPiece);
 	owner->script->GetEmitDirPos(muzzlePiece, relWeaponMuzzlePos, weaponDir);
 
-	aimFromPos = owner->GetObjectSpacePos(relAimFromPos);
+	aimFromPos = CalcAimFromPos(relAimFromPos);
 	weaponMuzzlePos = owner->GetObjectSpacePos(relWeaponMuzzlePos);
 	weaponDir = owner->GetObjectSpaceVec(weaponDir).SafeNormalize();
+}
+
+float3 CWeapon::CalcAimFromPos(const float3& relPos) const
+{
+	const float3 pos = owner->GetObjectSpacePos(relPos);
 
 	// hope that we are underground because we are a popup weapon and will come above ground later
-	if (aimFromPos.y < CGround::GetHeightReal(aimFromPos.x, aimFromPos.z)) {
-		aimFromPos = owner->pos + UpVector * 10;
-	}
+	if (pos.y < CGround::GetHeightReal(pos.x, pos.z))
+		return (owner->pos + UpVector * 10);
+
+	return pos;
 }
 
 
@@ -705,6 +711,35 @@ bool CWeapon::AllowWeaponAutoTarget() const
 	return (gs->frameNum > (lastTargetRetry + 65));
 }
 
+// Lua- and script-free superset of AllowWeaponAutoTarget, used to decide up
+// front which weapons get their targets gathered in a batch (see
+// CGameHelper::BeginWeaponTargetsBatch); anything it misses is generated on
+// demand by AutoTarget
+bool CWeapon::MayAutoTarget() const
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (weaponDef->noAutoTarget || noAutoTarget)
+		return false;
+	if (owner->fireState < FIRESTATE_FIREATWILL)
+		return false;
+	if (slavedTo != nullptr)
+		return false;
+	if (weaponDef->interceptor)
+		return false;
+
+	if (!HaveTarget())
+		return true;
+	if (avoidTarget)
+		return true;
+	if (currentTarget.isUserTarget)
+		return false;
+
+	if (HaveUnitTarget() && (currentTarget.unit->category & badTargetCategory))
+		return true;
+
+	return (gs->frameNum > (lastTargetRetry + 65));
+}
+
 bool CWeapon::AutoTarget()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -83,6 +83,7 @@ public:
 	virtual void UpdateRange(const float val) { range = val; }
 
 	bool AutoTarget();
+	bool MayAutoTarget() const;
 	void AimReady(const int value);
 	void Fire(const bool scriptCall);
 
@@ -98,6 +99,8 @@ public:
 	bool IsFastAutoRetargetingEnabled() const { return fastAutoRetargeting; }
 	void UpdateWeaponErrorVector();
 	void UpdateWeaponVectors();
+	/// aimFromPos for the given aim-from piece position, without changing the weapon
+	float3 CalcAimFromPos(const float3& relPos) const;
 
 protected:
 	virtual void FireImpl(const bool scriptCall) {}
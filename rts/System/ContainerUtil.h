@@ -48,6 +48,40 @@ namespace spring {
 		return true;
 	}
 
+	// constant-time variants of VectorInsertUnique and VectorErase for elements
+	// that remember their own index into <v>; slot(e) must return a reference
+	// to that int, which has to be -1 whenever e is not contained in <v>
+	template<typename T, typename SlotFunc>
+	static bool VectorInsertSlotted(std::vector<T>& v, T e, SlotFunc&& slot)
+	{
+		if (slot(e) >= 0)
+			return false;
+
+		slot(e) = static_cast<int>(v.size());
+		v.push_back(std::move(e));
+		return true;
+	}
+
+	template<typename T, typename SlotFunc>
+	static bool VectorEraseSlotted(std::vector<T>& v, T e, SlotFunc&& slot)
+	{
+		const int idx = slot(e);
+
+		if (idx < 0)
+			return false;
+
+		assert(static_cast<size_t>(idx) < v.size() && v[idx] == e);
+
+		v[idx] = std::move(v.back());
+		v.pop_back();
+
+		if (static_cast<size_t>(idx) < v.size())
+			slot(v[idx]) = idx;
+
+		slot(e) = -1;
+		return true;
+	}
+
 	template<typename T, typename C>
 	VUS static bool VectorEraseUniqueSorted(std::vector<T>& v, const T& e, const C& c)
 	{
@@ -49,6 +49,30 @@ enum DbgTimingInfoType {
 };
 
 
+/**
+ * One UnitDamaged event as delivered by UnitDamagedBatch, after the frame
+ * in which it happened. The units involved may have been deleted by then,
+ * so everything the call-in reports about them is captured when queued.
+ */
+struct UnitDamagedEvent {
+	int unitID;
+	int unitDefID;
+	int unitTeam;
+	int unitAllyTeam;
+	int attackerID; ///< -1 if none
+	int attackerDefID;
+	int attackerDecoyDefID; ///< what enemies see, attackerDefID if not a decoy
+	int attackerTeam;
+	int attackerAllyTeam;
+	/// offset of the attacker's per-allyteam LOS states, see CEventHandler::GetUnitDamagedAttackerLosStatus
+	unsigned int attackerLosIdx;
+	int weaponDefID;
+	int projectileID;
+	float damage;
+	bool paralyzer;
+};
+
+
 class CEventClient
 {
 	public:
@@ -143,6 +167,8 @@ class CEventClient
 			int weaponDefID,
 			int projectileID,
 			bool paralyzer) {}
+		/// all UnitDamaged events of a sim frame readable by this client, delivered before GameFramePost
+		virtual void UnitDamagedBatch(const std::vector<UnitDamagedEvent>& events) {}
 		virtual void UnitStunned(const CUnit* unit, bool stunned) {}
 		virtual void UnitExperience(const CUnit* unit, float oldExperience) {}
 		virtual void UnitHarvestStorageFull(const CUnit* unit) {}
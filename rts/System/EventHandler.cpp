@@ -5,6 +5,8 @@
 #include "Lua/LuaCallInCheck.h"
 #include "Lua/LuaOpenGL.h"  // FIXME -- should be moved
 
+#include "Sim/Misc/TeamHandler.h"
+#include "Sim/Units/UnitDef.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/Platform/Threading.h"
 #include "System/GlobalConfig.h"
@@ -17,10 +19,10 @@ CEventHandler eventHandler;
 /******************************************************************************/
 /******************************************************************************/
 
-void CEventHandler::SetupEvent(const std::string& eName, EventClientList* list, int props)
+void CEventHandler::SetupEvent(const std::string& eName, EventClientList* list, int props, int id)
 {
 	assert(std::find_if(eventMap.cbegin(), eventMap.cend(), [&](const EventPair& p) { return (p.first == eName); }) == eventMap.cend());
-	eventMap.push_back({eName, EventInfo(eName, list, props)});
+	eventMap.push_back({eName, EventInfo(eName, list, props, id)});
 }
 
 /******************************************************************************/
@@ -40,13 +42,16 @@ void CEventHandler::ResetState()
 	handles.clear();
 	handles.reserve(16);
 
+	subscribedEvents.reset();
+	unitDamagedBatch.clear();
+
 	SetupEvents();
 }
 
 void CEventHandler::SetupEvents()
 {
-	#define SETUP_EVENT(name, props) SetupEvent(#name, &list ## name, props);
-	#define SETUP_UNMANAGED_EVENT(name, props) SetupEvent(#name, NULL, props);
+	#define SETUP_EVENT(name, props) SetupEvent(#name, &list ## name, props, EVENT_ ## name);
+	#define SETUP_UNMANAGED_EVENT(name, props) SetupEvent(#name, NULL, props, -1);
 		#include "Events.def"
 	#undef SETUP_UNMANAGED_EVENT
 	#undef SETUP_EVENT
@@ -154,6 +159,7 @@ bool CEventHandler::InsertEvent(CEventClient* ec, const std::string& ciName)
 		return false;
 
 	ListInsert(*iter->second.GetList(), ec);
+	subscribedEvents.set(iter->second.GetID());
 	return true;
 }
 
@@ -167,6 +173,7 @@ bool CEventHandler::RemoveEvent(CEventClient* ec, const std::string& ciName)
 		return false;
 
 	ListRemove(*(iter->second.GetList()), ec);
+	subscribedEvents.set(iter->second.GetID(), !iter->second.GetList()->empty());
 	return true;
 }
 
@@ -558,9 +565,90 @@ void CEventHandler::GameFrame(int gameFrame)
 void CEventHandler::GameFramePost(int gameFrame)
 {
 	ZoneScoped;
+	FlushUnitDamagedBatch();
 	ITERATE_EVENTCLIENTLIST(GameFramePost, gameFrame);
 }
 
+void CEventHandler::QueueUnitDamaged(
+	const CUnit* unit,
+	const CUnit* attacker,
+	float damage,
+	int weaponDefID,
+	int projectileID,
+	bool paralyzer
+) {
+	if (attacker == nullptr) {
+		unitDamagedBatch.push_back({
+			unit->id,
+			unit->unitDef->id,
+			unit->team,
+			unit->allyteam,
+			-1, -1, -1, -1, -1, 0,
+			weaponDefID,
+			projectileID,
+			damage,
+			paralyzer
+		});
+		return;
+	}
+
+	const UnitDef* attackerDef = attacker->unitDef;
+	const unsigned int attackerLosIdx = unitDamagedLosStatus.size();
+
+	// the attacker may be gone or have changed LOS state by the time of the flush
+	unitDamagedLosStatus.insert(unitDamagedLosStatus.end(), attacker->losStatus.begin(), attacker->losStatus.begin() + teamHandler.ActiveAllyTeams());
+	unitDamagedBatch.push_back({
+		unit->id,
+		unit->unitDef->id,
+		unit->team,
+		unit->allyteam,
+		attacker->id,
+		attackerDef->id,
+		(attackerDef->decoyDef != nullptr)? attackerDef->decoyDef->id: attackerDef->id,
+		attacker->team,
+		attacker->allyteam,
+		attackerLosIdx,
+		weaponDefID,
+		projectileID,
+		damage,
+		paralyzer
+	});
+}
+
+void CEventHandler::FlushUnitDamagedBatch()
+{
+	if (unitDamagedBatch.empty())
+		return;
+
+	// call-ins may cause more damage, which goes into the next batch
+	std::swap(unitDamagedBatch, unitDamagedBatchFlush);
+	std::swap(unitDamagedLosStatus, unitDamagedLosStatusFlush);
+
+	for (size_t i = 0; i < listUnitDamagedBatch.size(); ) {
+		CEventClient* ec = listUnitDamagedBatch[i];
+
+		if (ec->GetFullRead()) {
+			ec->UnitDamagedBatch(unitDamagedBatchFlush);
+		} else {
+			unitDamagedBatchVisible.clear();
+
+			for (const UnitDamagedEvent& e: unitDamagedBatchFlush) {
+				if (ec->CanReadAllyTeam(e.unitAllyTeam))
+					unitDamagedBatchVisible.push_back(e);
+			}
+
+			if (!unitDamagedBatchVisible.empty())
+				ec->UnitDamagedBatch(unitDamagedBatchVisible);
+		}
+
+		/* the call-in may remove itself from the list */
+		i += (i < listUnitDamagedBatch.size() && ec == listUnitDamagedBatch[i]);
+	}
+
+	unitDamagedBatchFlush.clear();
+	unitDamagedLosStatusFlush.clear();
+}
+
 void CEventHandler::GameProgress(int gameFrame)
 {
 	ZoneScoped;
@@ -3,6 +3,7 @@
 #ifndef EVENT_HANDLER_H
 #define EVENT_HANDLER_H
 
+#include <bitset>
 #include <string>
 #include <vector>
 
@@ -40,6 +41,28 @@ class CEventHandler
 		bool IsUnsynced(const std::string& ciName) const;
 		bool IsController(const std::string& ciName) const;
 
+	public:
+		enum EventID {
+		#define SETUP_EVENT(name, props) EVENT_ ## name,
+		#define SETUP_UNMANAGED_EVENT(name, props)
+			#include "Events.def"
+		#undef SETUP_EVENT
+		#undef SETUP_UNMANAGED_EVENT
+			EVENT_COUNT
+		};
+
+		/**
+		 * Whether any client receives a managed event; callers can check this
+		 * before doing any work to gather the event's arguments.
+		 */
+		bool HasSubscribers(EventID id) const { return subscribedEvents[id]; }
+
+		/**
+		 * The attacker's CUnit::losStatus, per active allyteam, as it was when
+		 * the event was queued; only valid during the UnitDamagedBatch call-in.
+		 */
+		const uint8_t* GetUnitDamagedAttackerLosStatus(const UnitDamagedEvent& e) const { return &unitDamagedLosStatusFlush[e.attackerLosIdx]; }
+
 
 	public:
 		/**
@@ -326,20 +349,22 @@ class CEventHandler
 
 		class EventInfo {
 			public:
-				EventInfo() : list(NULL), propBits(0) {}
-				EventInfo(const std::string& _name, EventClientList* _list, int _bits)
-				: name(_name), list(_list), propBits(_bits) {}
+				EventInfo() : list(NULL), propBits(0), id(-1) {}
+				EventInfo(const std::string& _name, EventClientList* _list, int _bits, int _id)
+				: name(_name), list(_list), propBits(_bits), id(_id) {}
 				~EventInfo() {}
 
 				inline const std::string& GetName() const { return name; }
 				inline EventClientList* GetList() const { return list; }
 				inline int GetPropBits() const { return propBits; }
 				inline bool HasPropBit(int bit) const { return propBits & bit; }
+				inline int GetID() const { return id; }
 
 			private:
 				std::string name;
 				EventClientList* list;
 				int propBits;
+				int id; // EventID, -1 for unmanaged events
 		};
 
 		typedef std::pair<std::string, EventInfo> EventPair;
@@ -347,10 +372,13 @@ class CEventHandler
 
 	private:
 		void SetupEvent(const std::string& ciName,
-		                EventClientList* list, int props);
+		                EventClientList* list, int props, int id);
 		void ListInsert(EventClientList& ciList, CEventClient* ec);
 		void ListRemove(EventClientList& ciList, CEventClient* ec);
 
+		void QueueUnitDamaged(const CUnit* unit, const CUnit* attacker, float damage, int weaponDefID, int projectileID, bool paralyzer);
+		void FlushUnitDamagedBatch();
+
 	private:
 		CEventClient* mouseOwner;
 
@@ -359,6 +387,15 @@ class CEventHandler
 
 		EventClientList handles;
 
+		std::bitset<EVENT_COUNT> subscribedEvents;
+
+		// UnitDamaged events of the current frame, and the ones being delivered
+		std::vector<UnitDamagedEvent> unitDamagedBatch;
+		std::vector<UnitDamagedEvent> unitDamagedBatchFlush;
+		std::vector<UnitDamagedEvent> unitDamagedBatchVisible;
+		std::vector<uint8_t> unitDamagedLosStatus;
+		std::vector<uint8_t> unitDamagedLosStatusFlush;
+
 	#define SETUP_EVENT(name, props) EventClientList list ## name;
 	#define SETUP_UNMANAGED_EVENT(name, props)
 		#include "Events.def"
@@ -551,6 +588,11 @@ inline void CEventHandler::UnitDamaged(
 	bool paralyzer)
 {
 	ITERATE_UNIT_ALLYTEAM_EVENTCLIENTLIST(UnitDamaged, unit, attacker, damage, weaponDefID, projectileID, paralyzer)
+
+	if (listUnitDamagedBatch.empty())
+		return;
+
+	QueueUnitDamaged(unit, attacker, damage, weaponDefID, projectileID, paralyzer);
 }
 
 inline void CEventHandler::UnitStunned(
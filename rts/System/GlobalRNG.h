@@ -85,6 +85,7 @@ public:
 	}
 
 	val_type state() const { return val; }
+	void set_state(const val_type _val) { val = _val; }
 
 public:
 	static constexpr res_type min_res = std::numeric_limits<res_type>::min();
@@ -131,6 +132,8 @@ public:
 	rng_val_type GetInitSeed() const { AssureSyncedness(); return initSeed; }
 	rng_val_type GetLastSeed() const { AssureSyncedness(); return lastSeed; }
 	rng_val_type GetGenState() const { AssureSyncedness(); return (gen.state()); }
+	// continues a sequence (same seed) from a state returned by GetGenState
+	void SetGenState(rng_val_type state) { AssureSyncedness(); gen.set_state(state); }
 
 	// needed for std::{random_}shuffle
 	rng_res_type operator()(              ) { AssureSyncedness(); return (this->*gnext )( ); }
@@ -0,0 +1,271 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "ChunkedStreamBuf.h"
+
+#include <cstdio>
+#include <deque>
+#include <future>
+#include <zlib.h>
+
+void CChunkedStreamBuf::Clear()
+{
+	chunks.clear();
+
+	size = 0;
+	putChunk = 0;
+	getChunk = 0;
+
+	setp(nullptr, nullptr);
+	setg(nullptr, nullptr, nullptr);
+}
+
+size_t CChunkedStreamBuf::GetSize() const
+{
+	return std::max(size, GetPutPos());
+}
+
+
+void CChunkedStreamBuf::SetPutPos(size_t pos)
+{
+	const size_t idx = pos / CHUNK_SIZE;
+	const size_t off = pos % CHUNK_SIZE;
+
+	// pos can be at most one past the last chunk
+	if (idx == chunks.size())
+		chunks.emplace_back(new char[CHUNK_SIZE]);
+
+	char* chunk = chunks[putChunk = idx].get();
+
+	setp(chunk, chunk + CHUNK_SIZE);
+	pbump(static_cast<int>(off));
+}
+
+void CChunkedStreamBuf::SetGetPos(size_t pos)
+{
+	const size_t idx = pos / CHUNK_SIZE;
+	const size_t off = pos % CHUNK_SIZE;
+
+	if (idx == chunks.size()) {
+		getChunk = idx;
+		setg(nullptr, nullptr, nullptr);
+		return;
+	}
+
+	char* chunk = chunks[getChunk = idx].get();
+
+	setg(chunk, chunk + off, chunk + std::min(CHUNK_SIZE, size - idx * CHUNK_SIZE));
+}
+
+
+CChunkedStreamBuf::int_type CChunkedStreamBuf::overflow(int_type c)
+{
+	if (traits_type::eq_int_type(c, traits_type::eof()))
+		return traits_type::not_eof(c);
+
+	// put area is either full or not yet set up
+	size = GetSize();
+	SetPutPos(GetPutPos());
+
+	*pptr() = traits_type::to_char_type(c);
+	pbump(1);
+	return c;
+}
+
+CChunkedStreamBuf::int_type CChunkedStreamBuf::underflow()
+{
+	// get area might have been set up before more data was written
+	size = GetSize();
+
+	const size_t pos = GetGetPos();
+
+	if (pos >= size)
+		return traits_type::eof();
+
+	SetGetPos(pos);
+	return traits_type::to_int_type(*gptr());
+}
+
+
+CChunkedStreamBuf::pos_type CChunkedStreamBuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+	off_type base = 0;
+
+	switch (dir) {
+		case std::ios_base::beg: {
+		} break;
+		case std::ios_base::cur: {
+			base = ((which & std::ios_base::out) != 0)? GetPutPos(): GetGetPos();
+		} break;
+		case std::ios_base::end: {
+			base = GetSize();
+		} break;
+		default: {
+			return pos_type(off_type(-1));
+		} break;
+	}
+
+	return seekpos(pos_type(base + off), which);
+}
+
+CChunkedStreamBuf::pos_type CChunkedStreamBuf::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+	const off_type off = pos;
+
+	size = GetSize();
+
+	if (off < 0 || static_cast<size_t>(off) > size)
+		return pos_type(off_type(-1));
+
+	if ((which & std::ios_base::in) != 0)
+		SetGetPos(off);
+	if ((which & std::ios_base::out) != 0)
+		SetPutPos(off);
+
+	return pos;
+}
+
+
+
+static bool CompressChunk(const char* data, size_t dataSize, int level, std::string& member)
+{
+	z_stream zs = {};
+
+	// +16 writes a gzip header and trailer around the deflate stream
+	if (deflateInit2(&zs, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return false;
+
+	member.resize(deflateBound(&zs, dataSize));
+
+	zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+	zs.avail_in = dataSize;
+	zs.next_out = reinterpret_cast<Bytef*>(member.data());
+	zs.avail_out = member.size();
+
+	const int ret = deflate(&zs, Z_FINISH);
+
+	member.resize(zs.total_out);
+	deflateEnd(&zs);
+
+	return (ret == Z_STREAM_END);
+}
+
+template<typename Sink>
+static bool CompressChunks(CChunkedStreamBuf& buf, int level, int numThreads, Sink&& sink)
+{
+	struct Member {
+		std::string data;
+		bool valid;
+	};
+
+	std::deque< std::future<Member> > members;
+
+	const auto WriteMember = [&]() {
+		const Member m = members.front().get();
+
+		members.pop_front();
+		return (m.valid && sink(m.data));
+	};
+
+	bool ret = true;
+
+	for (size_t i = 0, n = buf.GetNumChunks(); i < n; i++) {
+		// bounds the amount of compressed data held in memory
+		if (members.size() >= static_cast<size_t>(std::max(numThreads, 1)))
+			ret &= WriteMember();
+
+		members.emplace_back(std::async(std::launch::async, [&buf, i, level]() {
+			Member m;
+			m.valid = CompressChunk(buf.GetChunk(i), buf.GetChunkSize(i), level, m.data);
+
+			buf.FreeChunk(i);
+			return m;
+		}));
+	}
+
+	while (!members.empty()) {
+		ret &= WriteMember();
+	}
+
+	return ret;
+}
+
+bool ChunkedGZ::WriteFile(const std::string& path, CChunkedStreamBuf& buf, int level, int numThreads)
+{
+	FILE* file = fopen(path.c_str(), "wb");
+
+	if (file == nullptr)
+		return false;
+
+	bool ret = CompressChunks(buf, level, numThreads, [file](const std::string& member) {
+		return (fwrite(member.data(), 1, member.size(), file) == member.size());
+	});
+
+	ret &= (fclose(file) == 0);
+	return ret;
+}
+
+bool ChunkedGZ::Compress(CChunkedStreamBuf& buf, int level, int numThreads, std::string& out)
+{
+	out.clear();
+
+	return (CompressChunks(buf, level, numThreads, [&out](const std::string& member) {
+		out.append(member);
+		return true;
+	}));
+}
+
+bool ChunkedGZ::ReadFile(const std::string& path, CChunkedStreamBuf& buf)
+{
+	gzFile file = gzopen(path.c_str(), "rb");
+
+	if (file == nullptr)
+		return false;
+
+	// gzread continues across concatenated members
+	std::vector<char> readBuf(1 << 20);
+
+	int len = 0;
+
+	while ((len = gzread(file, readBuf.data(), readBuf.size())) > 0) {
+		buf.sputn(readBuf.data(), len);
+	}
+
+	gzclose(file);
+
+	buf.pubseekpos(0, std::ios_base::in);
+	return (len == 0);
+}
+
+bool ChunkedGZ::Decompress(const std::string& in, CChunkedStreamBuf& buf)
+{
+	z_stream zs = {};
+
+	if (inflateInit2(&zs, 15 + 16) != Z_OK)
+		return false;
+
+	std::vector<char> readBuf(1 << 20);
+
+	zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+	zs.avail_in = in.size();
+
+	int ret = Z_OK;
+
+	while (zs.avail_in > 0) {
+		zs.next_out = reinterpret_cast<Bytef*>(readBuf.data());
+		zs.avail_out = readBuf.size();
+
+		if ((ret = inflate(&zs, Z_NO_FLUSH)) != Z_OK && ret != Z_STREAM_END)
+			break;
+
+		buf.sputn(readBuf.data(), readBuf.size() - zs.avail_out);
+
+		// each chunk is a gzip member of its own
+		if (ret == Z_STREAM_END)
+			inflateReset(&zs);
+	}
+
+	inflateEnd(&zs);
+
+	buf.pubseekpos(0, std::ios_base::in);
+	return (ret == Z_STREAM_END);
+}
@@ -0,0 +1,86 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef CHUNKED_STREAM_BUF_H
+#define CHUNKED_STREAM_BUF_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+/**
+ * In-memory stream buffer made of fixed-size chunks, used instead of a
+ * std::stringbuf for save-games. Growing it never copies what was already
+ * written, and every chunk can be compressed (and released) on its own.
+ *
+ * Like std::stringbuf, reading and writing have independent positions and
+ * neither can be moved past the end of the written data.
+ */
+class CChunkedStreamBuf : public std::streambuf
+{
+public:
+	static constexpr size_t CHUNK_SIZE = 4 << 20;
+
+public:
+	CChunkedStreamBuf() = default;
+	CChunkedStreamBuf(const CChunkedStreamBuf&) = delete;
+
+	CChunkedStreamBuf& operator = (const CChunkedStreamBuf&) = delete;
+
+	void Clear();
+
+	size_t GetSize() const;
+	size_t GetNumChunks() const { return ((GetSize() + CHUNK_SIZE - 1) / CHUNK_SIZE); }
+	size_t GetChunkSize(size_t i) const { return std::min(CHUNK_SIZE, GetSize() - i * CHUNK_SIZE); }
+
+	const char* GetChunk(size_t i) const { return chunks[i].get(); }
+	// chunk must not be written to or read from afterwards
+	void FreeChunk(size_t i) { chunks[i].reset(); }
+
+protected:
+	int_type overflow(int_type c) override;
+	int_type underflow() override;
+
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+	pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+private:
+	size_t GetPutPos() const { return (putChunk * CHUNK_SIZE + (pptr() - pbase())); }
+	size_t GetGetPos() const { return (getChunk * CHUNK_SIZE + (gptr() - eback())); }
+
+	void SetPutPos(size_t pos);
+	void SetGetPos(size_t pos);
+
+private:
+	std::vector< std::unique_ptr<char[]> > chunks;
+
+	// high-water mark, excluding data beyond it in the current put area
+	size_t size = 0;
+
+	size_t putChunk = 0;
+	size_t getChunk = 0;
+};
+
+
+namespace ChunkedGZ {
+	/**
+	 * Compresses each chunk of <buf> into its own gzip member, using up to
+	 * <numThreads> chunks in flight, and writes them to <path> in order.
+	 * Chunks are released as soon as they have been compressed.
+	 * A file of concatenated members is still a valid gzip file.
+	 */
+	bool WriteFile(const std::string& path, CChunkedStreamBuf& buf, int level, int numThreads);
+
+	// as WriteFile, but appends the members to <out> (which is cleared first)
+	bool Compress(CChunkedStreamBuf& buf, int level, int numThreads, std::string& out);
+
+	// decompresses <path> (one or more gzip members) into <buf>
+	bool ReadFile(const std::string& path, CChunkedStreamBuf& buf);
+
+	// as ReadFile, but from the output of Compress
+	bool Decompress(const std::string& in, CChunkedStreamBuf& buf);
+}
+
+#endif // CHUNKED_STREAM_BUF_H
@@ -1,11 +1,12 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <memory>
 #include <sstream>
-#include <zlib.h>
 
 #include "ExternalAI/SkirmishAIHandler.h"
 #include "ExternalAI/EngineOutHandler.h"
 #include "CregLoadSaveHandler.h"
+#include "ChunkedStreamBuf.h"
 #include "Map/ReadMap.h"
 #include "Game/Game.h"
 #include "Game/GameSetup.h"
@@ -113,6 +114,17 @@ void CGameStateCollector::Serialize(creg::ISerializer* s)
 
 	s->SerializeObjectInstance(CUnitDrawer::modelDrawerData->GetSavedData(), CUnitDrawer::modelDrawerData->GetSavedData()->GetClass());
 	//s->SerializeObjectInstance(groundDecals, groundDecals->GetClass());
+
+	// the server reseeds a loaded save-game, but demo playback continues
+	// from a keyframe with the sequence the recording had reached
+	ENTER_SYNCED_CODE();
+	std::uint64_t rngState = gsRNG.GetGenState();
+	s->SerializeInt(&rngState, sizeof(rngState));
+
+	if (!s->IsWriting())
+		gsRNG.SetGenState(rngState);
+
+	LEAVE_SYNCED_CODE();
 }
 
 
@@ -225,7 +237,7 @@ static void ReadString(std::istream& s, std::string& str)
 }
 
 
-static void SaveLuaState(CSplitLuaHandle* handle, creg::COutputStreamSerializer& os, std::stringstream& oss)
+static void SaveLuaState(CSplitLuaHandle* handle, creg::COutputStreamSerializer& os, std::ostream& oss)
 {
 	CLuaStateCollector lsc;
 	lsc.Read(handle);
@@ -233,7 +245,7 @@ static void SaveLuaState(CSplitLuaHandle* handle, creg::COutputStreamSerializer&
 }
 
 
-static void LoadLuaState(CSplitLuaHandle* handle, creg::CInputStreamSerializer& is, std::stringstream& iss)
+static void LoadLuaState(CSplitLuaHandle* handle, creg::CInputStreamSerializer& is, std::istream& iss)
 {
 	void* plsc;
 	creg::Class* plsccls = nullptr;
@@ -251,76 +263,80 @@ static void LoadLuaState(CSplitLuaHandle* handle, creg::CInputStreamSerializer&
 }
 
 
-void CCregLoadSaveHandler::SaveGame(const std::string& path)
+void CCregLoadSaveHandler::SaveState(std::ostream& oss, bool saveAIData)
 {
 #ifdef USING_CREG
-	LOG("[LSH::%s] saving game to \"%s\"", __func__, path.c_str());
+	// write our own header. SavePackage() will add its own
+	WriteString(oss, SpringVersion::GetSync());
+	WriteString(oss, gameSetup->setupText);
+	WriteString(oss, modName);
+	WriteString(oss, mapName);
 
-	// NB: Selection leaves CObject reference as Unit's listener,
-	//     But isn't serialized - leak on load.
-	selectedUnitsHandler.ClearSelected();
+	Sim::SaveComponents(oss);
 
-	try {
-		std::stringstream oss;
+	creg::COutputStreamSerializer os;
 
-		// write our own header. SavePackage() will add its own
-		WriteString(oss, SpringVersion::GetSync());
-		WriteString(oss, gameSetup->setupText);
-		WriteString(oss, modName);
-		WriteString(oss, mapName);
+	// save lua state first as lua unit scripts depend on it
+	const int luaStart = oss.tellp();
+	SaveLuaState(luaGaia, os, oss);
+	SaveLuaState(luaRules, os, oss);
+	PrintSize("Lua", ((int)oss.tellp()) - luaStart);
 
+	// save creg state
+	const int gameStart = oss.tellp();
+	CGameStateCollector gsc;
+	os.SavePackage(&oss, &gsc, gsc.GetClass());
+	PrintSize("Game", ((int)oss.tellp()) - gameStart);
 
-		{
-			Sim::SaveComponents(oss);
 
-			creg::COutputStreamSerializer os;
+	// save AI state
+	const int aiStart = oss.tellp();
 
-			// save lua state first as lua unit scripts depend on it
-			const int luaStart = oss.tellp();
-			SaveLuaState(luaGaia, os, oss);
-			SaveLuaState(luaRules, os, oss);
-			PrintSize("Lua", ((int)oss.tellp()) - luaStart);
+	// without AI data every AI still gets an (empty) entry for LoadAIData
+	for (const auto& ai: skirmishAIHandler.GetAllSkirmishAIs()) {
+		std::stringstream aiData;
 
-			// save creg state
-			const int gameStart = oss.tellp();
-			CGameStateCollector gsc;
-			os.SavePackage(&oss, &gsc, gsc.GetClass());
-			PrintSize("Game", ((int)oss.tellp()) - gameStart);
+		if (saveAIData)
+			eoh->Save(&aiData, ai.first);
 
+		std::uint64_t aiSize = aiData.tellp();
+		creg::WriteUInt(&oss, aiSize);
+		if (aiSize > 0)
+			oss << aiData.rdbuf();
+	}
+	PrintSize("AIs", ((int)oss.tellp()) - aiStart);
+#endif //USING_CREG
+}
+
+void CCregLoadSaveHandler::SaveGame(const std::string& path)
+{
+#ifdef USING_CREG
+	LOG("[LSH::%s] saving game to \"%s\"", __func__, path.c_str());
 
-			// save AI state
-			const int aiStart = oss.tellp();
+	// NB: Selection leaves CObject reference as Unit's listener,
+	//     But isn't serialized - leak on load.
+	selectedUnitsHandler.ClearSelected();
 
-			for (const auto& ai: skirmishAIHandler.GetAllSkirmishAIs()) {
-				std::stringstream aiData;
-				eoh->Save(&aiData, ai.first);
+	try {
+		// chunks are compressed and released by the writer job, so the
+		// state is never held in memory twice (as with oss.str() before)
+		auto ossBuf = std::make_unique<CChunkedStreamBuf>();
+		std::ostream oss(ossBuf.get());
 
-				std::uint64_t aiSize = aiData.tellp();
-				creg::WriteUInt(&oss, aiSize);
-				if (aiSize > 0)
-					oss << aiData.rdbuf();
-			}
-			PrintSize("AIs", ((int)oss.tellp()) - aiStart);
-		}
+		SaveState(oss, true);
 
 		{
-			gzFile file = gzopen(dataDirsAccess.LocateFile(path, FileQueryFlags::WRITE).c_str(), "wb5");
-
-			if (file == nullptr) {
-				LOG_L(L_ERROR, "[LSH::%s] could not open save-file", __func__);
-				return;
-			}
-
-			std::string data = oss.str();
-			std::function<void(gzFile, std::string&&)> func = [](gzFile file, std::string&& data) {
-				gzwrite(file, data.c_str(), data.size());
-				gzflush(file, Z_FINISH);
-				gzclose(file);
+			const std::string filePath = dataDirsAccess.LocateFile(path, FileQueryFlags::WRITE);
+			const int numThreads = ThreadPool::GetNumThreads();
+
+			std::function<void(std::string, std::unique_ptr<CChunkedStreamBuf>&&)> func = [numThreads](std::string filePath, std::unique_ptr<CChunkedStreamBuf>&& buf) {
+				// every chunk becomes a separate gzip member, compressed in parallel
+				if (!ChunkedGZ::WriteFile(filePath, *buf, 5, numThreads))
+					LOG_L(L_ERROR, "[LSH::SaveGame] could not write save-file \"%s\"", filePath.c_str());
 			};
 
-			// gzFile is just a plain typedef (struct gzFile_s {}* gzFile), can be copied
 			// need to keep a reference to the future around or its destructor will block
-			ThreadPool::AddExtJob(std::move(std::async(std::launch::async, std::move(func), file, std::move(data))));
+			ThreadPool::AddExtJob(std::move(std::async(std::launch::async, std::move(func), filePath, std::move(ossBuf))));
 		}
 
 		//FIXME add lua state
@@ -340,19 +356,72 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 #endif //USING_CREG
 }
 
+bool CCregLoadSaveHandler::SaveGameToBuffer(std::string& data, int level)
+{
+#ifdef USING_CREG
+	// the selection must not end up in the state (see SaveGame), but the
+	// caller keeps playing; only unlink the selected units for the duration
+	// of the save so that neither the handler nor LuaUI notice anything
+	const auto& selectedUnitIDs = selectedUnitsHandler.selectedUnits;
+	bool ret = false;
+
+	for (const int unitID: selectedUnitIDs) {
+		CUnit* unit = unitHandler.GetUnit(unitID);
+
+		selectedUnitsHandler.DeleteDeathDependence(unit, DEPENDENCE_SELECTED);
+		unit->isSelected = false;
+	}
+
+	try {
+		CChunkedStreamBuf buf;
+		std::ostream oss(&buf);
+
+		// AI callbacks are skipped, keyframes are taken while the AIs run
+		SaveState(oss, false);
+
+		ret = ChunkedGZ::Compress(buf, level, ThreadPool::GetNumThreads(), data);
+	} catch (const std::exception& ex) {
+		LOG_L(L_ERROR, "[LSH::%s] exception \"%s\"", __func__, ex.what());
+	} catch (...) {
+		LOG_L(L_ERROR, "[LSH::%s] unknown error", __func__);
+	}
+
+	for (const int unitID: selectedUnitIDs) {
+		CUnit* unit = unitHandler.GetUnit(unitID);
+
+		selectedUnitsHandler.AddDeathDependence(unit, DEPENDENCE_SELECTED);
+		unit->isSelected = true;
+	}
+
+	return ret;
+#endif //USING_CREG
+
+	return false;
+}
+
 /// loads the data (map&mod-name,setup-script) needed by PreGame
 bool CCregLoadSaveHandler::LoadGameStartInfo(const std::string& path)
 {
-	CGZFileHandler saveFile(dataDirsAccess.LocateFile(FindSaveFile(path)), SPRING_VFS_RAW_FIRST);
+	const std::string filePath = dataDirsAccess.LocateFile(FindSaveFile(path));
 
-	std::stringbuf* sbuf = iss.rdbuf();
 	std::string saveVersion;
 	std::string syncVersion = SpringVersion::GetSync();
 
-	char buf[4096];
-	int len;
-	while ((len = saveFile.Read(buf, sizeof(buf))) > 0)
-		sbuf->sputn(buf, len);
+	issBuf.Clear();
+	iss.clear();
+
+	// decompress straight into issBuf, unless the save only exists in the VFS
+	if (!ChunkedGZ::ReadFile(filePath, issBuf)) {
+		CGZFileHandler saveFile(filePath, SPRING_VFS_RAW_FIRST);
+
+		char buf[4096];
+		int len;
+
+		issBuf.Clear();
+
+		while ((len = saveFile.Read(buf, sizeof(buf))) > 0)
+			issBuf.sputn(buf, len);
+	}
 
 	ReadString(iss, saveVersion);
 
@@ -371,10 +440,39 @@ bool CCregLoadSaveHandler::LoadGameStartInfo(const std::string& path)
 	return (saveVersion == syncVersion);
 }
 
+bool CCregLoadSaveHandler::LoadDemoKeyframe(const std::string& data)
+{
+	std::string saveVersion;
+	std::string syncVersion = SpringVersion::GetSync();
+
+	issBuf.Clear();
+	iss.clear();
+
+	if (!ChunkedGZ::Decompress(data, issBuf)) {
+		LOG_L(L_WARNING, "[LSH::%s] corrupt keyframe data", __func__);
+		return false;
+	}
+
+	ReadString(iss, saveVersion);
+	ReadString(iss, scriptText);
+	ReadString(iss, modName);
+	ReadString(iss, mapName);
+
+	if (saveVersion != syncVersion) {
+		LOG_L(L_WARNING, "[LSH::%s] keyframe saved by engine version \"%s\" incompatible with \"%s\"", __func__, saveVersion.c_str(), syncVersion.c_str());
+		return false;
+	}
+
+	return (demoKeyframe = true);
+}
+
 /// this should be called on frame 0 when the game has started
 void CCregLoadSaveHandler::LoadGame()
 {
 #ifdef USING_CREG
+	// gu is part of the state, but belongs to whoever recorded the demo
+	const int myPlayerNum = gu->myPlayerNum;
+
 	ENTER_SYNCED_CODE();
 	{
 		Sim::LoadComponents(iss);
@@ -397,6 +495,16 @@ void CCregLoadSaveHandler::LoadGame()
 		spring::SafeDelete(gsc);
 	}
 
+	// demos do not load AI data, so LoadAIData is never called for them
+	if (demoKeyframe) {
+		gu->SetMyPlayer(myPlayerNum);
+
+		issBuf.Clear();
+		iss.clear();
+
+		gs->paused = false;
+	}
+
 	LEAVE_SYNCED_CODE();
 #else //USING_CREG
 	LOG_L(L_ERROR, "Load failed: creg is disabled");
@@ -423,7 +531,8 @@ void CCregLoadSaveHandler::LoadAIData()
 	}
 
 	// cleanup
-	iss.str("");
+	issBuf.Clear();
+	iss.clear();
 
 	gs->paused = false;
 	if (gameServer != nullptr) {
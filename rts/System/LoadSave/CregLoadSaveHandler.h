@@ -4,7 +4,9 @@
 #define CREG_LOAD_SAVE_HANDLER_H
 
 #include <string>
-#include <sstream>
+#include <istream>
+#include <ostream>
+#include "ChunkedStreamBuf.h"
 #include "LoadSaveHandler.h"
 
 class CCregLoadSaveHandler : public ILoadSaveHandler
@@ -18,8 +20,30 @@ public:
 	void LoadAIData() override;
 	void SaveGame(const std::string& path) override;
 
+	/**
+	 * Serializes the running game into <data>, gzip-compressed at <level>,
+	 * which then has the same contents as a save-game file written by
+	 * SaveGame except that AI data is left empty. The unit selection is
+	 * not touched, so it can be called while the game continues (e.g. for
+	 * demo keyframes).
+	 */
+	bool SaveGameToBuffer(std::string& data, int level);
+
+	/**
+	 * Prepares loading a demo keyframe, i.e. the <data> of SaveGameToBuffer.
+	 * Unlike LoadGameStartInfo the setup script is left alone, the demo has
+	 * its own; LoadGame then keeps the local player of the demo viewer.
+	 */
+	bool LoadDemoKeyframe(const std::string& data);
+
 protected:
-	std::stringstream iss;
+	void SaveState(std::ostream& oss, bool saveAIData);
+
+protected:
+	CChunkedStreamBuf issBuf;
+	std::istream iss{&issBuf};
+
+	bool demoKeyframe = false;
 };
 
 #endif // CREG_LOAD_SAVE_HANDLER_H
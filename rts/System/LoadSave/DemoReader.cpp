@@ -17,6 +17,7 @@ CONFIG(bool, DisableDemoVersionCheck).defaultValue(false).description("Allow to
 
 #include <array>
 #include <climits>
+#include <cstdint>
 #include <stdexcept>
 #include <cassert>
 #include <cstring>
@@ -99,6 +100,8 @@ CDemoReader::CDemoReader(const std::string& filename, float curTime): playbackDe
 		// (if this had still used CFileHandler that would have been easier ;-))
 		bytesRemaining = playbackDemoSize - curPos;
 	}
+
+	LoadIndex();
 	playbackDemo->Seek(curPos);
 }
 
@@ -152,6 +155,12 @@ bool CDemoReader::ReachedEnd()
 	return (bytesRemaining <= 0 || playbackDemo->Eof() || (playbackDemo->GetPos() > playbackDemoSize));
 }
 
+int CDemoReader::GetStreamPos()
+{
+	// the header of that chunk has already been read
+	return (playbackDemo->GetPos() - int(sizeof(chunkHeader)) - fileHeader.headerSize - fileHeader.scriptSize);
+}
+
 
 void CDemoReader::LoadStats()
 {
@@ -200,3 +209,92 @@ void CDemoReader::LoadStats()
 
 	playbackDemo->Seek(curPos);
 }
+
+
+void CDemoReader::LoadIndex()
+{
+	// the index is written last, so crashed recordings do not have one
+	if (fileHeader.demoStreamSize == 0)
+		return;
+
+	const int streamEnd = fileHeader.headerSize + fileHeader.scriptSize + fileHeader.demoStreamSize;
+	const int trailerPos = playbackDemoSize - int(sizeof(DemoIndexTrailer));
+
+	if (trailerPos < streamEnd)
+		return;
+
+	DemoIndexTrailer trailer;
+
+	playbackDemo->Seek(trailerPos);
+	playbackDemo->Read(reinterpret_cast<char*>(&trailer), sizeof(trailer));
+	trailer.swab();
+
+	if (memcmp(trailer.magic, DEMOFILE_INDEX_MAGIC, sizeof(trailer.magic)) != 0)
+		return;
+
+	// sizes and counts are checked against each other before anything is allocated
+	const std::uint64_t frameIndexSize = std::uint64_t(trailer.numFrameEntries) * sizeof(DemoFrameIndexEntry);
+	const std::uint64_t keyframesSize = std::uint64_t(trailer.numKeyframes) * sizeof(DemoKeyframeHeader);
+
+	if (trailer.indexSize > unsigned(trailerPos - streamEnd) || (frameIndexSize + keyframesSize) > trailer.indexSize) {
+		LOG_L(L_WARNING, "[DemoReader::%s] ignoring corrupt demo index (%u bytes)", __func__, trailer.indexSize);
+		return;
+	}
+
+	const int indexPos = trailerPos - trailer.indexSize;
+
+	playbackDemo->Seek(indexPos);
+	frameIndex.resize(trailer.numFrameEntries);
+
+	for (DemoFrameIndexEntry& entry: frameIndex) {
+		playbackDemo->Read(reinterpret_cast<char*>(&entry), sizeof(DemoFrameIndexEntry));
+		entry.swab();
+	}
+
+	keyframes.reserve(trailer.numKeyframes);
+	keyframeStatePositions.reserve(trailer.numKeyframes);
+
+	for (unsigned int i = 0; i < trailer.numKeyframes; ++i) {
+		DemoKeyframeHeader header;
+
+		if (playbackDemo->Read(reinterpret_cast<char*>(&header), sizeof(header)) < int(sizeof(header)))
+			break;
+
+		header.swab();
+
+		const int statePos = playbackDemo->GetPos();
+
+		if (header.stateSize > unsigned(trailerPos - statePos))
+			break;
+
+		keyframes.push_back(header);
+		keyframeStatePositions.push_back(statePos);
+
+		playbackDemo->Seek(statePos + header.stateSize);
+	}
+
+	if (keyframes.size() != trailer.numKeyframes || playbackDemo->GetPos() != trailerPos) {
+		LOG_L(L_WARNING, "[DemoReader::%s] ignoring corrupt demo index", __func__);
+
+		frameIndex.clear();
+		keyframes.clear();
+		keyframeStatePositions.clear();
+	}
+}
+
+
+bool CDemoReader::ReadKeyframeState(int keyframeNum, std::string& state)
+{
+	if (keyframeNum < 0 || keyframeNum >= int(keyframes.size()))
+		return false;
+
+	const int curPos = playbackDemo->GetPos();
+
+	state.resize(keyframes[keyframeNum].stateSize);
+	playbackDemo->Seek(keyframeStatePositions[keyframeNum]);
+
+	const bool ret = (playbackDemo->Read(state.data(), state.size()) == int(state.size()));
+
+	playbackDemo->Seek(curPos);
+	return ret;
+}
@@ -43,6 +43,9 @@ public:
 	float GetDemoTimeOffset() const { return demoTimeOffset; }
 	float GetNextDemoReadTime() const { return nextDemoReadTime; }
 
+	/// stream offset of the next chunk GetData returns, comparable to DemoKeyframeHeader::streamOffset
+	int GetStreamPos();
+
 	const std::string& GetSetupScript() const
 	{
 		return setupScript;
@@ -55,6 +58,19 @@ public:
 	/// Not needed for normal demo watching
 	void LoadStats();
 
+	/// empty unless the demo was recorded with an index, see DemoIndexTrailer
+	const std::vector<DemoFrameIndexEntry>& GetFrameIndex() const { return frameIndex; }
+	const std::vector<DemoKeyframeHeader>& GetKeyframes() const { return keyframes; }
+
+	/**
+	@brief read the game-state of a keyframe
+	@param state receives a compressed save-game, which can be written out as .ssf
+	*/
+	bool ReadKeyframeState(int keyframeNum, std::string& state);
+
+private:
+	void LoadIndex();
+
 private:
 	CFileHandler* playbackDemo;
 
@@ -70,6 +86,10 @@ private:
 	std::vector<PlayerStatistics> playerStats; // one stat per player
 	std::vector< std::vector<TeamStatistics> > teamStats; // many stats per team
 	std::vector<unsigned char> winningAllyTeams;
+
+	std::vector<DemoFrameIndexEntry> frameIndex;
+	std::vector<DemoKeyframeHeader> keyframes;
+	std::vector<int> keyframeStatePositions; // file position of each keyframe's state
 };
 
 #endif
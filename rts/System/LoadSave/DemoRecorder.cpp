@@ -11,6 +11,7 @@
 #include "Sim/Misc/TeamStatistics.h"
 #include "System/TimeUtil.h"
 #include "System/StringUtil.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/FileSystem/FileQueryFlags.h"
@@ -18,6 +19,9 @@
 #include "System/Log/ILog.h"
 #include "System/Threading/ThreadPool.h"
 
+CONFIG(int, DemoKeyframeInterval).defaultValue(0).minimumValue(0).description("Seconds of game-time between state snapshots stored in recorded demos, which /skip seeks to when watching the demo and DemoTool can extract as save-games. 0 = off. Every snapshot is a full save-game held in memory until the demo is written.");
+
+
 #ifdef CreateDirectory
 #undef CreateDirectory
 #endif
@@ -36,6 +40,9 @@ CDemoRecorder::CDemoRecorder(const std::string& mapName, const std::string& modN
 {
 	std::lock_guard<spring::mutex> lock(demoMutex);
 
+	// without keyframes there is nothing to seek to, write demos as before
+	writeIndex = (configHandler->GetInt("DemoKeyframeInterval") > 0);
+
 	SetStream();
 	SetName(mapName, modName);
 	SetFileHeader();
@@ -52,6 +59,7 @@ CDemoRecorder::~CDemoRecorder()
 	WriteWinnerList();
 	WritePlayerStats();
 	WriteTeamStats();
+	WriteIndex();
 	WriteFileHeader(true);
 	WriteDemoFile();
 }
@@ -127,6 +135,10 @@ void CDemoRecorder::SaveToDemo(const unsigned char* buf, const unsigned length,
 {
 	DemoStreamChunkHeader chunkHeader;
 
+	// one index entry per second of game-time is enough to seek with
+	if (writeIndex && (frameIndex.empty() || modGameTime >= (frameIndex.back().modGameTime + 1.0f)))
+		frameIndex.push_back({modGameTime, static_cast<std::uint32_t>(fileHeader.demoStreamSize)});
+
 	chunkHeader.modGameTime = modGameTime;
 	chunkHeader.length = length;
 	chunkHeader.swab();
@@ -228,6 +240,18 @@ void CDemoRecorder::SetWinningAllyTeams(const std::vector<unsigned char>& winnin
 	winningAllyTeams = winningAllyTeamIDs;
 }
 
+void CDemoRecorder::AddKeyframe(int frameNum, float modGameTime, std::string&& state)
+{
+	DemoKeyframeHeader header;
+
+	header.frameNum = frameNum;
+	header.modGameTime = modGameTime;
+	header.streamOffset = fileHeader.demoStreamSize;
+	header.stateSize = state.size();
+
+	keyframes.emplace_back(header, std::move(state));
+}
+
 /** @brief Write DemoFileHeader
 Write the DemoFileHeader at the start of the file and restores the original
 position in the file afterwards. */
@@ -311,3 +335,37 @@ void CDemoRecorder::WriteTeamStats()
 
 	teamStats.clear();
 }
+
+/** @brief Write the frame index and keyframes, followed by DemoIndexTrailer. */
+void CDemoRecorder::WriteIndex()
+{
+	// keep the file identical to older demos unless keyframes are enabled
+	if (!writeIndex)
+		return;
+
+	std::string& stream = demoStreams[isServerDemo];
+	const size_t pos = stream.size();
+
+	for (DemoFrameIndexEntry& entry: frameIndex) {
+		entry.swab();
+		stream.append(reinterpret_cast<const char*>(&entry), sizeof(DemoFrameIndexEntry));
+	}
+
+	for (auto& keyframe: keyframes) {
+		keyframe.first.swab();
+		stream.append(reinterpret_cast<const char*>(&keyframe.first), sizeof(DemoKeyframeHeader));
+		stream.append(keyframe.second);
+	}
+
+	DemoIndexTrailer trailer;
+
+	trailer.numFrameEntries = frameIndex.size();
+	trailer.numKeyframes = keyframes.size();
+	trailer.indexSize = stream.size() - pos;
+	memcpy(trailer.magic, DEMOFILE_INDEX_MAGIC, sizeof(trailer.magic));
+	trailer.swab();
+	stream.append(reinterpret_cast<const char*>(&trailer), sizeof(DemoIndexTrailer));
+
+	frameIndex.clear();
+	keyframes.clear();
+}
@@ -38,8 +38,11 @@ public:
 		std::swap(playerStats, r.playerStats);
 		std::swap(teamStats, r.teamStats);
 		std::swap(winningAllyTeams, r.winningAllyTeams);
+		std::swap(frameIndex, r.frameIndex);
+		std::swap(keyframes, r.keyframes);
 
 		std::swap(isServerDemo, r.isServerDemo);
+		std::swap(writeIndex, r.writeIndex);
 		return *this;
 	}
 
@@ -62,12 +65,20 @@ public:
 	void SetTeamStats(int teamNum, const std::vector<TeamStatistics>& stats);
 	void SetWinningAllyTeams(const std::vector<unsigned char>& winningAllyTeams);
 
+	/**
+	 * @brief Store a snapshot of the game-state taken after frame frameNum
+	 * Playback can seek to it and continue with the data recorded from now on.
+	 * @param state a compressed save-game, see CCregLoadSaveHandler::SaveGameToBuffer
+	 */
+	void AddKeyframe(int frameNum, float modGameTime, std::string&& state);
+
 private:
 	unsigned int WriteFileHeader(bool updateStreamLength);
 	void SetFileHeader();
 	void WritePlayerStats();
 	void WriteTeamStats();
 	void WriteWinnerList();
+	void WriteIndex();
 	void WriteDemoFile();
 
 private:
@@ -77,7 +88,11 @@ private:
 	std::vector< std::vector<TeamStatistics> > teamStats;
 	std::vector<unsigned char> winningAllyTeams;
 
+	std::vector<DemoFrameIndexEntry> frameIndex;
+	std::vector< std::pair<DemoKeyframeHeader, std::string> > keyframes;
+
 	bool isServerDemo = false;
+	bool writeIndex = false;
 };
 
 
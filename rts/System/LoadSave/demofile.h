@@ -40,6 +40,7 @@
  *         CTeam::Statistics for each team.
  *       - Array of all CTeam::Statistics (total number of items is the
  *         sum of the elements in the array of dwords).
+ *     - Optional index for seeking, see DemoIndexTrailer
  *
  * The header is designed to be extensible: it contains a version field and a
  * headerSize field to support this. The version field is a major version number
@@ -115,6 +116,62 @@ struct DemoStreamChunkHeader
 	}
 };
 
+/**
+ * @brief Spring demo index, optional
+ *
+ * Demos may end with an index that allows seeking, which older readers skip
+ * since it follows all of the data chunks listed in DemoFileHeader:
+ *
+ * - Frame index, numFrameEntries DemoFrameIndexEntry's
+ * - Keyframes, numKeyframes times:
+ *   - DemoKeyframeHeader
+ *   - stateSize bytes of game-state, compressed like a .ssf save-game
+ * - DemoIndexTrailer, always the last bytes of the file
+ *
+ * All stream offsets are relative to the start of the demo stream.
+ */
+#define DEMOFILE_INDEX_MAGIC "sdfzidx1"
+
+struct DemoFrameIndexEntry
+{
+	float modGameTime;            ///< Gametime of the chunk starting at streamOffset.
+	std::uint32_t streamOffset;   ///< Offset of a DemoStreamChunkHeader.
+
+	void swab() {
+		swabFloatInPlace(modGameTime);
+		swabDWordInPlace(streamOffset);
+	}
+};
+
+struct DemoKeyframeHeader
+{
+	int frameNum;                 ///< Sim frame after which the state was saved.
+	float modGameTime;            ///< Gametime of that frame.
+	std::uint32_t streamOffset;   ///< Where playback continues after loading the state.
+	std::uint32_t stateSize;      ///< Size of the compressed state following this header.
+
+	void swab() {
+		swabDWordInPlace(frameNum);
+		swabFloatInPlace(modGameTime);
+		swabDWordInPlace(streamOffset);
+		swabDWordInPlace(stateSize);
+	}
+};
+
+struct DemoIndexTrailer
+{
+	std::uint32_t numFrameEntries;
+	std::uint32_t numKeyframes;
+	std::uint32_t indexSize;      ///< Size of the index, excluding this trailer.
+	char magic[8];                ///< DEMOFILE_INDEX_MAGIC, not null-terminated
+
+	void swab() {
+		swabDWordInPlace(numFrameEntries);
+		swabDWordInPlace(numKeyframes);
+		swabDWordInPlace(indexSize);
+	}
+};
+
 #pragma pack(pop)
 
 #endif // DEMO_FILE_H
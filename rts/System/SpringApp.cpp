@@ -35,6 +35,7 @@
 #include "Game/Game.h"
 #include "Game/GlobalUnsynced.h"
 #include "Game/PreGame.h"
+#include "Game/ReplayBenchmark.h"
 #include "Game/UI/KeyBindings.h"
 #include "Game/UI/KeyCodes.h"
 #include "Game/UI/ScanCodes.h"
@@ -155,6 +156,7 @@ DEFINE_string_EX(calc_checksum,      "calc-checksum",      "",    "Calculate nam
  * parallel because they both try to open the same port. This makes automated replay parsing difficult when
  * the same port number is heavily reused across many replays. Forcing onlyLocal solves this. */
 DEFINE_bool_EX  (onlyLocal,              "only-local",     false, "Force OnlyLocal mode (no network listening sockets). Use for parallelized watching of multiplayer replays");
+DEFINE_string_EX(replay_benchmark,       "replay-benchmark", "",  "Watch the given demo as fast as possible and write per-frame sim timings to this file (CSV, or JSON if it ends in .json)");
 
 
 
@@ -573,6 +575,7 @@ void SpringApp::ParseCmdLine(int argc, char* argv[])
 	CTextureAtlas::SetDebug(FLAGS_textureatlas);
 
 	CGameSetup::forceOnlyLocal = FLAGS_onlyLocal;
+	CReplayBenchmark::outputFile = FLAGS_replay_benchmark;
 
 	// if this fails, configHandler remains null
 	// logOutput's init depends on configHandler
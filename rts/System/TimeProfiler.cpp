@@ -425,6 +425,27 @@ void CTimeProfiler::AddTimeRaw(
 	}
 }
 
+void CTimeProfiler::GetTotalTimes(std::vector< std::pair<unsigned, spring_time> >& totals)
+{
+	std::lock_guard<ProfileMutexType> lock(profileMutex);
+
+	for (const auto& p: profiles) {
+		totals.emplace_back(p.first, p.second.total);
+	}
+}
+
+std::string CTimeProfiler::GetTimerName(unsigned nameHash)
+{
+	std::lock_guard<HashNamMutexType> lock(hashToNameMutex);
+
+	const auto iter = hashToName.find(nameHash);
+
+	if (iter == hashToName.end())
+		return "";
+
+	return (iter->second);
+}
+
 void CTimeProfiler::PrintProfilingInfo() const
 {
 	if (sortedProfiles.empty())
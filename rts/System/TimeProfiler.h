@@ -190,6 +190,10 @@ public:
 	void SetEnabled(bool b) { enabled = b; }
 	void PrintProfilingInfo() const;
 
+	/// appends <nameHash, total time> of every profile, for sampling timers per frame
+	void GetTotalTimes(std::vector< std::pair<unsigned, spring_time> >& totals);
+	static std::string GetTimerName(unsigned nameHash);
+
 	void AddTime(
 		unsigned nameHash,
 		const spring_time startTime,
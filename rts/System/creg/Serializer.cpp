@@ -138,59 +138,62 @@ bool COutputStreamSerializer::IsWriting()
 
 COutputStreamSerializer::ObjectRef* COutputStreamSerializer::FindObjectRef(void* inst, creg::Class* objClass, bool isEmbedded)
 {
-	std::vector<ObjectRef*>& refs = ptrToId[inst];
-	for (auto& obj: refs) {
+	const auto it = ptrToId.find(inst);
+
+	if (it == ptrToId.end())
+		return nullptr;
+
+	for (ObjectRef* obj = it->second; obj != nullptr; obj = obj->nextSamePtr) {
 		if (obj->isThisObject(inst, objClass, isEmbedded))
 			return obj;
 	}
 	return nullptr;
 }
 
+COutputStreamSerializer::ObjectRef* COutputStreamSerializer::AddObjectRef(void* inst, creg::Class* objClass, bool isEmbedded)
+{
+	objects.emplace_back(inst, objects.size(), isEmbedded, objClass);
+
+	ObjectRef* obj = &objects.back();
+	ObjectRef*& ref = ptrToId[inst];
+
+	// keep the first reference at the head, it is the one preallocated objects are placed in
+	if (ref == nullptr) {
+		ref = obj;
+	} else {
+		ObjectRef* tail = ref;
+
+		while (tail->nextSamePtr != nullptr)
+			tail = tail->nextSamePtr;
+
+		tail->nextSamePtr = obj;
+	}
+
+	return obj;
+}
+
 void COutputStreamSerializer::SerializeObject(Class* c, void* ptr, ObjectRef* objr)
 {
-	const unsigned objstart = stream->tellp();
+	// tellp is a virtual call on most streams, only pay for it when the sizes get logged
+	const unsigned objstart = collectClassSizes? unsigned(stream->tellp()): 0;
 
 	if (c->base())
 		SerializeObject(c->base(), ptr, objr);
 
-	ObjectMemberGroup omg;
-	omg.membersClass = c;
-	omg.size = 0;
-
-	for (uint a = 0; a < c->members.size(); a++)
-	{
-		creg::Class::Member* m = &c->members[a];
-		if (m->flags & CM_NoSerialize)
+	for (creg::Class::Member& m: c->members) {
+		if (m.flags & CM_NoSerialize)
 			continue;
 
-		ObjectMember om;
-		om.member = m;
-		om.memberId = a;
-		void* memberAddr = ((char*)ptr) + m->offset;
-		unsigned mstart = stream->tellp();
-		LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Serialized %s::%s type:%s", c->name, m->name, m->type->GetName().c_str());
-		m->type->Serialize(this, memberAddr);
-		unsigned mend = stream->tellp();
-		om.size = mend - mstart;
-		omg.members.push_back(om);
-		omg.size += om.size;
-		LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Serialized %s::%s type:%s size:%d", c->name, m->name, m->type->GetName().c_str(), om.size);
+		void* memberAddr = ((char*)ptr) + m.offset;
+		LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Serialized %s::%s type:%s", c->name, m.name, m.type->GetName().c_str());
+		m.type->Serialize(this, memberAddr);
 	}
 
-
-	if (c->HasSerialize()) {
-		ObjectMember om;
-		om.member = nullptr;
-		om.memberId = -1;
-		unsigned mstart = stream->tellp();
+	if (c->HasSerialize())
 		c->CallSerializeProc(ptr, this);
-		unsigned mend = stream->tellp();
-		om.size = mend - mstart;
-		omg.members.push_back(om);
-		omg.size += om.size;
-	}
 
-	objr->memberGroups.push_back(omg);
+	if (!collectClassSizes)
+		return;
 
 	const unsigned objend = stream->tellp();
 	const int sz = objend - objstart;
@@ -203,18 +206,14 @@ void COutputStreamSerializer::SerializeObjectInstance(void* inst, creg::Class* o
 	// register the object, and mark it as embedded if a pointer was already referencing it
 	ObjectRef* obj = FindObjectRef(inst, objClass, true);
 	if (!obj) {
-		objects.emplace_back(inst, objects.size(), true, objClass);
-		obj = &objects.back();
-		ptrToId[inst].push_back(obj);
+		obj = AddObjectRef(inst, objClass, true);
 	} else if (obj->isEmbedded) {
 		throw std::string("Reserialization of embedded object (") + objClass->name + ")";
+	} else if (!obj->isPending) {
+		throw std::string("Object pointer was serialized (") + objClass->name + ")";
 	} else {
-		std::vector<ObjectRef*>::iterator it = std::find(pendingObjects.begin(), pendingObjects.end(), obj);
-		if (it == pendingObjects.end()) {
-			throw std::string("Object pointer was serialized (") + objClass->name + ")";
-		} else {
-			pendingObjects.erase(it);
-		}
+		// stays in pendingObjects, but is skipped there
+		obj->isPending = false;
 	}
 	obj->class_ = objClass;
 	obj->isEmbedded = true;
@@ -233,9 +232,8 @@ void COutputStreamSerializer::SerializeObjectPtr(void** ptr, creg::Class* objCla
 		int id;
 		ObjectRef* obj = FindObjectRef(*ptr, objClass, false);
 		if (!obj) {
-			objects.emplace_back(*ptr, objects.size(), false, objClass);
-			obj = &objects.back();
-			ptrToId[*ptr].push_back(obj);
+			obj = AddObjectRef(*ptr, objClass, false);
+			obj->isPending = true;
 			pendingObjects.push_back(obj);
 		}
 		id = obj->id;
@@ -282,6 +280,7 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 	PackageHeader ph;
 
 	stream = s;
+	collectClassSizes = LOG_IS_ENABLED(L_DEBUG);
 	unsigned startOffset = stream->tellp();
 	stream->write((char*)&ph, sizeof(PackageHeader));
 	stream->seekp(startOffset + sizeof(PackageHeader));
@@ -293,44 +292,54 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 	obj->classIndex = 0;
 
 	// Insert the first object that will provide references to everything
-	objects.emplace_back(rootObj, objects.size(), false, rootObjClass);
-	obj = &objects.back();
-	ptrToId[rootObj].push_back(obj);
+	obj = AddObjectRef(rootObj, rootObjClass, false);
+	obj->isPending = true;
 	pendingObjects.push_back(obj);
 
 	// Save until all the referenced objects have been stored
 	while (!pendingObjects.empty())
 	{
-		const std::vector<ObjectRef*> po = pendingObjects;
-		pendingObjects.clear();
+		savingObjects.clear();
+		std::swap(savingObjects, pendingObjects);
 
-		for (ObjectRef* obj: po) {
+		// objects serialized as instances in the meantime were dropped
+		savingObjects.erase(std::remove_if(savingObjects.begin(), savingObjects.end(), [](const ObjectRef* o) { return !o->isPending; }), savingObjects.end());
+
+		// none of these can be serialized as an instance from here on
+		for (ObjectRef* obj: savingObjects) {
+			obj->isPending = false;
+		}
+
+		for (ObjectRef* obj: savingObjects) {
 			SerializeObject(obj->class_, obj->ptr, obj);
 			//LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Serialized %s size:%i", obj->class_->name.c_str(), sz);
 		}
 	}
 
 	// Collect a set of all used classes
-	std::map<creg::Class*, ClassRef> classMap;
-	std::vector<ClassRef*> classRefs;
+	spring::unordered_map<creg::Class*, int> classMap;
+	std::vector<ClassRef> classRefs;
 	for (ObjectRef& oRef: objects) {
 		if (oRef.ptr == nullptr)
 			continue;
 
-		creg::Class* c = oRef.class_;
-		while (c) {
-			std::map<creg::Class*, ClassRef>::iterator cr = classMap.find(c);
-			if (cr == classMap.end()) {
-				ClassRef* pRef = &classMap[c];
-				pRef->index = classRefs.size();
-				pRef->class_ = c;
-				classRefs.push_back(pRef);
-			}
-			c = c->base();
+		const auto it = classMap.find(oRef.class_);
+
+		if (it != classMap.end()) {
+			oRef.classIndex = it->second;
+			continue;
+		}
+
+		// bases are registered along with their first subclass
+		for (creg::Class* c = oRef.class_; c != nullptr; c = c->base()) {
+			if (classMap.find(c) != classMap.end())
+				continue;
+
+			classMap[c] = classRefs.size();
+			classRefs.push_back({static_cast<int>(classRefs.size()), c});
 		}
 
-		std::map<creg::Class*, ClassRef>::iterator cr = classMap.find(oRef.class_);
-		oRef.classIndex = cr->second.index;
+		oRef.classIndex = classMap[oRef.class_];
 	}
 
 
@@ -349,9 +358,8 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 	// Write the class references & calc their checksum
 	ph.numObjClassRefs = classRefs.size();
 	ph.objClassRefOffset = (int)stream->tellp();
-	for (auto& classRef: classRefs) {
-		Class* c = classRef->class_;
-		WriteZStr(*stream, c->name);
+	for (const ClassRef& classRef: classRefs) {
+		WriteZStr(*stream, classRef.class_->name);
 	};
 
 	// Write object info
@@ -373,7 +381,7 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 			const auto it = ptrToId.find(container);
 			if (container == nullptr || it == ptrToId.end())
 				throw std::string("Preallocation container of (") + oRef.class_->name + ") doesn't exist";
-			ObjectRef* objCont = it->second.front();
+			ObjectRef* objCont = it->second;
 			// write container ID and offset of placement-new location
 			WriteVarSizeUInt(stream, objCont->id);
 			WriteVarSizeUInt(stream, (char*)oRef.ptr - (char*)container);
@@ -382,9 +390,8 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 
 	// Calculate a checksum for metadata verification
 	ph.metadataChecksum = 0;
-	for (auto& classRef: classRefs) {
-		Class* c = classRef->class_;
-		c->CalculateChecksum(ph.metadataChecksum);
+	for (const ClassRef& classRef: classRefs) {
+		classRef.class_->CalculateChecksum(ph.metadataChecksum);
 	}
 
 	int endOffset = stream->tellp();
@@ -400,8 +407,10 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 	stream->seekp(endOffset);
 	ptrToId.clear();
 	pendingObjects.clear();
+	savingObjects.clear();
 	objects.clear();
 	classSizes.clear();
+	classCounts.clear();
 }
 
 //-------------------------------------------------------------------------
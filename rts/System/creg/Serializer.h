@@ -5,10 +5,10 @@
 
 #include "ISerializer.h"
 #include "creg_cond.h"
+#include "System/UnorderedMap.hpp"
 
 #ifdef USING_CREG
 
-#include <map>
 #include <vector>
 #include <deque>
 #include <istream>
@@ -23,56 +23,31 @@ namespace creg {
 	class COutputStreamSerializer : public ISerializer
 	{
 	protected:
-		struct ObjectMember {
-			Class::Member* member;
-			int memberId;
-			int size;
-		};
-		struct ObjectMemberGroup {
-			Class* membersClass;
-			std::vector<COutputStreamSerializer::ObjectMember> members;
-			int size;
-		};
 		struct ObjectRef {
-			ObjectRef() {
-				ptr = 0;
-				id=0;
-				classIndex=0;
-				isEmbedded=false;
-				class_=0;
-			}
+			ObjectRef() = default;
 			ObjectRef(void* ptr, int id, bool isEmbedded, Class* class_) {
 				this->ptr = ptr;
-				this->id=id;
-				classIndex=0;
-				this->isEmbedded=isEmbedded;
-				this->class_=class_;
-			}
-			ObjectRef(const ObjectRef&src) :memberGroups(src.memberGroups){
-				ptr=src.ptr;
-				id=src.id;
-				classIndex=src.classIndex;
-				isEmbedded=src.isEmbedded;
-				class_=src.class_;
+				this->id = id;
+				this->isEmbedded = isEmbedded;
+				this->class_ = class_;
 			}
-			void* ptr;
-			int id, classIndex;
-			bool isEmbedded;
-			Class* class_;
-			std::vector<COutputStreamSerializer::ObjectMemberGroup> memberGroups;
+
+			void* ptr = nullptr;
+			int id = 0, classIndex = 0;
+			bool isEmbedded = false;
+			bool isPending = false;
+			Class* class_ = nullptr;
+			// next reference registered for the same address (e.g. the
+			// first member of an object, or an object through a base ptr)
+			ObjectRef* nextSamePtr = nullptr;
+
 			bool isThisObject(void* objPtr, Class* objClass, bool objEmbedded) const
 			{
 				if (ptr != objPtr) return false;
 				if (class_ == objClass) return true;
 				if (isEmbedded && objEmbedded) return false;
-				if (!objEmbedded) {
-					for (Class* base=class_->base(); base; base=base->base())
-						if (base == objClass) return true;
-				}
-				if (!isEmbedded) {
-					for (Class* base=objClass->base(); base; base=base->base())
-						if (base == class_) return true;
-				}
+				if (!objEmbedded && class_->IsSubclassOf(objClass)) return true;
+				if (!isEmbedded && objClass->IsSubclassOf(class_)) return true;
 				return false;
 			}
 		};
@@ -81,11 +56,15 @@ namespace creg {
 		struct ClassRef;
 
 		std::ostream* stream;
-		std::map<void*,std::vector<ObjectRef*> > ptrToId;
+		// first reference registered per address, the rest are chained
+		spring::unordered_map<void*, ObjectRef*> ptrToId;
 		std::deque<ObjectRef> objects;
-		std::vector<ObjectRef*> pendingObjects; // these objects still have to be saved
-		std::map<Class*, int> classSizes;
-		std::map<Class*, int> classCounts;
+		std::vector<ObjectRef*> pendingObjects; // these objects still have to be saved, unless isPending got cleared
+		std::vector<ObjectRef*> savingObjects;
+		// only collected if debug-logging is enabled
+		spring::unordered_map<Class*, int> classSizes;
+		spring::unordered_map<Class*, int> classCounts;
+		bool collectClassSizes = false;
 
 		// Serialize all class names
 		void WriteObjectInfo();
@@ -93,6 +72,7 @@ namespace creg {
 		void WriteObjectRef(void* inst, Class* cls, bool embedded);
 
 		ObjectRef* FindObjectRef(void* inst, Class* objClass, bool isEmbedded);
+		ObjectRef* AddObjectRef(void* inst, Class* objClass, bool isEmbedded);
 
 		void SerializeObject(Class* c, void* ptr, ObjectRef* objr);
 
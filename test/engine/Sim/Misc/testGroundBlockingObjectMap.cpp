@@ -0,0 +1,114 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Misc/GroundBlockingObjectMap.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <catch_amalgamated.hpp>
+
+// a map that is not a multiple of 64 squares wide, so rows carry padding bits
+static constexpr int MAP_X = 200;
+static constexpr int MAP_Z = 8;
+static constexpr int WORDS_PER_ROW = (MAP_X + 63) / 64;
+
+static std::vector<uint64_t> MakeBits(unsigned int seed, int density)
+{
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<int> dist(0, 99);
+	std::vector<uint64_t> bits(WORDS_PER_ROW * MAP_Z, 0);
+
+	for (int z = 0; z < MAP_Z; z++) {
+		for (int x = 0; x < MAP_X; x++) {
+			if (dist(rng) < density)
+				bits[z * WORDS_PER_ROW + (x >> 6)] |= (uint64_t(1) << (x & 63));
+		}
+	}
+
+	// set padding bits too, they must never be visited
+	for (int z = 0; z < MAP_Z; z++) {
+		bits[z * WORDS_PER_ROW + WORDS_PER_ROW - 1] |= (~uint64_t(0) << (MAP_X & 63));
+	}
+
+	return bits;
+}
+
+static std::vector<unsigned int> VisitNaive(const std::vector<uint64_t>& bits, int xmin, int xmax, int zmin, int zmax, int xstep, int zstep)
+{
+	std::vector<unsigned int> squares;
+
+	for (int z = zmin; z <= zmax; z += zstep) {
+		for (int x = xmin; x <= xmax; x += xstep) {
+			if ((bits[z * WORDS_PER_ROW + (x >> 6)] >> (x & 63)) & 1)
+				squares.push_back(z * MAP_X + x);
+		}
+	}
+
+	return squares;
+}
+
+static std::vector<unsigned int> VisitBits(const std::vector<uint64_t>& bits, int xmin, int xmax, int zmin, int zmax, int xstep, int zstep)
+{
+	std::vector<unsigned int> squares;
+
+	CGroundBlockingObjectMap::ForEachSetSquare(bits.data(), WORDS_PER_ROW, MAP_X, xmin, xmax, zmin, zmax, xstep, zstep, [&](unsigned int mapSquare) {
+		squares.push_back(mapSquare);
+		return false;
+	});
+
+	return squares;
+}
+
+TEST_CASE("ForEachOccupiedSquare")
+{
+	struct Range { int xmin; int xmax; };
+
+	const Range ranges[] = {
+		{  0,   0}, // single square
+		{  3,   9}, // odd xmin inside a word
+		{  4,  10}, // even xmin inside a word
+		{  0,  63}, // whole word, xmax & 63 == 63
+		{ 33,  63}, // odd xmin, xmax & 63 == 63
+		{ 60,  70}, // crosses a word edge
+		{ 61,  70}, // odd xmin crossing a word edge
+		{ 63,  64}, // last bit of one word, first of the next
+		{ 63, 127}, // odd xmin, xmax & 63 == 63 in the next word
+		{ 17, 191}, // spans three words, xmax & 63 == 63
+		{  1, 199}, // odd xmin up to the last square
+		{128, 199}, // last (partial) word only
+	};
+
+	for (const int density: {0, 5, 50, 100}) {
+		const std::vector<uint64_t> bits = MakeBits(1234 + density, density);
+
+		for (const Range& r: ranges) {
+			for (const int xstep: {1, 2}) {
+				for (const int zstep: {1, 2}) {
+					CAPTURE(density, r.xmin, r.xmax, xstep, zstep);
+					CHECK(VisitBits(bits, r.xmin, r.xmax, 1, MAP_Z - 1, xstep, zstep) == VisitNaive(bits, r.xmin, r.xmax, 1, MAP_Z - 1, xstep, zstep));
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("ForEachOccupiedSquareEarlyOut")
+{
+	const std::vector<uint64_t> bits = MakeBits(4321, 50);
+	const std::vector<unsigned int> squares = VisitNaive(bits, 5, 150, 0, MAP_Z - 1, 2, 1);
+
+	REQUIRE(squares.size() > 10);
+
+	std::vector<unsigned int> visited;
+
+	const bool ret = CGroundBlockingObjectMap::ForEachSetSquare(bits.data(), WORDS_PER_ROW, MAP_X, 5, 150, 0, MAP_Z - 1, 2, 1, [&](unsigned int mapSquare) {
+		visited.push_back(mapSquare);
+		return (visited.size() == 10);
+	});
+
+	CHECK(ret);
+	CHECK(visited == std::vector<unsigned int>(squares.begin(), squares.begin() + 10));
+
+	CHECK(!CGroundBlockingObjectMap::ForEachSetSquare(bits.data(), WORDS_PER_ROW, MAP_X, 5, 150, 0, MAP_Z - 1, 2, 1, [](unsigned int) { return false; }));
+}
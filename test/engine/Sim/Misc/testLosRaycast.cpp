@@ -0,0 +1,206 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Misc/LosRaycast.h"
+#include "System/SpringMath.h"
+#include "System/type2.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <catch_amalgamated.hpp>
+
+// A recorded scene can be replayed by the benchmark instead of the synthetic
+// one by pointing these at
+//   LOS_RAYCAST_HEIGHTMAP: raw little-endian float32 mip-heightmap, row-major
+//   LOS_RAYCAST_MAPSIZE:   its dimensions in LOS-map squares, as "<x>x<y>"
+//   LOS_RAYCAST_SOURCES:   one "<x> <y> <radius> <height>" line per instance
+//                          (LOS-map squares, elmos for the height)
+
+struct LosScene {
+	int2 size;
+	std::vector<float> heightMap;
+	std::vector<LosRaycast::Source> sources;
+
+	bool InUnsafeRect(const LosRaycast::Source& src) const {
+		return (src.pos.x >= src.radius && src.pos.x < (size.x - src.radius) && src.pos.y >= src.radius && src.pos.y < (size.y - src.radius));
+	}
+};
+
+
+static LosScene MakeSyntheticScene(int2 size, int numSources, int minRadius, int maxRadius)
+{
+	LosScene scene;
+	scene.size = size;
+	scene.heightMap.resize(size.x * size.y);
+
+	// rolling hills with some sharper ridges and a few sub-water areas
+	for (int y = 0; y < size.y; ++y) {
+		for (int x = 0; x < size.x; ++x) {
+			const float h =
+				120.0f * std::sin(x * 0.031f) * std::cos(y * 0.027f) +
+				 45.0f * std::sin(x * 0.173f + y * 0.091f) +
+				 15.0f * std::cos(x * 0.611f - y * 0.437f) +
+				 40.0f;
+
+			scene.heightMap[y * size.x + x] = h;
+		}
+	}
+
+	std::mt19937 rng(1234);
+
+	while (int(scene.sources.size()) < numSources) {
+		LosRaycast::Source src;
+		src.radius = std::uniform_int_distribution<int>(minRadius, maxRadius)(rng);
+		src.pos.x = std::uniform_int_distribution<int>(src.radius, size.x - src.radius - 1)(rng);
+		src.pos.y = std::uniform_int_distribution<int>(src.radius, size.y - src.radius - 1)(rng);
+		src.height = std::max(0.0f, scene.heightMap[src.pos.y * size.x + src.pos.x]) + std::uniform_real_distribution<float>(10.0f, 80.0f)(rng);
+
+		scene.sources.push_back(src);
+	}
+
+	return scene;
+}
+
+static bool LoadRecordedScene(LosScene& scene)
+{
+	const char* heightMapFile = std::getenv("LOS_RAYCAST_HEIGHTMAP");
+	const char* mapSizeStr = std::getenv("LOS_RAYCAST_MAPSIZE");
+	const char* sourcesFile = std::getenv("LOS_RAYCAST_SOURCES");
+
+	if (heightMapFile == nullptr || mapSizeStr == nullptr || sourcesFile == nullptr)
+		return false;
+
+	if (std::sscanf(mapSizeStr, "%dx%d", &scene.size.x, &scene.size.y) != 2)
+		return false;
+
+	scene.heightMap.resize(scene.size.x * scene.size.y);
+
+	if (FILE* f = std::fopen(heightMapFile, "rb"); f != nullptr) {
+		const size_t numRead = std::fread(scene.heightMap.data(), sizeof(float), scene.heightMap.size(), f);
+		std::fclose(f);
+
+		if (numRead != scene.heightMap.size())
+			return false;
+	} else {
+		return false;
+	}
+
+	if (FILE* f = std::fopen(sourcesFile, "r"); f != nullptr) {
+		LosRaycast::Source src;
+
+		while (std::fscanf(f, "%d %d %d %f", &src.pos.x, &src.pos.y, &src.radius, &src.height) == 4) {
+			// the border-clipping variant is not what is being measured
+			if (scene.InUnsafeRect(src))
+				scene.sources.push_back(src);
+		}
+
+		std::fclose(f);
+	} else {
+		return false;
+	}
+
+	return !scene.sources.empty();
+}
+
+static size_t CastAll(const LosScene& scene, LosRaycast::CastMode castMode)
+{
+	size_t numVisible = 0;
+
+	for (const LosRaycast::Source& src: scene.sources) {
+		const std::vector<char>& squares = LosRaycast::CastUnsafe(src, scene.size, scene.heightMap.data(), false, castMode);
+
+		for (const char visible: squares) {
+			numVisible += visible;
+		}
+	}
+
+	return numVisible;
+}
+
+
+
+TEST_CASE("LosRaycast")
+{
+	SECTION("flat terrain sees its whole circle") {
+		LosScene scene;
+		scene.size = {64, 64};
+		scene.heightMap.resize(64 * 64, 0.0f);
+
+		const LosRaycast::Source src = {{32, 32}, 20, 10.0f};
+
+		for (const auto castMode: {LosRaycast::CAST_MODE_SCALAR, LosRaycast::CAST_MODE_SIMD}) {
+			const std::vector<char>& squares = LosRaycast::CastUnsafe(src, scene.size, scene.heightMap.data(), false, castMode);
+
+			REQUIRE(squares.size() == size_t(Square(2 * src.radius + 1)));
+
+			for (int y = -src.radius; y <= src.radius; ++y) {
+				for (int x = -src.radius; x <= src.radius; ++x) {
+					const bool inCircle = (x * x + y * y) <= (src.radius * src.radius);
+					const bool visible = squares[(y + src.radius) * (2 * src.radius + 1) + (x + src.radius)];
+
+					// the midpoint circle may include a few squares just outside the exact radius
+					if (inCircle)
+						CHECK(visible);
+				}
+			}
+		}
+	}
+
+	SECTION("a wall hides what is behind it") {
+		LosScene scene;
+		scene.size = {64, 64};
+		scene.heightMap.resize(64 * 64, 0.0f);
+
+		for (int y = 0; y < 64; ++y) {
+			scene.heightMap[y * 64 + 36] = 500.0f;
+		}
+
+		const LosRaycast::Source src = {{32, 32}, 20, 10.0f};
+
+		for (const auto castMode: {LosRaycast::CAST_MODE_SCALAR, LosRaycast::CAST_MODE_SIMD}) {
+			const std::vector<char>& squares = LosRaycast::CastUnsafe(src, scene.size, scene.heightMap.data(), false, castMode);
+			const auto IsVisible = [&](int x, int y) { return squares[(y + src.radius) * (2 * src.radius + 1) + (x + src.radius)] != 0; };
+
+			CHECK( IsVisible( 4, 0));
+			CHECK(!IsVisible(10, 0));
+			CHECK( IsVisible(-10, 0));
+		}
+	}
+
+	SECTION("SIMD and scalar casts are identical") {
+		const LosScene scene = MakeSyntheticScene({512, 512}, 200, 1, 120);
+
+		std::vector<char> scalarSquares;
+
+		for (const LosRaycast::Source& src: scene.sources) {
+			scalarSquares = LosRaycast::CastUnsafe(src, scene.size, scene.heightMap.data(), false, LosRaycast::CAST_MODE_SCALAR);
+
+			const std::vector<char>& simdSquares = LosRaycast::CastUnsafe(src, scene.size, scene.heightMap.data(), false, LosRaycast::CAST_MODE_SIMD);
+
+			CHECK(scalarSquares == simdSquares);
+		}
+	}
+}
+
+
+TEST_CASE("LosRaycastBenchmark")
+{
+	LosScene scene;
+
+	if (!LoadRecordedScene(scene))
+		scene = MakeSyntheticScene({1024, 1024}, 500, 8, 96);
+
+	const size_t numVisibleScalar = CastAll(scene, LosRaycast::CAST_MODE_SCALAR);
+	const size_t numVisibleSIMD = CastAll(scene, LosRaycast::CAST_MODE_SIMD);
+
+	CHECK(numVisibleScalar == numVisibleSIMD);
+
+	BENCHMARK("Scalar") {
+		return CastAll(scene, LosRaycast::CAST_MODE_SCALAR);
+	};
+	BENCHMARK("SIMD") {
+		return CastAll(scene, LosRaycast::CAST_MODE_SIMD);
+	};
+}
@@ -1,8 +1,12 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include "Sim/Misc/QuadField.h"
+#include "Sim/Misc/QuadFieldSoA.h"
 #include "System/float3.h"
 #include "System/SpringMath.h"
+#include <array>
+#include <memory>
+#include <string>
 #include <stdlib.h>
 #include <time.h>
 
@@ -101,3 +105,179 @@ TEST_CASE("QuadField")
 	INFO("Too little quads returned!");
 	CHECK_FALSE(fail);
 }
+
+
+namespace {
+	struct BenchObject {
+		// pad to roughly sizeof(CFeature) so every candidate costs a cache-miss like in-engine
+		std::array<char, 1400> payload;
+
+		float3 pos;
+		float radius;
+		int tempNum;
+	};
+
+	struct BenchQuad {
+		std::vector<BenchObject*> objects;
+		QuadFieldSoA objectsSoA;
+	};
+
+	struct BenchField {
+		static constexpr int MAP_SIZE = 8192;
+		static constexpr int QUAD_SIZE = CQuadField::BASE_QUAD_SIZE;
+		static constexpr int NUM_QUADS = MAP_SIZE / QUAD_SIZE;
+
+		BenchField(size_t numObjects) {
+			quads.resize(NUM_QUADS * NUM_QUADS);
+			objects.resize(numObjects);
+
+			for (auto& o: objects) {
+				o = std::make_unique<BenchObject>();
+				o->pos = float3(randf() * MAP_SIZE, randf() * 100.0f, randf() * MAP_SIZE);
+				o->radius = 8.0f + randf() * 40.0f;
+				o->tempNum = 0;
+
+				// register in every quad the bounding square touches
+				const int x0 = Clamp<int>((o->pos.x - o->radius) / QUAD_SIZE, 0, NUM_QUADS - 1);
+				const int x1 = Clamp<int>((o->pos.x + o->radius) / QUAD_SIZE, 0, NUM_QUADS - 1);
+				const int z0 = Clamp<int>((o->pos.z - o->radius) / QUAD_SIZE, 0, NUM_QUADS - 1);
+				const int z1 = Clamp<int>((o->pos.z + o->radius) / QUAD_SIZE, 0, NUM_QUADS - 1);
+
+				for (int z = z0; z <= z1; ++z) {
+					for (int x = x0; x <= x1; ++x) {
+						BenchQuad& q = quads[z * NUM_QUADS + x];
+						q.objects.push_back(o.get());
+						q.objectsSoA.PushBack(o->pos.x, o->pos.z, o->radius);
+					}
+				}
+			}
+		}
+
+		template<typename F>
+		void ForEachQuad(const float3& pos, float radius, F&& f) const {
+			const int x0 = Clamp<int>((pos.x - radius) / QUAD_SIZE, 0, NUM_QUADS - 1);
+			const int x1 = Clamp<int>((pos.x + radius) / QUAD_SIZE, 0, NUM_QUADS - 1);
+			const int z0 = Clamp<int>((pos.z - radius) / QUAD_SIZE, 0, NUM_QUADS - 1);
+			const int z1 = Clamp<int>((pos.z + radius) / QUAD_SIZE, 0, NUM_QUADS - 1);
+
+			for (int z = z0; z <= z1; ++z) {
+				for (int x = x0; x <= x1; ++x) {
+					f(quads[z * NUM_QUADS + x]);
+				}
+			}
+		}
+
+		// mirrors the pre-SoA CQuadField::GetFeaturesExact loop
+		void QueryOld(const float3& pos, float radius, std::vector<BenchObject*>& result) {
+			++tempNum;
+			result.clear();
+
+			ForEachQuad(pos, radius, [&](const BenchQuad& q) {
+				for (BenchObject* o: q.objects) {
+					if (o->tempNum == tempNum)
+						continue;
+
+					o->tempNum = tempNum;
+
+					if (pos.SqDistance(o->pos) >= Square(radius + o->radius))
+						continue;
+
+					result.push_back(o);
+				}
+			});
+		}
+
+		void QueryNew(const float3& pos, float radius, std::vector<BenchObject*>& result) {
+			++tempNum;
+			result.clear();
+
+			ForEachQuad(pos, radius, [&](const BenchQuad& q) {
+				q.objectsSoA.Overlapping2D(pos.x, pos.z, radius, candidates);
+
+				for (const uint32_t ci: candidates) {
+					BenchObject* o = q.objects[ci];
+
+					if (o->tempNum == tempNum)
+						continue;
+
+					o->tempNum = tempNum;
+
+					if (pos.SqDistance(o->pos) >= Square(radius + o->radius))
+						continue;
+
+					result.push_back(o);
+				}
+			});
+		}
+
+		std::vector<BenchQuad> quads;
+		std::vector<std::unique_ptr<BenchObject>> objects;
+		std::vector<uint32_t> candidates;
+
+		int tempNum = 0;
+	};
+}
+
+TEST_CASE("QuadFieldSoA")
+{
+	srand( time(nullptr) );
+
+	QuadFieldSoA soa;
+
+	for (int i = 0; i < 37; ++i) {
+		soa.PushBack(i * 10.0f, 0.0f, 1.0f);
+	}
+
+	std::vector<uint32_t> indices;
+
+	// touches the entries at x=100 (d=5 < 6) and x=110 (d=5 < 6), not x=90 (d=15)
+	soa.Overlapping2D(105.0f, 0.0f, 5.0f, indices);
+	CHECK(indices == std::vector<uint32_t>{10, 11});
+
+	// the tail element (not a full SIMD batch) must be found as well
+	soa.Overlapping2D(360.0f, 0.0f, 0.5f, indices);
+	CHECK(indices == std::vector<uint32_t>{36});
+
+	// swap-and-pop: the last entry moves into the erased slot
+	soa.EraseAt(10);
+	soa.Overlapping2D(360.0f, 0.0f, 0.5f, indices);
+	CHECK(indices == std::vector<uint32_t>{10});
+	CHECK(soa.size() == 36);
+
+	for (const size_t numObjects: {1000, 10000, 50000}) {
+		BenchField field(numObjects);
+
+		std::vector<float3> queryPos(256);
+		std::vector<BenchObject*> resultOld;
+		std::vector<BenchObject*> resultNew;
+
+		for (float3& p: queryPos) {
+			p = float3(randf() * BenchField::MAP_SIZE, randf() * 100.0f, randf() * BenchField::MAP_SIZE);
+		}
+
+		// radius of a typical solid/collision query, well below the quad size
+		for (const float3& p: queryPos) {
+			field.QueryOld(p, 50.0f, resultOld);
+			field.QueryNew(p, 50.0f, resultNew);
+
+			CHECK(resultOld == resultNew);
+		}
+
+		BENCHMARK("GetObjectsExact::Old " + std::to_string(numObjects)) {
+			size_t n = 0;
+			for (const float3& p: queryPos) {
+				field.QueryOld(p, 50.0f, resultOld);
+				n += resultOld.size();
+			}
+			return n;
+		};
+		BENCHMARK("GetObjectsExact::SoA " + std::to_string(numObjects)) {
+			size_t n = 0;
+			for (const float3& p: queryPos) {
+				field.QueryNew(p, 50.0f, resultNew);
+				n += resultNew.size();
+			}
+			return n;
+		};
+	}
+}
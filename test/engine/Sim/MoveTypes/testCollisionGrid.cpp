@@ -0,0 +1,104 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/MoveTypes/Utils/CollisionGrid.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <catch_amalgamated.hpp>
+
+using namespace MoveTypes;
+
+
+struct TestObject {
+	float3 pos;
+	float radius;
+};
+
+static std::vector<TestObject> MakeObjects(size_t count, float sizeX, float sizeZ, float maxRadius, unsigned int seed)
+{
+	std::mt19937 rng(seed);
+	// some objects slightly off-map, like units being pushed around the edges
+	std::uniform_real_distribution<float> distX(-50.0f, sizeX + 50.0f);
+	std::uniform_real_distribution<float> distZ(-50.0f, sizeZ + 50.0f);
+	std::uniform_real_distribution<float> distY(0.0f, 100.0f);
+	std::uniform_real_distribution<float> distR(1.0f, maxRadius);
+
+	std::vector<TestObject> objects(count);
+
+	for (TestObject& o: objects) {
+		o.pos = {distX(rng), distY(rng), distZ(rng)};
+		o.radius = distR(rng);
+	}
+
+	return objects;
+}
+
+static CollisionGrid<TestObject> MakeGrid(std::vector<TestObject>& objects, float sizeX, float sizeZ, float cellSize)
+{
+	CollisionGrid<TestObject> grid;
+	grid.Init(sizeX, sizeZ, cellSize);
+	grid.Reset(objects.size());
+
+	for (size_t i = 0; i < objects.size(); i++) {
+		grid.SetObject(i, &objects[i]);
+	}
+
+	grid.Finalize();
+	return grid;
+}
+
+
+TEST_CASE("CollisionGridMatchesBruteForce")
+{
+	constexpr float SIZE_X = 2048.0f;
+	constexpr float SIZE_Z = 1024.0f;
+
+	for (const float cellSize: {32.0f, 64.0f, 128.0f}) {
+		std::vector<TestObject> objects = MakeObjects(2000, SIZE_X, SIZE_Z, 150.0f, 1234);
+		const CollisionGrid<TestObject> grid = MakeGrid(objects, SIZE_X, SIZE_Z, cellSize);
+
+		for (const TestObject& q: MakeObjects(200, SIZE_X, SIZE_Z, 100.0f, 5678)) {
+			std::vector<const TestObject*> expected;
+			std::vector<const TestObject*> found;
+
+			for (const TestObject& o: objects) {
+				if (q.pos.SqDistance(o.pos) < Square(q.radius + o.radius))
+					expected.push_back(&o);
+			}
+
+			grid.ForEachInRange(q.pos, q.radius, [&](const TestObject* o) { found.push_back(o); });
+
+			// every object is reported once
+			std::sort(found.begin(), found.end());
+			CHECK(std::adjacent_find(found.begin(), found.end()) == found.end());
+
+			std::sort(expected.begin(), expected.end());
+			CHECK(found == expected);
+		}
+	}
+}
+
+TEST_CASE("CollisionGridRebuild")
+{
+	std::vector<TestObject> objects = {{{100.0f, 0.0f, 100.0f}, 10.0f}};
+	CollisionGrid<TestObject> grid = MakeGrid(objects, 512.0f, 512.0f, 64.0f);
+
+	int count = 0;
+	grid.ForEachInRange({100.0f, 0.0f, 100.0f}, 1.0f, [&](const TestObject*) { count++; });
+	CHECK(count == 1);
+
+	// moved objects are only found at their new position after a rebuild
+	objects[0].pos = {400.0f, 0.0f, 400.0f};
+	grid.Reset(objects.size());
+	grid.SetObject(0, &objects[0]);
+	grid.Finalize();
+
+	count = 0;
+	grid.ForEachInRange({100.0f, 0.0f, 100.0f}, 1.0f, [&](const TestObject*) { count++; });
+	CHECK(count == 0);
+
+	grid.ForEachInRange({400.0f, 0.0f, 400.0f}, 1.0f, [&](const TestObject*) { count++; });
+	CHECK(count == 1);
+}
@@ -0,0 +1,235 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Path/QTPFS/SearchQueue.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <catch_amalgamated.hpp>
+
+using namespace QTPFS;
+
+
+// A* over an 8-connected grid with per-square move costs, using the same
+// lazy-deletion scheme as QTPFS::PathSearch: improved nodes are pushed again
+// and stale queue entries skipped when popped
+struct GridSearch {
+	GridSearch(int size, unsigned int seed): size(size) {
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<float> noise(0.0f, 1.0f);
+
+		costs.resize(size * size);
+		gCosts.resize(size * size);
+
+		for (int z = 0; z < size; ++z) {
+			for (int x = 0; x < size; ++x) {
+				// rolling terrain with some impassable ridges
+				const float h = std::sin(x * 0.02f) * std::cos(z * 0.03f) + 0.3f * noise(rng);
+				costs[z * size + x] = (h > 0.9f)? std::numeric_limits<float>::infinity(): (1.0f + h * h * 4.0f);
+			}
+		}
+	}
+
+	float Heuristic(int idx, int tgtIdx) const {
+		const float dx = float(idx % size - tgtIdx % size);
+		const float dz = float(idx / size - tgtIdx / size);
+		// slightly inflated like hCostMult, makes the heuristic inconsistent
+		return std::sqrt(dx * dx + dz * dz) * 1.1f;
+	}
+
+	template<typename Queue>
+	size_t Execute(Queue& openNodes, int srcIdx, int tgtIdx, float* pathCost) {
+		std::fill(gCosts.begin(), gCosts.end(), std::numeric_limits<float>::infinity());
+
+		while (!openNodes.empty())
+			openNodes.pop();
+
+		size_t numExpanded = 0;
+
+		gCosts[srcIdx] = 0.0f;
+		openNodes.emplace(srcIdx, Heuristic(srcIdx, tgtIdx));
+
+		while (!openNodes.empty()) {
+			const SearchQueueNode curNode = openNodes.top();
+			openNodes.pop();
+
+			const int curIdx = curNode.nodeIndex;
+
+			if (curNode.heapPriority > gCosts[curIdx] + Heuristic(curIdx, tgtIdx))
+				continue;
+
+			numExpanded += 1;
+
+			if (curIdx == tgtIdx)
+				break;
+
+			const int cx = curIdx % size;
+			const int cz = curIdx / size;
+
+			for (int dz = -1; dz <= 1; ++dz) {
+				for (int dx = -1; dx <= 1; ++dx) {
+					const int nx = cx + dx;
+					const int nz = cz + dz;
+
+					if ((dx | dz) == 0 || nx < 0 || nz < 0 || nx >= size || nz >= size)
+						continue;
+
+					const int nxtIdx = nz * size + nx;
+					const float stepCost = costs[nxtIdx] * (((dx & dz) != 0)? 1.41421356f: 1.0f);
+					const float gCost = gCosts[curIdx] + stepCost;
+
+					if (!(gCost < gCosts[nxtIdx]))
+						continue;
+
+					gCosts[nxtIdx] = gCost;
+					openNodes.emplace(nxtIdx, gCost + Heuristic(nxtIdx, tgtIdx));
+				}
+			}
+		}
+
+		*pathCost = gCosts[tgtIdx];
+		return numExpanded;
+	}
+
+	int size;
+
+	std::vector<float> costs;
+	std::vector<float> gCosts;
+};
+
+struct SearchEndPoints {
+	int srcIdx;
+	int tgtIdx;
+};
+
+static std::vector<SearchEndPoints> MakeSearches(const GridSearch& grid, int numSearches, unsigned int seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<int> pos(0, grid.size * grid.size - 1);
+	std::vector<SearchEndPoints> searches;
+
+	while (int(searches.size()) < numSearches) {
+		const SearchEndPoints sep = {pos(rng), pos(rng)};
+
+		if (std::isinf(grid.costs[sep.srcIdx]) || std::isinf(grid.costs[sep.tgtIdx]))
+			continue;
+
+		searches.push_back(sep);
+	}
+
+	return searches;
+}
+
+template<typename Queue>
+static size_t ExecuteSearches(GridSearch& grid, Queue& queue, const std::vector<SearchEndPoints>& searches, std::vector<float>* pathCosts = nullptr)
+{
+	size_t numExpanded = 0;
+
+	for (const SearchEndPoints& sep: searches) {
+		float pathCost = 0.0f;
+		numExpanded += grid.Execute(queue, sep.srcIdx, sep.tgtIdx, &pathCost);
+
+		if (pathCosts != nullptr)
+			pathCosts->push_back(pathCost);
+	}
+
+	return numExpanded;
+}
+
+
+
+TEST_CASE("SearchQueue")
+{
+	std::mt19937 rng(4321);
+
+	SECTION("pop order matches the binary heap") {
+		BinarySearchQueue binaryQueue;
+		BucketedSearchQueue bucketedQueue;
+
+		std::uniform_int_distribution<int> indexDist(0, 1000);
+		std::uniform_real_distribution<float> unitDist(0.0f, 1.0f);
+
+		float curMin = 0.0f;
+
+		for (int i = 0; i < 200000; ++i) {
+			const float r = unitDist(rng);
+
+			if (r < 0.55f || binaryQueue.empty()) {
+				// mostly slightly above the current minimum, sometimes below it (inconsistent
+				// heuristics), far above it, or unreachable; indices repeat to force ties
+				float prio = curMin + unitDist(rng) * 50.0f;
+
+				if (r < 0.05f)
+					prio = curMin - unitDist(rng) * 10.0f;
+				else if (r < 0.08f)
+					prio = curMin + unitDist(rng) * 100000.0f;
+				else if (r < 0.09f)
+					prio = std::numeric_limits<float>::infinity();
+
+				const SearchQueueNode n(indexDist(rng), prio);
+
+				binaryQueue.push(n);
+				bucketedQueue.push(n);
+			} else {
+				REQUIRE(bucketedQueue.top().heapPriority == binaryQueue.top().heapPriority);
+				REQUIRE(bucketedQueue.top().nodeIndex == binaryQueue.top().nodeIndex);
+
+				if (std::isfinite(binaryQueue.top().heapPriority))
+					curMin = binaryQueue.top().heapPriority;
+
+				binaryQueue.pop();
+				bucketedQueue.pop();
+			}
+
+			REQUIRE(bucketedQueue.size() == binaryQueue.size());
+		}
+
+		while (!binaryQueue.empty()) {
+			REQUIRE(bucketedQueue.top().heapPriority == binaryQueue.top().heapPriority);
+			REQUIRE(bucketedQueue.top().nodeIndex == binaryQueue.top().nodeIndex);
+
+			binaryQueue.pop();
+			bucketedQueue.pop();
+		}
+
+		CHECK(bucketedQueue.empty());
+	}
+
+	SECTION("identical A* results") {
+		GridSearch grid(256, 99);
+
+		const std::vector<SearchEndPoints> searches = MakeSearches(grid, 50, 7);
+
+		BinarySearchQueue binaryQueue;
+		BucketedSearchQueue bucketedQueue;
+
+		std::vector<float> binaryCosts;
+		std::vector<float> bucketedCosts;
+
+		const size_t binaryExpanded = ExecuteSearches(grid, binaryQueue, searches, &binaryCosts);
+		const size_t bucketedExpanded = ExecuteSearches(grid, bucketedQueue, searches, &bucketedCosts);
+
+		CHECK(binaryExpanded == bucketedExpanded);
+		CHECK(binaryCosts == bucketedCosts);
+	}
+}
+
+
+TEST_CASE("SearchQueueBenchmark")
+{
+	GridSearch grid(1024, 1234);
+
+	const std::vector<SearchEndPoints> searches = MakeSearches(grid, 20, 5678);
+
+	BinarySearchQueue binaryQueue;
+	BucketedSearchQueue bucketedQueue;
+
+	BENCHMARK("BinarySearchQueue") {
+		return ExecuteSearches(grid, binaryQueue, searches);
+	};
+	BENCHMARK("BucketedSearchQueue") {
+		return ExecuteSearches(grid, bucketedQueue, searches);
+	};
+}
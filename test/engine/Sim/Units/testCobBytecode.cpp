@@ -0,0 +1,155 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Units/Scripts/CobBytecode.h"
+#include "Sim/Units/Scripts/CobOpcodes.h"
+
+#include <string>
+#include <vector>
+
+#include <catch_amalgamated.hpp>
+
+using namespace CobBytecode;
+
+
+struct TestScript {
+	TestScript(std::vector<int> code_): code(std::move(code_)) {
+		Decode(code, scriptNames, scriptLengths, insns);
+	}
+
+	const Insn& At(int pc) const { return insns.at(pc); }
+	int Sentinel() const { return static_cast<int>(code.size()); }
+
+	std::vector<int> code;
+	std::vector<std::string> scriptNames = {"Create", "lua_Foo", "Empty"};
+	std::vector<int> scriptLengths = {10, 5, 0};
+	std::vector<Insn> insns;
+};
+
+
+TEST_CASE("CobBytecodeLayout")
+{
+	const TestScript ts({PUSH_CONSTANT, 7, ADD, RETURN});
+
+	// one entry per code word plus the sentinel
+	CHECK(ts.insns.size() == ts.code.size() + 1);
+	CHECK(ts.At(ts.Sentinel()).op == OP_INVALID);
+	CHECK(ts.At(ts.Sentinel()).arg[1] == INVALID_PC);
+
+	CHECK(ts.At(0).op == OP_PUSH_CONSTANT);
+	CHECK(ts.At(0).arg[0] == 7);
+	CHECK(ts.At(0).next == 2);
+
+	// operand word decoded as if an instruction started there
+	CHECK(ts.At(1).op == OP_INVALID);
+	CHECK(ts.At(1).arg[1] == INVALID_OPCODE);
+
+	CHECK(ts.At(2).op == OP_ADD);
+	CHECK(ts.At(2).next == 3);
+	CHECK(ts.At(3).op == OP_RETURN);
+}
+
+TEST_CASE("CobBytecodeOperands")
+{
+	const TestScript ts({MOVE, 3, 1, SHADE, 5, EMIT_SFX, 2, SPIN});
+
+	CHECK(ts.At(0).op == OP_MOVE);
+	CHECK(ts.At(0).arg[0] == 3);
+	CHECK(ts.At(0).arg[1] == 1);
+	CHECK(ts.At(0).next == 3);
+
+	// no-op instructions still skip their operand
+	CHECK(ts.At(3).op == OP_NOP);
+	CHECK(ts.At(3).next == 5);
+
+	CHECK(ts.At(5).op == OP_EMIT_SFX);
+	CHECK(ts.At(5).arg[0] == 2);
+
+	// operands would run past the end of the code
+	CHECK(ts.At(7).op == OP_INVALID);
+	CHECK(ts.At(7).arg[0] == SPIN);
+	CHECK(ts.At(7).arg[1] == INVALID_OPERANDS);
+}
+
+TEST_CASE("CobBytecodeJumps")
+{
+	const TestScript ts({JUMP, 4, JUMP, 1000, JUMP_NOT_EQUAL, -1, RETURN});
+
+	CHECK(ts.At(0).op == OP_JUMP);
+	CHECK(ts.At(0).arg[0] == 4);
+
+	// out-of-range targets land on the sentinel
+	CHECK(ts.At(2).arg[0] == ts.Sentinel());
+	CHECK(ts.At(4).op == OP_JUMP_NOT_EQUAL);
+	CHECK(ts.At(4).arg[0] == ts.Sentinel());
+}
+
+TEST_CASE("CobBytecodeCalls")
+{
+	const TestScript ts({CALL, 0, 2, CALL, 1, 3, CALL, 2, 0, START, 2, 1, START, 0, 0, REAL_CALL, 9, 0});
+
+	CHECK(ts.At(0).op == OP_REAL_CALL);
+	CHECK(ts.At(0).arg[0] == 0);
+	CHECK(ts.At(0).arg[1] == 2);
+
+	// resolved to a Lua call by script name
+	CHECK(ts.At(3).op == OP_LUA_CALL);
+	CHECK(ts.At(3).arg[0] == 1);
+	CHECK(ts.At(3).arg[1] == 3);
+
+	// zero-length functions are never called nor started
+	CHECK(ts.At(6).op == OP_NOP);
+	CHECK(ts.At(6).next == 9);
+	CHECK(ts.At(9).op == OP_NOP);
+	CHECK(ts.At(9).next == 12);
+
+	CHECK(ts.At(12).op == OP_START);
+
+	CHECK(ts.At(15).op == OP_INVALID);
+	CHECK(ts.At(15).arg[1] == INVALID_FUNCTION);
+}
+
+TEST_CASE("CobBytecodeFusion")
+{
+	const TestScript ts({
+		PUSH_CONSTANT, 100, SLEEP,                            // 0
+		PUSH_CONSTANT, 1, PUSH_CONSTANT, 2, ADD,              // 3
+		PUSH_LOCAL_VAR, 0, PUSH_CONSTANT, 5, SET_LESS,        // 8
+		JUMP_NOT_EQUAL, 0,                                    // 13
+		SET_EQUAL, JUMP_NOT_EQUAL, 3,                         // 15
+		RETURN,                                               // 18
+	});
+
+	CHECK(ts.At(0).op == OP_PUSH_CONSTANT_SLEEP);
+	CHECK(ts.At(0).arg[0] == 100);
+	CHECK(ts.At(0).next == 3);
+
+	CHECK(ts.At(3).op == OP_PUSH_CONSTANT_PUSH_CONSTANT);
+	CHECK(ts.At(3).arg[0] == 1);
+	CHECK(ts.At(3).arg[1] == 2);
+	CHECK(ts.At(3).next == 7);
+
+	// the second half of a pair keeps its own entry for jumps into it
+	CHECK(ts.At(5).op == OP_PUSH_CONSTANT);
+	CHECK(ts.At(5).arg[0] == 2);
+	CHECK(ts.At(5).next == 7);
+
+	CHECK(ts.At(8).op == OP_PUSH_LOCAL_VAR_PUSH_CONSTANT);
+	CHECK(ts.At(8).arg[0] == 0);
+	CHECK(ts.At(8).arg[1] == 5);
+	CHECK(ts.At(8).next == 12);
+
+	CHECK(ts.At(12).op == OP_SET_LESS_JUMP);
+	CHECK(ts.At(12).arg[0] == 0);
+	CHECK(ts.At(12).next == 15);
+
+	CHECK(ts.At(15).op == OP_SET_EQUAL_JUMP);
+	CHECK(ts.At(15).arg[0] == 3);
+	CHECK(ts.At(15).next == 18);
+}
+
+TEST_CASE("CobBytecodeOpNames")
+{
+	CHECK(std::string(GetOpName(OP_INVALID)) == "INVALID");
+	CHECK(std::string(GetOpName(OP_SET_NOT_EQUAL_JUMP)) == "SET_NOT_EQUAL_JUMP");
+	CHECK(std::string(GetOpName(OP_COUNT)) == "UNKNOWN");
+}
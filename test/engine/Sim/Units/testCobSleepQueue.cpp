@@ -0,0 +1,152 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Units/Scripts/CobSleepQueue.h"
+
+#include <random>
+#include <vector>
+
+#include <catch_amalgamated.hpp>
+
+using SleepingThread = CCobSleepQueue::SleepingThread;
+using SleepingThreadHeap = CCobSleepQueue::SleepingThreadHeap;
+
+
+// drives the wheel and the plain heap CCobEngine used before with the same
+// sequence of sleeps, re-sleeping every woken thread from inside the wakeup
+// loop like CCobThread::Tick does, and returns whether both woke up the same
+// threads in the same order
+static bool CompareWakeups(int numThreads, int numTicks, int minSleep, int maxSleep, unsigned seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<int> sleepDist(minSleep, maxSleep);
+
+	CCobSleepQueue wheel;
+	SleepingThreadHeap heap;
+
+	wheel.Clear();
+
+	int currentTime = 0;
+	int threadCounter = 0;
+
+	for (int i = 0; i < numThreads; i++) {
+		const SleepingThread st = {threadCounter++, sleepDist(rng)};
+		wheel.Push(st);
+		heap.push(st);
+	}
+
+	std::vector<SleepingThread> wheelOrder;
+	std::vector<SleepingThread> heapOrder;
+
+	// both loops consume the same random sleeps, so draw them in advance
+	std::vector<int> sleeps;
+
+	for (int tick = 0; tick < numTicks; tick++) {
+		currentTime += 33;
+
+		wheelOrder.clear();
+		heapOrder.clear();
+		sleeps.clear();
+
+		for (wheel.Advance(currentTime); wheel.HasDue(); ) {
+			wheelOrder.push_back(wheel.PopDue());
+
+			if (sleeps.size() < wheelOrder.size())
+				sleeps.push_back(sleepDist(rng));
+
+			wheel.Push({wheelOrder.back().id, currentTime + sleeps[wheelOrder.size() - 1]});
+		}
+
+		while (!heap.empty() && heap.top().wt < currentTime) {
+			heapOrder.push_back(heap.top());
+			heap.pop();
+
+			if (sleeps.size() < heapOrder.size())
+				sleeps.push_back(sleepDist(rng));
+
+			heap.push({heapOrder.back().id, currentTime + sleeps[heapOrder.size() - 1]});
+		}
+
+		if (wheelOrder.size() != heapOrder.size())
+			return false;
+
+		for (size_t i = 0; i < wheelOrder.size(); i++) {
+			if (wheelOrder[i].id != heapOrder[i].id || wheelOrder[i].wt != heapOrder[i].wt)
+				return false;
+		}
+
+		if (wheel.size() != static_cast<int>(heap.size()))
+			return false;
+	}
+
+	return true;
+}
+
+
+TEST_CASE("CobSleepQueueOrder")
+{
+	CCobSleepQueue queue;
+	queue.Clear();
+
+	queue.Push({3, 100});
+	queue.Push({1, 100});
+	queue.Push({2,  50});
+	queue.Push({0, 200});
+	CHECK(queue.size() == 4);
+
+	// wake-times are exclusive
+	queue.Advance(50);
+	CHECK(!queue.HasDue());
+
+	queue.Advance(101);
+	REQUIRE(queue.HasDue());
+	CHECK(queue.PopDue().id == 2);
+	CHECK(queue.PopDue().id == 1);
+
+	// a negative sleep pushed mid-batch is handed out before the rest
+	queue.Push({5, 60});
+	CHECK(queue.PopDue().id == 5);
+	CHECK(queue.PopDue().id == 3);
+	CHECK(!queue.HasDue());
+	CHECK(queue.size() == 1);
+}
+
+TEST_CASE("CobSleepQueueHorizon")
+{
+	CCobSleepQueue queue;
+	queue.Clear();
+
+	constexpr int horizon = CCobSleepQueue::SLOT_WIDTH * CCobSleepQueue::WHEEL_SIZE;
+
+	queue.Push({0, horizon * 3 + 7});
+	queue.Push({1, horizon - 1});
+	queue.Push({2, horizon * 3 + 7});
+
+	queue.Advance(horizon);
+	REQUIRE(queue.HasDue());
+	CHECK(queue.PopDue().id == 1);
+	CHECK(!queue.HasDue());
+
+	queue.Advance(horizon * 3 + 7);
+	CHECK(!queue.HasDue());
+
+	// skipping past the whole wheel at once
+	queue.Advance(horizon * 5);
+	CHECK(queue.PopDue().id == 0);
+	CHECK(queue.PopDue().id == 2);
+	CHECK(queue.empty());
+
+	const auto threads = (queue.Push({4, horizon * 9}), queue.Push({3, horizon * 5}), queue.GetSortedThreads());
+	REQUIRE(threads.size() == 2);
+	CHECK(threads[0].id == 3);
+	CHECK(threads[1].id == 4);
+}
+
+TEST_CASE("CobSleepQueueMatchesHeap")
+{
+	// short sleeps that stay within the wheel
+	CHECK(CompareWakeups(5000, 300, 0, 2000, 1));
+	// sleeps that cross the wheel's horizon
+	CHECK(CompareWakeups(5000, 300, 0, 200000, 2));
+	// negative and zero sleeps that are due within the same tick
+	CHECK(CompareWakeups(1000, 300, -100, 100, 3));
+}
@@ -0,0 +1,146 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/creg/creg_cond.h"
+#include "System/creg/Serializer.h"
+#include "System/creg/STL_Deque.h"
+
+#include <benchmark/benchmark.h>
+
+#include <deque>
+#include <random>
+#include <sstream>
+#include <vector>
+
+// saves and loads an object graph shaped like a late-game state: many
+// objects referencing each other, through pointers to the object itself,
+// to its base class and to embedded members
+namespace {
+	struct BenchEmbedded {
+		CR_DECLARE_STRUCT(BenchEmbedded)
+		int value = 0;
+	};
+
+	struct BenchBase {
+		CR_DECLARE(BenchBase)
+		virtual ~BenchBase() = default;
+
+		int id = 0;
+	};
+
+	struct BenchObj: public BenchBase {
+		CR_DECLARE(BenchObj)
+
+		float health = 0.0f;
+		std::vector<int> data;
+
+		BenchEmbedded embedded;
+
+		BenchObj* target = nullptr;
+		BenchBase* owner = nullptr;
+		BenchEmbedded* embeddedPtr = nullptr;
+	};
+
+	struct BenchRoot {
+		CR_DECLARE_STRUCT(BenchRoot)
+		std::deque<BenchObj> objects;
+	};
+}
+
+CR_BIND(BenchEmbedded, )
+CR_REG_METADATA(BenchEmbedded, CR_MEMBER(value))
+
+CR_BIND(BenchBase, )
+CR_REG_METADATA(BenchBase, CR_MEMBER(id))
+
+CR_BIND_DERIVED(BenchObj, BenchBase, )
+CR_REG_METADATA(BenchObj, (
+	CR_MEMBER(health),
+	CR_MEMBER(data),
+	CR_MEMBER(embedded),
+	CR_MEMBER(target),
+	CR_MEMBER(owner),
+	CR_MEMBER(embeddedPtr)
+))
+
+CR_BIND(BenchRoot, )
+CR_REG_METADATA(BenchRoot, CR_MEMBER(objects))
+
+
+static void MakeState(BenchRoot& root, size_t numObjects)
+{
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<size_t> dist(0, numObjects - 1);
+
+	root.objects.resize(numObjects);
+
+	for (size_t i = 0; i < numObjects; i++) {
+		BenchObj& o = root.objects[i];
+
+		o.id = i;
+		o.health = i * 0.5f;
+		o.data.assign(i % 8, i);
+		o.embedded.value = i;
+
+		o.target = &root.objects[dist(rng)];
+		o.owner = &root.objects[dist(rng)];
+		o.embeddedPtr = &root.objects[dist(rng)].embedded;
+	}
+}
+
+
+static void BenchCregSave(benchmark::State& state)
+{
+	BenchRoot root;
+	MakeState(root, state.range(0));
+
+	size_t size = 0;
+
+	for (auto _ : state) {
+		std::stringstream oss;
+
+		creg::COutputStreamSerializer os;
+		os.SavePackage(&oss, &root, root.GetClass());
+
+		size = oss.tellp();
+	}
+
+	state.counters["size_MB"] = size / (1024.0 * 1024.0);
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BenchCregLoad(benchmark::State& state)
+{
+	std::stringstream oss;
+
+	{
+		BenchRoot root;
+		MakeState(root, state.range(0));
+
+		creg::COutputStreamSerializer os;
+		os.SavePackage(&oss, &root, root.GetClass());
+	}
+
+	const std::string data = oss.str();
+
+	for (auto _ : state) {
+		std::stringstream iss(data);
+
+		void* root = nullptr;
+		creg::Class* rootCls = nullptr;
+
+		creg::CInputStreamSerializer is;
+		is.LoadPackage(&iss, root, rootCls);
+
+		state.PauseTiming();
+		delete static_cast<BenchRoot*>(root);
+		state.ResumeTiming();
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// {number of objects}
+BENCHMARK(BenchCregSave)->Arg(10000)->Arg(100000)->Arg(500000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BenchCregLoad)->Arg(10000)->Arg(100000)->Arg(500000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,179 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/LoadSave/ChunkedStreamBuf.h"
+
+#include <cstdio>
+#include <istream>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include <zlib.h>
+
+#include <catch_amalgamated.hpp>
+
+static std::string MakeData(size_t size, unsigned seed)
+{
+	std::mt19937 rng(seed);
+	std::string data(size, 0);
+
+	// compressible, but not trivially so
+	for (char& c: data) {
+		c = 'a' + (rng() % 8);
+	}
+
+	return data;
+}
+
+
+TEST_CASE("ChunkedStreamBufSeek")
+{
+	CChunkedStreamBuf buf;
+	std::iostream cs(&buf);
+	std::stringstream ss;
+
+	const std::string data = MakeData(CChunkedStreamBuf::CHUNK_SIZE * 2 + 123, 1);
+
+	// patch a header after writing past several chunk boundaries, like
+	// creg::COutputStreamSerializer::SavePackage does
+	for (std::ostream* os: {static_cast<std::ostream*>(&cs), static_cast<std::ostream*>(&ss)}) {
+		const std::streampos start = os->tellp();
+
+		os->write("HDR0", 4);
+		os->write(data.data(), data.size());
+
+		const std::streampos end = os->tellp();
+
+		os->seekp(start);
+		os->write("HDR1", 4);
+		os->seekp(CChunkedStreamBuf::CHUNK_SIZE - 2);
+		os->write("span", 4);
+		os->seekp(end);
+		os->write("tail", 4);
+	}
+
+	CHECK(cs.tellp() == ss.tellp());
+	CHECK(buf.GetSize() == ss.str().size());
+	CHECK(buf.GetNumChunks() == 3);
+
+	// seeking past the end fails
+	CHECK(buf.pubseekpos(buf.GetSize() + 1, std::ios_base::out) == std::streampos(-1));
+
+	std::string read(buf.GetSize(), 0);
+	cs.read(read.data(), read.size());
+	CHECK(cs.gcount() == static_cast<std::streamsize>(read.size()));
+	CHECK(read == ss.str());
+
+	// data that was written after the get area was set up is still read
+	cs.clear();
+	cs.write("more", 4);
+
+	char more[4];
+	CHECK(cs.read(more, 4));
+	CHECK(std::string(more, 4) == "more");
+	CHECK(cs.get() == std::char_traits<char>::eof());
+
+	cs.clear();
+	cs.seekg(CChunkedStreamBuf::CHUNK_SIZE - 2);
+	CHECK(cs.read(more, 4));
+	CHECK(std::string(more, 4) == "span");
+}
+
+TEST_CASE("ChunkedStreamBufGZip")
+{
+	const std::string path = "testChunkedStreamBuf.gz";
+	const std::string data = MakeData(CChunkedStreamBuf::CHUNK_SIZE * 3 + 4567, 2);
+
+	{
+		CChunkedStreamBuf buf;
+		buf.sputn(data.data(), data.size());
+
+		REQUIRE(ChunkedGZ::WriteFile(path, buf, 5, 2));
+	}
+	{
+		CChunkedStreamBuf buf;
+		std::istream is(&buf);
+
+		REQUIRE(ChunkedGZ::ReadFile(path, buf));
+		REQUIRE(buf.GetSize() == data.size());
+
+		std::string read(data.size(), 0);
+		is.read(read.data(), read.size());
+		CHECK(read == data);
+	}
+	{
+		// plain zlib reads the concatenated members as one stream
+		gzFile file = gzopen(path.c_str(), "rb");
+		REQUIRE(file != nullptr);
+
+		std::string read(data.size() + 1, 0);
+		CHECK(gzread(file, read.data(), read.size()) == static_cast<int>(data.size()));
+		gzclose(file);
+
+		read.resize(data.size());
+		CHECK(read == data);
+	}
+
+	std::remove(path.c_str());
+}
+
+TEST_CASE("ChunkedStreamBufCompress")
+{
+	const std::string data = MakeData(CChunkedStreamBuf::CHUNK_SIZE + 89, 3);
+
+	CChunkedStreamBuf buf;
+	buf.sputn(data.data(), data.size());
+
+	std::string compressed;
+	REQUIRE(ChunkedGZ::Compress(buf, 1, 2, compressed));
+	CHECK(compressed.size() < data.size());
+
+	// same bytes as a file written by WriteFile, i.e. a valid gzip stream
+	z_stream zs = {};
+	REQUIRE(inflateInit2(&zs, 15 + 16) == Z_OK);
+
+	std::string read(data.size(), 0);
+
+	zs.next_in = reinterpret_cast<Bytef*>(compressed.data());
+	zs.avail_in = compressed.size();
+	zs.next_out = reinterpret_cast<Bytef*>(read.data());
+	zs.avail_out = read.size();
+
+	while (zs.avail_in > 0) {
+		REQUIRE(inflate(&zs, Z_NO_FLUSH) == Z_STREAM_END);
+
+		if (zs.avail_in > 0)
+			inflateReset(&zs);
+	}
+
+	inflateEnd(&zs);
+
+	CHECK(zs.avail_out == 0);
+	CHECK(read == data);
+}
+
+TEST_CASE("ChunkedStreamBufDecompress")
+{
+	const std::string data = MakeData(CChunkedStreamBuf::CHUNK_SIZE * 2 + 123, 4);
+
+	CChunkedStreamBuf inBuf;
+	inBuf.sputn(data.data(), data.size());
+
+	std::string compressed;
+	REQUIRE(ChunkedGZ::Compress(inBuf, 1, 2, compressed));
+
+	CChunkedStreamBuf outBuf;
+	REQUIRE(ChunkedGZ::Decompress(compressed, outBuf));
+
+	std::istream is(&outBuf);
+	std::string read(data.size(), 0);
+	is.read(read.data(), read.size());
+
+	CHECK(is.gcount() == static_cast<std::streamsize>(data.size()));
+	CHECK(read == data);
+
+	// truncated input is an error
+	CChunkedStreamBuf badBuf;
+	CHECK(!ChunkedGZ::Decompress(compressed.substr(0, compressed.size() / 2), badBuf));
+}
@@ -0,0 +1,99 @@
+#include "System/ContainerUtil.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// mimics the CUnitScriptEngine::animating registry: scripts start and stop
+// animating in random order, each toggle is one Add/RemoveInstance call
+namespace {
+	struct MockScript {
+		int animatingSlot = -1;
+		bool animating = false;
+	};
+
+	constexpr size_t NUM_SCRIPTS = 10000;
+	constexpr size_t NUM_TOGGLES = 1024;
+
+	std::vector<uint32_t> MakeTogglePattern(size_t numScripts, size_t numToggles, uint32_t seed) {
+		std::mt19937 rng(seed);
+		std::uniform_int_distribution<uint32_t> dist(0, numScripts - 1);
+		std::vector<uint32_t> pattern(numToggles);
+
+		for (auto& idx: pattern) {
+			idx = dist(rng);
+		}
+
+		return pattern;
+	}
+}
+
+static void BenchAnimatingLinear(benchmark::State& state) {
+	const size_t numActive = state.range(0);
+
+	std::vector<MockScript> scripts(NUM_SCRIPTS);
+	std::vector<MockScript*> animating;
+
+	const auto pattern = MakeTogglePattern(NUM_SCRIPTS, NUM_TOGGLES, 1234);
+
+	for (size_t i = 0; i < numActive; i++) {
+		scripts[i].animating = true;
+		spring::VectorInsertUnique(animating, &scripts[i]);
+	}
+
+	for (auto _ : state) {
+		for (const uint32_t idx: pattern) {
+			MockScript* script = &scripts[idx];
+
+			if ((script->animating = !script->animating)) {
+				spring::VectorInsertUnique(animating, script);
+			} else {
+				spring::VectorErase(animating, script);
+			}
+		}
+
+		benchmark::DoNotOptimize(animating.data());
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(state.iterations() * pattern.size());
+}
+
+static void BenchAnimatingSlotted(benchmark::State& state) {
+	const size_t numActive = state.range(0);
+	const auto slot = [](MockScript* s) -> int& { return s->animatingSlot; };
+
+	std::vector<MockScript> scripts(NUM_SCRIPTS);
+	std::vector<MockScript*> animating;
+
+	const auto pattern = MakeTogglePattern(NUM_SCRIPTS, NUM_TOGGLES, 1234);
+
+	for (size_t i = 0; i < numActive; i++) {
+		scripts[i].animating = true;
+		spring::VectorInsertSlotted(animating, &scripts[i], slot);
+	}
+
+	for (auto _ : state) {
+		for (const uint32_t idx: pattern) {
+			MockScript* script = &scripts[idx];
+
+			if ((script->animating = !script->animating)) {
+				spring::VectorInsertSlotted(animating, script, slot);
+			} else {
+				spring::VectorEraseSlotted(animating, script, slot);
+			}
+		}
+
+		benchmark::DoNotOptimize(animating.data());
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(state.iterations() * pattern.size());
+}
+
+BENCHMARK(BenchAnimatingLinear)->Arg(100)->Arg(1000)->Arg(5000)->Arg(10000);
+BENCHMARK(BenchAnimatingSlotted)->Arg(100)->Arg(1000)->Arg(5000)->Arg(10000);
+
+BENCHMARK_MAIN();
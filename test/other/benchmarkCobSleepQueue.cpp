@@ -0,0 +1,99 @@
+#include "Sim/Units/Scripts/CobSleepQueue.h"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+// mimics CCobEngine::WakeSleepingThreads: a population of sleeping threads
+// is ticked at GAME_SPEED, every thread that wakes up goes back to sleep
+namespace {
+	using SleepingThread = CCobSleepQueue::SleepingThread;
+
+	constexpr int TICK_TIME = 1000 / 30;
+	constexpr int NUM_TICKS = 30;
+
+	std::vector<int> MakeSleeps(size_t count, int maxSleep, unsigned seed) {
+		std::mt19937 rng(seed);
+		std::uniform_int_distribution<int> dist(0, maxSleep);
+		std::vector<int> sleeps(count);
+
+		for (int& s: sleeps) {
+			s = dist(rng);
+		}
+
+		return sleeps;
+	}
+}
+
+static void BenchCobSleepHeap(benchmark::State& state) {
+	const int numThreads = state.range(0);
+	const auto sleeps = MakeSleeps(1 << 16, state.range(1), 1234);
+
+	for (auto _ : state) {
+		state.PauseTiming();
+		CCobSleepQueue::SleepingThreadHeap heap;
+
+		for (int i = 0; i < numThreads; i++) {
+			heap.push({i, sleeps[i & 0xFFFF]});
+		}
+		state.ResumeTiming();
+
+		int currentTime = 0;
+		int numWoken = 0;
+
+		for (int tick = 0; tick < NUM_TICKS; tick++) {
+			currentTime += TICK_TIME;
+
+			while (!heap.empty() && heap.top().wt < currentTime) {
+				const SleepingThread st = heap.top();
+
+				heap.pop();
+				heap.push({st.id, currentTime + sleeps[(numWoken++) & 0xFFFF]});
+			}
+		}
+
+		benchmark::DoNotOptimize(numWoken);
+	}
+
+	state.SetItemsProcessed(state.iterations() * NUM_TICKS);
+}
+
+static void BenchCobSleepWheel(benchmark::State& state) {
+	const int numThreads = state.range(0);
+	const auto sleeps = MakeSleeps(1 << 16, state.range(1), 1234);
+
+	for (auto _ : state) {
+		state.PauseTiming();
+		CCobSleepQueue queue;
+		queue.Clear();
+
+		for (int i = 0; i < numThreads; i++) {
+			queue.Push({i, sleeps[i & 0xFFFF]});
+		}
+		state.ResumeTiming();
+
+		int currentTime = 0;
+		int numWoken = 0;
+
+		for (int tick = 0; tick < NUM_TICKS; tick++) {
+			currentTime += TICK_TIME;
+
+			for (queue.Advance(currentTime); queue.HasDue(); ) {
+				const SleepingThread st = queue.PopDue();
+
+				queue.Push({st.id, currentTime + sleeps[(numWoken++) & 0xFFFF]});
+			}
+		}
+
+		benchmark::DoNotOptimize(numWoken);
+	}
+
+	state.SetItemsProcessed(state.iterations() * NUM_TICKS);
+}
+
+// {sleeping threads, longest sleep in ms}
+BENCHMARK(BenchCobSleepHeap)->Args({50000, 1000})->Args({50000, 10000})->Args({50000, 100000});
+BENCHMARK(BenchCobSleepWheel)->Args({50000, 1000})->Args({50000, 10000})->Args({50000, 100000});
+
+BENCHMARK_MAIN();
@@ -0,0 +1,190 @@
+#include "System/LoadSave/ChunkedStreamBuf.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <zlib.h>
+
+// compares the old save-game path (std::stringstream, copied out via str()
+// and written by a single gzwrite) against CChunkedStreamBuf + ChunkedGZ,
+// reporting wall time and the peak RSS reached while saving or loading
+namespace {
+	const char* SAVE_PATH = "benchmarkSaveGameWriter.ssf";
+
+	constexpr size_t MB = 1 << 20;
+
+	// serializes in small pieces, like creg does
+	template<typename Stream>
+	void WriteState(Stream& os, size_t size) {
+		std::mt19937 rng(1234);
+		std::vector<uint32_t> record(64);
+
+		for (size_t written = 0; written < size; written += (record.size() * sizeof(uint32_t))) {
+			for (uint32_t& v: record) {
+				// mostly small values, compresses roughly like a real save
+				v = rng() & ((rng() & 1)? 0xFF: 0xFFFF);
+			}
+
+			os.write(reinterpret_cast<const char*>(record.data()), record.size() * sizeof(uint32_t));
+		}
+	}
+
+	// VmHWM can be reset on Linux, ru_maxrss can not
+	void ResetPeakRSS() {
+		std::ofstream("/proc/self/clear_refs") << "5";
+	}
+
+	double GetPeakRSS() {
+		std::ifstream status("/proc/self/status");
+		std::string line;
+
+		while (std::getline(status, line)) {
+			if (line.compare(0, 6, "VmHWM:") == 0)
+				return std::stod(line.substr(6)) / 1024.0;
+		}
+
+		return 0.0;
+	}
+
+	int GetNumThreads() {
+		return std::max(1u, std::thread::hardware_concurrency());
+	}
+}
+
+
+static void BenchSaveStringStream(benchmark::State& state) {
+	const size_t size = state.range(0) * MB;
+	double peakRSS = 0.0;
+
+	for (auto _ : state) {
+		ResetPeakRSS();
+
+		{
+			std::stringstream oss;
+			WriteState(oss, size);
+
+			const std::string data = oss.str();
+
+			gzFile file = gzopen(SAVE_PATH, "wb5");
+			gzwrite(file, data.c_str(), data.size());
+			gzflush(file, Z_FINISH);
+			gzclose(file);
+		}
+
+		peakRSS = std::max(peakRSS, GetPeakRSS());
+	}
+
+	state.counters["peakRSS_MB"] = peakRSS;
+	state.SetBytesProcessed(state.iterations() * size);
+}
+
+static void BenchSaveChunked(benchmark::State& state) {
+	const size_t size = state.range(0) * MB;
+	double peakRSS = 0.0;
+
+	for (auto _ : state) {
+		ResetPeakRSS();
+
+		{
+			CChunkedStreamBuf buf;
+			std::ostream oss(&buf);
+			WriteState(oss, size);
+
+			ChunkedGZ::WriteFile(SAVE_PATH, buf, 5, GetNumThreads());
+		}
+
+		peakRSS = std::max(peakRSS, GetPeakRSS());
+	}
+
+	state.counters["peakRSS_MB"] = peakRSS;
+	state.SetBytesProcessed(state.iterations() * size);
+}
+
+
+static void BenchLoadStringStream(benchmark::State& state) {
+	const size_t size = state.range(0) * MB;
+	double peakRSS = 0.0;
+
+	{
+		CChunkedStreamBuf buf;
+		std::ostream oss(&buf);
+		WriteState(oss, size);
+		ChunkedGZ::WriteFile(SAVE_PATH, buf, 5, GetNumThreads());
+	}
+
+	for (auto _ : state) {
+		ResetPeakRSS();
+
+		{
+			// whole file into memory first, as CGZFileHandler does
+			std::vector<char> fileBuffer;
+			std::vector<char> readBuf(8192);
+
+			gzFile file = gzopen(SAVE_PATH, "rb");
+
+			for (int len = 0; (len = gzread(file, readBuf.data(), readBuf.size())) > 0; ) {
+				fileBuffer.insert(fileBuffer.end(), readBuf.begin(), readBuf.begin() + len);
+			}
+
+			gzclose(file);
+
+			std::stringstream iss;
+			iss.rdbuf()->sputn(fileBuffer.data(), fileBuffer.size());
+			benchmark::DoNotOptimize(iss.rdbuf());
+		}
+
+		peakRSS = std::max(peakRSS, GetPeakRSS());
+	}
+
+	state.counters["peakRSS_MB"] = peakRSS;
+	state.SetBytesProcessed(state.iterations() * size);
+}
+
+static void BenchLoadChunked(benchmark::State& state) {
+	const size_t size = state.range(0) * MB;
+	double peakRSS = 0.0;
+
+	{
+		CChunkedStreamBuf buf;
+		std::ostream oss(&buf);
+		WriteState(oss, size);
+		ChunkedGZ::WriteFile(SAVE_PATH, buf, 5, GetNumThreads());
+	}
+
+	for (auto _ : state) {
+		ResetPeakRSS();
+
+		{
+			CChunkedStreamBuf buf;
+			ChunkedGZ::ReadFile(SAVE_PATH, buf);
+			benchmark::DoNotOptimize(&buf);
+		}
+
+		peakRSS = std::max(peakRSS, GetPeakRSS());
+	}
+
+	state.counters["peakRSS_MB"] = peakRSS;
+	state.SetBytesProcessed(state.iterations() * size);
+}
+
+// {uncompressed save size in MB}
+BENCHMARK(BenchSaveStringStream)->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BenchSaveChunked     )->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BenchLoadStringStream)->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BenchLoadChunked     )->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+int main(int argc, char** argv) {
+	benchmark::Initialize(&argc, argv);
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+
+	std::remove(SAVE_PATH);
+	return 0;
+}
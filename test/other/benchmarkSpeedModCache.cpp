@@ -0,0 +1,264 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+// compares CMoveMath::GetPosSpeedMod computed from the height, slope and
+// type maps (as before CSpeedModCache) against a lookup in a cached layer,
+// for the access pattern of a pathfinder expanding squares around a frontier
+// and for scattered queries. This is a synthetic estimate: the speed-mod
+// formulas below are copies of the Tank ones in {Ground,}MoveMath.cpp and
+// MoveDefHandler.cpp, and both variants mirror the real call path (bounds
+// check, CSpeedModCache::GetSpeedMods layer and owner checks, not inlined
+// into the caller) rather than calling into the engine
+namespace {
+	constexpr int MAP_X = 1024;
+	constexpr int MAP_Z = 1024;
+	constexpr int HMAP_X = MAP_X / 2;
+	constexpr int NUM_TERRAIN_TYPES = 256;
+
+	struct TerrainType {
+		float tankSpeed = 1.0f;
+		float kbotSpeed = 1.0f;
+		float hoverSpeed = 1.0f;
+		float shipSpeed = 1.0f;
+		float hardness = 1.0f;
+		char pad[64];
+	};
+
+	struct BenchMoveDef {
+		float depth = 22.0f;
+		float depthModParams[6] = {0.0f, 1e6f, 1e6f, 0.0f, 0.1f, 1.0f};
+		float maxSlope = 0.36f;
+		float slopeMod = 18.0f;
+		unsigned int pathType = 3;
+	};
+
+	struct BenchMap {
+		std::vector<float> maxHeights;
+		std::vector<float> slopes;
+		std::vector<unsigned char> types;
+		std::vector<TerrainType> terrainTypes;
+
+	};
+
+	// CSpeedModCache::{layers, layerIndices, layerOwners}
+	struct BenchSpeedModCache {
+		std::vector< std::vector<float> > layers;
+		std::array<int, 256> layerIndices;
+		std::array<const BenchMoveDef*, 256> layerOwners;
+
+		const float* GetSpeedMods(const BenchMoveDef& md) const {
+			const int layerIdx = layerIndices[md.pathType];
+
+			if (layerIdx < 0 || layerOwners[md.pathType] != &md)
+				return nullptr;
+
+			return layers[layerIdx].data();
+		}
+	};
+
+	constexpr float waterDamageCost = 1.0f;
+
+
+	float GetDepthMod(const BenchMoveDef& md, float height) {
+		if (height > -md.depthModParams[0])
+			return 1.0f;
+		if (height < -md.depthModParams[1])
+			return 0.0f;
+
+		const float depth = -height;
+		const float scale = std::clamp((md.depthModParams[3] * depth * depth + md.depthModParams[4] * depth + md.depthModParams[5]), 0.01f, md.depthModParams[2]);
+
+		return (1.0f / scale);
+	}
+
+	float GroundSpeedMod(const BenchMoveDef& md, float height, float slope) {
+		if (slope > md.maxSlope)
+			return 0.0f;
+		if (-height > md.depth)
+			return 0.0f;
+
+		float speedMod = 1.0f / (1.0f + slope * md.slopeMod);
+		speedMod *= ((height < 0.0f)? waterDamageCost: 1.0f);
+		speedMod *= GetDepthMod(md, height);
+		return speedMod;
+	}
+
+	float CalcPosSpeedMod(const BenchMap& map, const BenchMoveDef& md, unsigned x, unsigned z) {
+		const int square = (x >> 1) + ((z >> 1) * HMAP_X);
+		const TerrainType& tt = map.terrainTypes[map.types[square]];
+
+		return (GroundSpeedMod(md, map.maxHeights[x + z * MAP_X], map.slopes[square]) * tt.tankSpeed);
+	}
+
+	// rolling hills with a few lakes, types vary per half-square
+	BenchMap MakeMap(const BenchMoveDef& md) {
+		BenchMap map;
+		std::mt19937 rng(1234);
+		std::uniform_int_distribution<int> typeDist(0, 15);
+
+		map.maxHeights.resize(MAP_X * MAP_Z);
+		map.slopes.resize((MAP_X / 2) * (MAP_Z / 2));
+		map.types.resize((MAP_X / 2) * (MAP_Z / 2));
+		map.terrainTypes.resize(NUM_TERRAIN_TYPES);
+
+		for (int z = 0; z < MAP_Z; z++) {
+			for (int x = 0; x < MAP_X; x++) {
+				const float h = 120.0f * std::sin(x * 0.02f) * std::cos(z * 0.015f) + 40.0f * std::sin(x * 0.11f + z * 0.07f);
+
+				map.maxHeights[z * MAP_X + x] = h;
+			}
+		}
+
+		for (int z = 0; z < MAP_Z / 2; z++) {
+			for (int x = 0; x < MAP_X / 2; x++) {
+				const float h0 = map.maxHeights[(z * 2) * MAP_X + x * 2];
+				const float h1 = map.maxHeights[(z * 2) * MAP_X + x * 2 + 1];
+				const float h2 = map.maxHeights[(z * 2 + 1) * MAP_X + x * 2];
+
+				map.slopes[z * HMAP_X + x] = std::min(1.0f, (std::fabs(h1 - h0) + std::fabs(h2 - h0)) * 0.02f);
+				map.types[z * HMAP_X + x] = typeDist(rng);
+			}
+		}
+
+		for (int i = 0; i < NUM_TERRAIN_TYPES; i++) {
+			map.terrainTypes[i].tankSpeed = 0.5f + (i % 4) * 0.25f;
+		}
+
+		return map;
+	}
+
+	// squares visited by a search: neighbours of a frontier that wanders
+	// across the map, like the open-set of an A* search
+	std::vector<std::pair<int, int>> MakeSearchQueries(size_t count) {
+		std::vector<std::pair<int, int>> queries;
+		std::mt19937 rng(4321);
+		std::uniform_int_distribution<int> stepDist(-1, 1);
+		std::uniform_int_distribution<int> jumpDist(-24, 24);
+
+		int x = MAP_X / 2;
+		int z = MAP_Z / 2;
+
+		queries.reserve(count);
+
+		for (size_t i = 0; i < count; i += 8) {
+			if ((i & 255) == 0) {
+				x = std::clamp(x + jumpDist(rng), 1, MAP_X - 2);
+				z = std::clamp(z + jumpDist(rng), 1, MAP_Z - 2);
+			} else {
+				x = std::clamp(x + stepDist(rng), 1, MAP_X - 2);
+				z = std::clamp(z + stepDist(rng), 1, MAP_Z - 2);
+			}
+
+			for (int dz = -1; dz <= 1; dz++) {
+				for (int dx = -1; dx <= 1; dx++) {
+					if (dx != 0 || dz != 0)
+						queries.emplace_back(x + dx, z + dz);
+				}
+			}
+		}
+
+		return queries;
+	}
+
+	// squares of units scattered over the map
+	std::vector<std::pair<int, int>> MakeScatteredQueries(size_t count) {
+		std::vector<std::pair<int, int>> queries;
+		std::mt19937 rng(5678);
+		std::uniform_int_distribution<int> posDist(0, MAP_X - 1);
+
+		queries.reserve(count);
+
+		for (size_t i = 0; i < count; i++) {
+			queries.emplace_back(posDist(rng), posDist(rng));
+		}
+
+		return queries;
+	}
+
+	BenchSpeedModCache MakeCache(const BenchMap& map, const BenchMoveDef& md) {
+		BenchSpeedModCache cache;
+
+		cache.layerIndices.fill(-1);
+		cache.layerOwners.fill(nullptr);
+		cache.layers.emplace_back(MAP_X * MAP_Z);
+		cache.layerIndices[md.pathType] = 0;
+		cache.layerOwners[md.pathType] = &md;
+
+		for (int z = 0; z < MAP_Z; z++) {
+			for (int x = 0; x < MAP_X; x++) {
+				cache.layers[0][z * MAP_X + x] = CalcPosSpeedMod(map, md, x, z);
+			}
+		}
+
+		return cache;
+	}
+
+	const BenchMoveDef moveDef;
+	const BenchMap benchMap = MakeMap(moveDef);
+	const BenchSpeedModCache speedModCache = MakeCache(benchMap, moveDef);
+
+	// GetPosSpeedMod lives in MoveMath.cpp, out of line for its callers
+	__attribute__((noinline)) float GetPosSpeedModCalc(const BenchMoveDef& md, unsigned x, unsigned z) {
+		if (x >= MAP_X || z >= MAP_Z)
+			return 0.0f;
+
+		return (CalcPosSpeedMod(benchMap, md, x, z));
+	}
+
+	__attribute__((noinline)) float GetPosSpeedModCached(const BenchMoveDef& md, unsigned x, unsigned z) {
+		if (x >= MAP_X || z >= MAP_Z)
+			return 0.0f;
+
+		if (const float* speedMods = speedModCache.GetSpeedMods(md); speedMods != nullptr)
+			return speedMods[x + z * MAP_X];
+
+		return (CalcPosSpeedMod(benchMap, md, x, z));
+	}
+}
+
+
+static void BenchSpeedModsCalc(benchmark::State& state, std::vector<std::pair<int, int>> (*makeQueries)(size_t))
+{
+	const auto queries = makeQueries(1 << 20);
+
+	for (auto _ : state) {
+		float sum = 0.0f;
+
+		for (const auto& q: queries) {
+			sum += GetPosSpeedModCalc(moveDef, q.first, q.second);
+		}
+
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+static void BenchSpeedModsCached(benchmark::State& state, std::vector<std::pair<int, int>> (*makeQueries)(size_t))
+{
+	const auto queries = makeQueries(1 << 20);
+
+	for (auto _ : state) {
+		float sum = 0.0f;
+
+		for (const auto& q: queries) {
+			sum += GetPosSpeedModCached(moveDef, q.first, q.second);
+		}
+
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+BENCHMARK_CAPTURE(BenchSpeedModsCalc, Search, MakeSearchQueries)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BenchSpeedModsCached, Search, MakeSearchQueries)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BenchSpeedModsCalc, Scattered, MakeScatteredQueries)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BenchSpeedModsCached, Scattered, MakeScatteredQueries)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
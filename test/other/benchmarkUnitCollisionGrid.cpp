@@ -0,0 +1,170 @@
+#include "Sim/MoveTypes/Utils/CollisionGrid.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// mimics the broad phase of CGroundMoveType::HandleUnitCollisions for a
+// large blob of units pushing through a choke point: every unit queries its
+// neighbourhood with the usual search radius (speed + own footprint radius +
+// largest footprint + separation distance) every frame
+namespace {
+	using namespace MoveTypes;
+
+	// CUnit is several KB and the fields read by the broad phase are spread
+	// over it, pad accordingly so each of them costs its own cache line
+	struct BenchUnit {
+		float3 pos;
+		char pad0[256];
+		float radius;
+		char pad1[1024];
+
+		// QuadField dedup stamp
+		int tempNum = 0;
+		char pad2[2048];
+	};
+
+	constexpr float MAP_SIZE = 8192.0f;
+	constexpr float QUAD_SIZE = 128.0f;
+
+	// a 1024 elmo long, 512 elmo wide pass in the middle of the map, at
+	// 5k units this puts them roughly a footprint apart
+	std::vector<BenchUnit> MakeChokePoint(size_t count) {
+		std::mt19937 rng(1234);
+
+		std::uniform_real_distribution<float> distX(MAP_SIZE * 0.5f - 512.0f, MAP_SIZE * 0.5f + 512.0f);
+		std::uniform_real_distribution<float> distZ(MAP_SIZE * 0.5f - 256.0f, MAP_SIZE * 0.5f + 256.0f);
+		std::uniform_real_distribution<float> distR(8.0f, 16.0f);
+
+		std::vector<BenchUnit> units(count);
+
+		for (BenchUnit& u: units) {
+			u.pos = {distX(rng), 0.0f, distZ(rng)};
+			u.radius = distR(rng);
+		}
+
+		return units;
+	}
+
+	float SearchRadius(const BenchUnit& u) {
+		// speed + footprint radius + largest footprint + separation distance
+		return 2.0f + u.radius + 4.0f + 8.0f;
+	}
+
+	// what CQuadField::GetUnitsExact does per query: gather the quads
+	// overlapped by the search circle, dedup units spanning several of
+	// them through a per-unit stamp and copy the matches into a vector
+	struct QuadFieldLike {
+		static constexpr int NUM_QUADS = int(MAP_SIZE / QUAD_SIZE);
+
+		std::vector< std::vector<BenchUnit*> > quads;
+		std::vector<BenchUnit*> result;
+		int tempNum = 0;
+
+		QuadFieldLike(): quads(NUM_QUADS * NUM_QUADS) {}
+
+		static int Quad(float v) { return std::clamp(int(v / QUAD_SIZE), 0, NUM_QUADS - 1); }
+
+		void Insert(BenchUnit* u) {
+			for (int z = Quad(u->pos.z - u->radius); z <= Quad(u->pos.z + u->radius); z++) {
+				for (int x = Quad(u->pos.x - u->radius); x <= Quad(u->pos.x + u->radius); x++) {
+					quads[z * NUM_QUADS + x].push_back(u);
+				}
+			}
+		}
+
+		const std::vector<BenchUnit*>& GetUnitsExact(const float3& pos, float radius) {
+			result.clear();
+			tempNum++;
+
+			for (int z = Quad(pos.z - radius); z <= Quad(pos.z + radius); z++) {
+				for (int x = Quad(pos.x - radius); x <= Quad(pos.x + radius); x++) {
+					for (BenchUnit* u: quads[z * NUM_QUADS + x]) {
+						if (u->tempNum == tempNum)
+							continue;
+
+						u->tempNum = tempNum;
+
+						if (pos.SqDistance(u->pos) >= Square(radius + u->radius))
+							continue;
+
+						result.push_back(u);
+					}
+				}
+			}
+
+			return result;
+		}
+	};
+}
+
+static void BenchUnitCollisionGrid(benchmark::State& state) {
+	std::vector<BenchUnit> units = MakeChokePoint(state.range(0));
+
+	CollisionGrid<BenchUnit> grid;
+	grid.Init(MAP_SIZE, MAP_SIZE, state.range(1));
+
+	size_t numCandidates = 0;
+
+	for (auto _ : state) {
+		grid.Reset(units.size());
+
+		for (size_t i = 0; i < units.size(); i++) {
+			grid.SetObject(i, &units[i]);
+		}
+
+		grid.Finalize();
+
+		numCandidates = 0;
+
+		for (const BenchUnit& u: units) {
+			grid.ForEachInRange(u.pos, SearchRadius(u), [&](const BenchUnit* c) {
+				benchmark::DoNotOptimize(c);
+				numCandidates++;
+			});
+		}
+	}
+
+	state.counters["candidates"] = numCandidates;
+	state.SetItemsProcessed(state.iterations() * units.size());
+}
+
+static void BenchUnitQuadField(benchmark::State& state) {
+	std::vector<BenchUnit> units = MakeChokePoint(state.range(0));
+
+	QuadFieldLike quadField;
+
+	// units are already in the QuadField, it is only updated when they move
+	for (BenchUnit& u: units) {
+		quadField.Insert(&u);
+	}
+
+	size_t numCandidates = 0;
+
+	for (auto _ : state) {
+		numCandidates = 0;
+
+		for (const BenchUnit& u: units) {
+			for (const BenchUnit* c: quadField.GetUnitsExact(u.pos, SearchRadius(u))) {
+				benchmark::DoNotOptimize(c);
+				numCandidates++;
+			}
+		}
+	}
+
+	state.counters["candidates"] = numCandidates;
+	state.SetItemsProcessed(state.iterations() * units.size());
+}
+
+BENCHMARK(BenchUnitQuadField)->Arg(5000)->Unit(benchmark::kMicrosecond);
+
+// {number of units, cell size}; QUAD_SIZE cells match the QuadField granularity
+BENCHMARK(BenchUnitCollisionGrid)
+	->Args({5000, int(QUAD_SIZE)})
+	->Args({5000, 64})
+	->Args({5000, 32})
+	->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
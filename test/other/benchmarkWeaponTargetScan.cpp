@@ -0,0 +1,270 @@
+#include "System/float3.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+
+// split of CGameHelper::GenerateWeaponTargets into the QuadField scan that
+// GenerateWeaponTargetsMT moves onto the thread pool and the scoring which
+// AutoTarget still runs serially; the share of the former bounds what the
+// batch can gain. Scoring is a synthetic stand-in for ScoreWeaponTargets
+// (no TestTarget, TargetWeight or AllowWeaponTarget call-ins), so the scan
+// share measured here is an upper bound.
+namespace {
+	// CUnit is several KB, pad so each field read costs its own cache line
+	struct BenchUnit {
+		float3 pos;
+		float3 aimPos;
+		char pad0[256];
+		float radius;
+		float health;
+		float power;
+		float armorMult;
+		char pad1[512];
+		unsigned short losStatus[2];
+		char pad2[1024];
+
+		// per-thread QuadField dedup stamp
+		int tempNum = 0;
+		char pad3[1024];
+	};
+
+	struct BenchWeapon {
+		BenchUnit* owner;
+		float3 mainDir;
+		float range;
+	};
+
+	constexpr float MAP_SIZE = 8192.0f;
+	constexpr float QUAD_SIZE = 128.0f;
+
+	constexpr unsigned short LOS_INLOS = 1;
+	constexpr unsigned short LOS_INRADAR = 2;
+
+	// two armies of numUnits each facing each other across a 3072 elmo wide front
+	std::vector<BenchUnit> MakeBattle(size_t numUnits) {
+		std::mt19937 rng(1234);
+
+		std::uniform_real_distribution<float> distX(MAP_SIZE * 0.5f - 1536.0f, MAP_SIZE * 0.5f + 1536.0f);
+		std::uniform_real_distribution<float> distZ(0.0f, 768.0f);
+		std::uniform_real_distribution<float> distR(12.0f, 40.0f);
+		std::uniform_real_distribution<float> distH(500.0f, 5000.0f);
+		std::uniform_int_distribution<int> distLos(0, 3);
+
+		std::vector<BenchUnit> units(numUnits * 2);
+
+		for (size_t i = 0; i < units.size(); i++) {
+			BenchUnit& u = units[i];
+			const int side = (i >= numUnits);
+
+			u.pos = {distX(rng), 50.0f, MAP_SIZE * 0.5f + (side? 1.0f: -1.0f) * (64.0f + distZ(rng))};
+			u.aimPos = u.pos + UpVector * 10.0f;
+			u.radius = distR(rng);
+			u.health = distH(rng);
+			u.power = u.health * 0.5f;
+			u.armorMult = 1.0f;
+
+			const int los = distLos(rng);
+			u.losStatus[side] = LOS_INLOS;
+			u.losStatus[1 - side] = (los == 0)? 0: ((los == 1)? LOS_INRADAR: LOS_INLOS);
+		}
+
+		return units;
+	}
+
+	std::vector<BenchWeapon> MakeWeapons(std::vector<BenchUnit>& units) {
+		std::mt19937 rng(5678);
+		std::uniform_real_distribution<float> distRange(300.0f, 900.0f);
+
+		std::vector<BenchWeapon> weapons(units.size());
+
+		for (size_t i = 0; i < units.size(); i++) {
+			weapons[i].owner = &units[i];
+			weapons[i].mainDir = (i < units.size() / 2)? FwdVector: -FwdVector;
+			weapons[i].range = distRange(rng);
+		}
+
+		return weapons;
+	}
+
+	// what CQuadField::GetQuads and CGameHelper::GetWeaponTargetUnits do per
+	// weapon; teamUnits holds the units of each allyteam
+	struct QuadFieldLike {
+		static constexpr int NUM_QUADS = int(MAP_SIZE / QUAD_SIZE);
+
+		std::vector< std::vector<BenchUnit*> > teamUnits[2];
+		std::vector<int> quads;
+		int tempNum = 0;
+
+		QuadFieldLike() {
+			teamUnits[0].resize(NUM_QUADS * NUM_QUADS);
+			teamUnits[1].resize(NUM_QUADS * NUM_QUADS);
+		}
+
+		static int Quad(float v) { return std::clamp(int(v / QUAD_SIZE), 0, NUM_QUADS - 1); }
+
+		void Insert(BenchUnit* u, int allyTeam) {
+			for (int z = Quad(u->pos.z - u->radius); z <= Quad(u->pos.z + u->radius); z++) {
+				for (int x = Quad(u->pos.x - u->radius); x <= Quad(u->pos.x + u->radius); x++) {
+					teamUnits[allyTeam][z * NUM_QUADS + x].push_back(u);
+				}
+			}
+		}
+
+		void GetQuads(const float3& pos, float radius) {
+			quads.clear();
+
+			const float maxSqLength = (radius + QUAD_SIZE * 0.72f) * (radius + QUAD_SIZE * 0.72f);
+
+			for (int z = Quad(pos.z - radius); z <= Quad(pos.z + radius); z++) {
+				for (int x = Quad(pos.x - radius); x <= Quad(pos.x + radius); x++) {
+					const float3 quadPos = {(x + 0.5f) * QUAD_SIZE, 0.0f, (z + 0.5f) * QUAD_SIZE};
+
+					if (pos.SqDistance2D(quadPos) >= maxSqLength)
+						continue;
+
+					quads.push_back(z * NUM_QUADS + x);
+				}
+			}
+		}
+
+		void GetTargetUnits(const BenchWeapon& weapon, int allyTeam, std::vector<BenchUnit*>& targetUnits) {
+			// range plus the height bonus of GetWeaponTargetScanRadius
+			GetQuads(weapon.owner->pos, weapon.range + 50.0f);
+
+			targetUnits.clear();
+			tempNum++;
+
+			for (const int qi: quads) {
+				for (BenchUnit* u: teamUnits[1 - allyTeam][qi]) {
+					if (u->tempNum == tempNum)
+						continue;
+
+					u->tempNum = tempNum;
+					targetUnits.push_back(u);
+				}
+			}
+		}
+	};
+
+	// the arithmetic of CGameHelper::ScoreWeaponTargets
+	size_t ScoreTargets(const BenchWeapon& weapon, int allyTeam, const std::vector<BenchUnit*>& targetUnits, std::vector<std::pair<float, BenchUnit*>>& targets) {
+		const float3& ownerPos = weapon.owner->pos;
+		const float secDamage = 100.0f;
+
+		targets.clear();
+
+		for (BenchUnit* u: targetUnits) {
+			const unsigned short losState = u->losStatus[allyTeam];
+
+			float priority = 1.0f;
+			float3 targetPos;
+
+			if (losState & LOS_INLOS) {
+				targetPos = u->aimPos;
+			} else if (losState & LOS_INRADAR) {
+				targetPos = u->pos + float3(8.0f, 0.0f, -8.0f);
+				priority *= 10.0f;
+			} else {
+				continue;
+			}
+
+			const float modRange = weapon.range + (ownerPos.y - targetPos.y) * 0.2f;
+			const float sqDist2D = ownerPos.SqDistance2D(targetPos);
+
+			if (sqDist2D > (modRange * modRange))
+				continue;
+
+			const float angleMod = (1.0f - weapon.mainDir.dot((targetPos - ownerPos).SafeNormalize())) + 1.0f;
+			const float dist2D = std::sqrt(sqDist2D);
+
+			priority *= (angleMod * angleMod);
+			priority *= (dist2D + modRange * 0.4f + 100.0f);
+
+			if (losState & LOS_INLOS) {
+				priority *= (secDamage + u->health);
+			} else {
+				priority *= (secDamage + 10000.0f);
+			}
+
+			priority /= std::max(0.0001f, 100.0f * u->armorMult) * u->power;
+
+			targets.emplace_back(priority, u);
+		}
+
+		std::stable_sort(targets.begin(), targets.end(), [](const auto& a, const auto& b) { return (a.first < b.first); });
+		return targets.size();
+	}
+
+	struct Battle {
+		std::vector<BenchUnit> units;
+		std::vector<BenchWeapon> weapons;
+		QuadFieldLike quadField;
+
+		explicit Battle(size_t numUnits): units(MakeBattle(numUnits)), weapons(MakeWeapons(units)) {
+			for (size_t i = 0; i < units.size(); i++) {
+				quadField.Insert(&units[i], i >= numUnits);
+			}
+		}
+
+		int AllyTeam(size_t i) const { return (i >= units.size() / 2); }
+	};
+}
+
+// one iteration is a SlowUpdate batch, i.e. every 16th unit auto-targeting
+static void BenchWeaponTargetScan(benchmark::State& state) {
+	Battle battle(state.range(0));
+	std::vector<BenchUnit*> targetUnits;
+
+	size_t frame = 0;
+	size_t numCandidates = 0;
+
+	for (auto _ : state) {
+		numCandidates = 0;
+
+		for (size_t i = frame & 15; i < battle.weapons.size(); i += 16) {
+			battle.quadField.GetTargetUnits(battle.weapons[i], battle.AllyTeam(i), targetUnits);
+			numCandidates += targetUnits.size();
+		}
+
+		frame++;
+	}
+
+	state.counters["candidates"] = numCandidates;
+}
+
+static void BenchWeaponTargetScore(benchmark::State& state) {
+	Battle battle(state.range(0));
+
+	// scoring only, from scans done up front
+	std::vector< std::vector<BenchUnit*> > scans(battle.weapons.size());
+	std::vector<std::pair<float, BenchUnit*>> targets;
+
+	for (size_t i = 0; i < battle.weapons.size(); i++) {
+		battle.quadField.GetTargetUnits(battle.weapons[i], battle.AllyTeam(i), scans[i]);
+	}
+
+	size_t frame = 0;
+	size_t numTargets = 0;
+
+	for (auto _ : state) {
+		numTargets = 0;
+
+		for (size_t i = frame & 15; i < battle.weapons.size(); i += 16) {
+			numTargets += ScoreTargets(battle.weapons[i], battle.AllyTeam(i), scans[i], targets);
+		}
+
+		frame++;
+	}
+
+	state.counters["targets"] = numTargets;
+}
+
+BENCHMARK(BenchWeaponTargetScan)->Arg(500)->Arg(2000)->Arg(5000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BenchWeaponTargetScore)->Arg(500)->Arg(2000)->Arg(5000)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
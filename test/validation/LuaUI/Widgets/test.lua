@@ -17,6 +17,8 @@ local timer
 local unitscreated = 0
 local unitsdestroyed = 0
 local maxruntime = 120 -- run at max 2 minutes
+local tracerayframes = 300 -- compare Spring.TraceRays against Spring.TraceRay this often
+local maxtracerays = 200
 
 local function ShowStats()
 	local time = Spring.DiffTimers(Spring.GetTimer(), timer)
@@ -31,6 +33,44 @@ local function ShowStats()
 	end
 end
 
+-- rays from units towards other units, so that most of them hit something
+local function MakeRays(units)
+	local rays = {}
+	for i = 1, math.min(#units, maxtracerays) do
+		local unitID = units[i]
+		local targetID = units[(i * 7) % #units + 1]
+		local _, _, _, px, py, pz = Spring.GetUnitPosition(unitID, true)
+		local _, _, _, tx, ty, tz = Spring.GetUnitPosition(targetID, true)
+		local dx, dy, dz = tx - px, ty - py, tz - pz
+		local dist = math.sqrt(dx * dx + dy * dy + dz * dz)
+		if dist > 0 then
+			rays[#rays + 1] = {px, py, pz, dx, dy, dz, dist * 1.5, unitID}
+		end
+	end
+	return rays
+end
+
+-- the batched trace must give exactly the hits of tracing one ray at a time
+local function CheckTraceRays()
+	local units = Spring.GetAllUnits()
+	if #units < 2 then
+		return
+	end
+	local rays = MakeRays(units)
+	local flags = Game.collisionFlags
+	for _, traceFlags in ipairs({0, flags.noFriendlies, flags.noFeatures + flags.noGround}) do
+		local hits = Spring.TraceRays(rays, traceFlags)
+		for i, ray in ipairs(rays) do
+			local rayLength, unitID, featureID = Spring.TraceRay(ray[1], ray[2], ray[3], ray[4], ray[5], ray[6], ray[7], traceFlags, -1, ray[8])
+			local hit = hits[i]
+			if hit.rayLength ~= rayLength or hit.unitID ~= unitID or hit.featureID ~= featureID then
+				Spring.Log("test.lua", LOG.ERROR, string.format("TraceRays mismatch for ray %i (flags %i): %s %s %s vs. TraceRay %s %s %s", i, traceFlags,
+					tostring(hit.rayLength), tostring(hit.unitID), tostring(hit.featureID), tostring(rayLength), tostring(unitID), tostring(featureID)))
+			end
+		end
+	end
+end
+
 function widget:GameOver()
 	Spring.SendCommands("quitforce")
 	ShowStats()
@@ -51,6 +91,9 @@ function widget:Initialize()
 end
 
 function widget:GameFrame(n)
+	if n % tracerayframes == 0 then
+		CheckTraceRays()
+	end
 	if n==maxframes then
 		ShowStats()
 		Spring.SendCommands("quitforce")
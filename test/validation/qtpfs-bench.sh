@@ -0,0 +1,72 @@
+#!/bin/bash
+
+# Benchmarks QTPFS path searches without playing a game.
+#
+#   record: replays a demo with QTPFSDumpSearches set, which writes every
+#           path request queued during the game to SEARCHES
+#   replay: loads the same demo with QTPFSReplaySearches set, which executes
+#           the recorded requests right after the node-layers are built and
+#           quits, then prints the resulting statistics
+#
+# The demo provides the map, game and movedefs, so both modes must be run
+# with the same demo (and the same engine build for comparable results).
+
+set -e #abort on error
+
+if [ $# -lt 4 ]; then
+	echo "Usage: $0 /path/to/spring-headless record|replay /path/to/demo.sdfz /path/to/searches.txt [maxseconds]"
+	exit 1
+fi
+
+HEADLESS=$1
+MODE=$2
+DEMO=$3
+SEARCHES=$(realpath -m "$4")
+MAXSECONDS=${5:-600}
+
+if [ ! -x "$HEADLESS" ]; then
+	echo "Parameter 1 $HEADLESS isn't executable!"
+	exit 1
+fi
+
+if [ ! -f "$DEMO" ]; then
+	echo "Demo $DEMO doesn't exist!"
+	exit 1
+fi
+
+WORKDIR=$(mktemp -d)
+trap 'rm -rf "$WORKDIR"' EXIT
+
+case "$MODE" in
+	record)
+		echo "QTPFSDumpSearches = $SEARCHES" > "$WORKDIR/springsettings.cfg"
+		;;
+	replay)
+		if [ ! -f "$SEARCHES" ]; then
+			echo "Recorded searches $SEARCHES don't exist!"
+			exit 1
+		fi
+		echo "QTPFSReplaySearches = $SEARCHES" > "$WORKDIR/springsettings.cfg"
+		;;
+	*)
+		echo "Unknown mode $MODE, expected record or replay"
+		exit 1
+		;;
+esac
+
+set +e
+timeout "$MAXSECONDS" \
+	"$HEADLESS" --nocolor --write-dir "$WORKDIR" --config "$WORKDIR/springsettings.cfg" "$DEMO" > /dev/null 2>&1
+set -e
+
+if [ "$MODE" = "record" ]; then
+	echo "$(wc -l < "$SEARCHES") path requests recorded to $SEARCHES"
+	exit 0
+fi
+
+if ! grep "\[QTPFS::ReplaySearches\]" "$WORKDIR/infolog.txt"; then
+	echo "no replay statistics found, is QTPFS the active pathfinder?"
+	exit 1
+fi
+
+exit 0
@@ -0,0 +1,83 @@
+#!/bin/bash
+
+# Replays a demo twice, once with the config keys below set to 0 and once
+# with them set to 1, and compares the per-frame sync checksums of both runs.
+# Clients with different values for these keys must stay in sync, so any
+# difference is a bug. This only compares the two settings of the same build;
+# it says nothing about whether the build matches older engine versions, and
+# demos recorded with such versions are not expected to replay in sync.
+#
+# The config keys toggled between the two runs can be overridden through
+# SYNC_MT_KEYS (space-separated); games and maps are looked up through the
+# regular SPRING_DATADIR mechanism.
+
+set -e #abort on error
+
+if [ $# -lt 2 ]; then
+	echo "Usage: $0 /path/to/spring-headless /path/to/demo.sdfz [maxseconds]"
+	exit 1
+fi
+
+HEADLESS=$1
+DEMO=$2
+MAXSECONDS=${3:-600}
+KEYS=${SYNC_MT_KEYS:-"UpdateUnitsMT UpdateUnitLosStatesMT UpdateSyncedProjectilesMT GenerateWeaponTargetsMT CobPredecodedDispatch"}
+
+if [ ! -x "$HEADLESS" ]; then
+	echo "Parameter 1 $HEADLESS isn't executable!"
+	exit 1
+fi
+
+if [ ! -f "$DEMO" ]; then
+	echo "Demo $DEMO doesn't exist!"
+	exit 1
+fi
+
+WORKDIR=$(mktemp -d)
+trap 'rm -rf "$WORKDIR"' EXIT
+
+# $1: run name, $2: value for all keys
+run_demo() {
+	local DIR="$WORKDIR/$1"
+	mkdir -p "$DIR"
+
+	for KEY in $KEYS; do
+		echo "$KEY = $2" >> "$DIR/springsettings.cfg"
+	done
+
+	echo "Replaying $DEMO with $KEYS = $2"
+	set +e
+	SPRING_LOG_SECTIONS="SyncCheck" timeout "$MAXSECONDS" \
+		"$HEADLESS" --nocolor --write-dir "$DIR" --config "$DIR/springsettings.cfg" "$DEMO" > /dev/null 2>&1
+	set -e
+
+	grep -o "frame=[0-9]* checksum=[0-9a-f]*" "$DIR/infolog.txt" > "$WORKDIR/$1.sync" || true
+}
+
+# $1, $2: run names
+compare_runs() {
+	local FRAMES1=$(wc -l < "$WORKDIR/$1.sync")
+	local FRAMES2=$(wc -l < "$WORKDIR/$2.sync")
+
+	if [ "$FRAMES1" -eq 0 ] || [ "$FRAMES2" -eq 0 ]; then
+		echo "no checksums recorded ($1: $FRAMES1, $2: $FRAMES2)"
+		exit 1
+	fi
+
+	# compare the common prefix; one run may have been cut off by the timeout
+	local FRAMES=$(( FRAMES1 < FRAMES2 ? FRAMES1 : FRAMES2 ))
+	local FIRSTDIFF=$(diff <(head -n "$FRAMES" "$WORKDIR/$1.sync") <(head -n "$FRAMES" "$WORKDIR/$2.sync") | grep -m 1 "^<" || true)
+
+	if [ -n "$FIRSTDIFF" ]; then
+		echo "sync mismatch between $1 and $2 runs, first at: ${FIRSTDIFF#< }"
+		exit 1
+	fi
+
+	echo "$FRAMES frames of $1 and $2 runs compared, checksums identical"
+}
+
+run_demo serial 0
+run_demo parallel 1
+compare_runs serial parallel
+
+exit 0
@@ -32,10 +32,14 @@ no console output (you still could use this.exe > z.tzt though).
 	DEFINE_bool  (teamstats,    false, "Print teamstats");
 	DEFINE_int32 (team,         -1,    "Select team");
 	DEFINE_string(teamsstatcsv, "",    "Write teamstats in a csv file");
+	DEFINE_bool  (keyframes,    false, "List the game-state keyframes in the demo index");
+	DEFINE_int32 (keyframe,     -1,    "Select keyframe");
+	DEFINE_string(keyframessf,  "",    "Write the selected keyframe as a save-game");
 
 
 void TrafficDump(CDemoReader& reader, bool trafficStats);
 void WriteTeamstatHistory(CDemoReader& reader, unsigned team, const std::string& file);
+void WriteKeyframe(CDemoReader& reader, int keyframe, const std::string& file);
 
 int main (int argc, char* argv[])
 {
@@ -68,6 +72,25 @@ int main (int argc, char* argv[])
 		}
 		WriteTeamstatHistory(reader, (unsigned) FLAGS_team, FLAGS_teamsstatcsv);
 	}
+	if (!FLAGS_keyframessf.empty())
+	{
+		if (FLAGS_keyframe < 0)
+		{
+			std::cout << "keyframessf requires a keyframe to select" << std::endl;
+			exit(1);
+		}
+		WriteKeyframe(reader, FLAGS_keyframe, FLAGS_keyframessf);
+	}
+	if (FLAGS_keyframes)
+	{
+		const std::vector<DemoKeyframeHeader>& keyframes = reader.GetKeyframes();
+		std::cout << "Frame index entries: " << reader.GetFrameIndex().size() << std::endl;
+		for (unsigned i = 0; i < keyframes.size(); ++i)
+		{
+			std::cout << "Keyframe " << i << ": frame " << keyframes[i].frameNum << ", game second " << keyframes[i].modGameTime
+			          << ", " << keyframes[i].stateSize << " bytes" << std::endl;
+		}
+	}
 
 	if (FLAGS_header || FLAGS_stats)
 	{
@@ -503,3 +526,15 @@ void WriteTeamstatHistory(CDemoReader& reader, unsigned team, const std::string&
 		exit(1);
 	}
 };
+
+void WriteKeyframe(CDemoReader& reader, int keyframe, const std::string& file)
+{
+	std::string state;
+	if (!reader.ReadKeyframeState(keyframe, state))
+	{
+		std::cout << "Demo has no keyframe " << keyframe << std::endl;
+		exit(1);
+	}
+	std::ofstream out(file.c_str(), std::ios::out | std::ios::binary);
+	out.write(state.data(), state.size());
+}
@@ -1,45 +1,40 @@
 #!/bin/bash
 
+# Replays a demo with each engine binary as fast as possible and collects
+# the per-frame sim timings (see --replay-benchmark) in a results directory.
+#
+# Usage: $0 demo.sdfz [engine-binary ...]
+#   default engine binary is ./spring-headless
+
 set -e
 
-TESTRUNS=4
+TESTRUNS=${TESTRUNS:-4}
 
-CMD[0]="./spring_pic --benchmark 20 --benchmarkstart 0"
-CMD[1]="./spring_nonpic --benchmark 20 --benchmarkstart 0"
-CMD[2]="./spring_mt --benchmark 20 --benchmarkstart 0"
+if [ $# -lt 1 ]; then
+	echo "Usage: $0 demo.sdfz [engine-binary ...]"
+	exit 1
+fi
 
-#CMD1=$CMD2
+DEMOFILE=$(realpath "$1")
+shift
 
-SCRIPT="script_benchmark.txt"
-#SCRIPT="script_benchmark_zwzsg.txt"
-#SCRIPT="demos/20121114_033937_TheHunters-v3_91.0.1-368-gbca8185 develop.sdf"
-DEMOFILE=bench_results_2012-11-20_10-33-36/benchmark.sdf
+CMD=("$@")
+if [ ${#CMD[@]} -eq 0 ]; then
+	CMD=("./spring-headless")
+fi
 
 PREFIX=$PWD/bench_results_$(date +"%Y-%m-%d_%H-%M-%S")
 
-
 mkdir "$PREFIX"
 
-if ! [ -s "$DEMOFILE" ]; then
-	echo Creating demo
-	${CMD[0]} "$SCRIPT" >/dev/null 2>&1 &
-	wait
-	DEMOFILE=`cat infolog.txt | grep "Writing demo: " | cut -c27-`
-	echo demo file: $DEMOFILE
-	cp -v "$DEMOFILE" "$PREFIX/benchmark.sdf"
-	mv benchmark.data "$PREFIX/data-0-cmd1.data"
-fi
-
-
-CMDCOUNT=${#CMD[*]}
+CMDCOUNT=${#CMD[@]}
 for (( i=1; i <= TESTRUNS; i++ )); do
 	echo Round $i/$TESTRUNS
-	for (( k=0; k < $CMDCOUNT; k++ )); do
-		echo Running CMD $(($k+1))/$CMDCOUNT
-		${CMD[$k]} "$DEMOFILE" >/dev/null 2>&1
-		mv benchmark.data "$PREFIX/data-${i}-cmd${k}.data"
+	for (( k=0; k < CMDCOUNT; k++ )); do
+		echo Running ${CMD[$k]} "($(($k+1))/$CMDCOUNT)"
+		${CMD[$k]} --only-local --replay-benchmark "$PREFIX/data-${i}-cmd${k}.csv" "$DEMOFILE" >/dev/null 2>&1
 	done
 done
 
-#./plot
-#./plot_mass.sh $TESTRUNS
+# CSV columns: frame, sim (wall-time of the whole SimFrame in ms), then one column per profiler timer
+#./plot_mass.sh "$PREFIX"/data-*.csv
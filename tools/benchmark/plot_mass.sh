@@ -3,7 +3,7 @@
 if [ $# -le 0 ]; then
 	echo "Usage: $0 [[file1] file2 ...]"
 	echo "Advanced usage: "
-	echo "$0 ../../bench_results_*/data-{1,2,3,4}-cmd{0,1}.data"
+	echo "$0 ../../bench_results_*/data-{1,2,3,4}-cmd{0,1}.csv"
 	exit 1
 fi
 set -e
@@ -14,6 +14,7 @@ echo $TESTRUNS
 
 CMDS='
 set terminal pngcairo enhanced size 1024,768
+set datafile separator ","
 set xlabel "GameTime (in minutes)"
 set xtics nomirror
 set ytics nomirror
@@ -45,7 +46,7 @@ for file in $@; do
 	DATAFILES="$DATAFILES datafile$N=\"$file\"
 "
 	CMDS="$CMDS, \\
-		avg=init(0), datafile$N using (\$1/30/60):(blend(1000/\$2,0.9999)) with line title \"$N $(basename $file) .data\""
+		avg=init(0), datafile$N using (\$1/30/60):(blend(\$2,0.9999)) with line title \"$N $(basename $file)\""
 done
 
 #CMDS="$CMDS, \